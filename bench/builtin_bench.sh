@@ -0,0 +1,59 @@
+#!/bin/sh
+######################################################
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: builtin_bench.sh
+#   Description: Commands per second of the in-process
+#       builtins against the same utilities run as
+#       programs. Writes two scripts of N lines, one
+#       calling echo/test/[/true/pwd/printf by name (the
+#       builtins) and one calling them by full path (so
+#       the shell has to spawn them), and times each.
+#
+#       usage: builtin_bench.sh [shell] [lines]
+#
+######################################################
+SHELL_BIN=${1:-./main}
+LINES=${2:-5000}
+TMP=${TMPDIR:-/tmp}/builtin_bench.$$
+
+mkdir -p "$TMP" || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+# One line per utility, cycled until LINES
+i=0
+while [ $i -lt "$LINES" ]; do
+    case $((i % 6)) in
+        0) echo "echo hello world" ;;
+        1) echo "test 3 -lt 5" ;;
+        2) echo "[ -d / ]" ;;
+        3) echo "true" ;;
+        4) echo "pwd" ;;
+        5) echo "printf %s-%d\\n x $i" ;;
+    esac
+    i=$((i + 1))
+done > "$TMP/builtin.sh"
+
+# Same script with full paths, which are never builtins
+sed -e "s|^echo|$(which echo)|" \
+    -e "s|^test|$(which test)|" -e "s|^\[|$(which [)|" \
+    -e "s|^true|$(which true)|" -e "s|^pwd|$(which pwd)|" \
+    -e "s|^printf|$(which printf)|" "$TMP/builtin.sh" > "$TMP/spawn.sh"
+
+run() {
+    start=$(date +%s%N)
+    "$SHELL_BIN" "$2" > /dev/null
+    end=$(date +%s%N)
+    ms=$(( (end - start) / 1000000 ))
+    [ "$ms" -gt 0 ] || ms=1
+    echo "$1: $LINES commands in ${ms} ms, $((LINES * 1000 / ms)) cmds/sec"
+    echo "$ms"  > "$TMP/$1.ms"
+}
+
+run builtin "$TMP/builtin.sh"
+run spawn "$TMP/spawn.sh"
+
+b=$(cat "$TMP/builtin.ms")
+s=$(cat "$TMP/spawn.ms")
+echo "speedup: $((s * 10 / b / 10)).$((s * 10 / b % 10))x"
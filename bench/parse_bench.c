@@ -0,0 +1,132 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: parse_bench.c
+#   Description: Micro-benchmark for sh_tokenize. Builds
+#       a corpus of long command lines with quotes,
+#       escapes and mixed blanks, then reports ns/line
+#       and how many arena blocks were added while timing
+#       (should be 0: parsing does no heap allocation).
+#
+#       usage: parse_bench [lines] [words_per_line] [rounds]
+#
+******************************************************/
+#include <time.h>
+
+#include "../simple_shell.h"
+
+/*Word shapes cycled through when building a line*/
+static const char *word_shapes[] = {
+    "argument", "--long-option=value", "'single quoted words'",
+    "\"double \\\"quoted\\\" $HOME\"", "escaped\\ space", "/usr/local/bin/tool",
+    "-x", "file_name.txt", "mixed'quo'\"ted\"", "<", ">", "&"
+};
+
+/******************************************************
+#   now_ns
+#   @desc: monotonic clock in nanoseconds
+#   @param: n/a
+#   @return: nanoseconds
+******************************************************/
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/******************************************************
+#   count_blocks
+#   @desc: number of blocks currently owned by arena
+#   @param: arena
+#   @return: block count
+******************************************************/
+static int count_blocks(struct Arena *arena)
+{
+    struct ArenaBlock *block;
+    int count = 0;
+
+    for (block = arena->first; block != NULL; block = block->next) {
+        count++;
+    }
+    return count;
+}
+
+int main(int argc, char **argv)
+{
+    int lines = argc > 1 ? atoi(argv[1]) : 1000;
+    int words = argc > 2 ? atoi(argv[2]) : 200;
+    int rounds = argc > 3 ? atoi(argv[3]) : 20;
+    int shapes = sizeof(word_shapes) / sizeof(word_shapes[0]);
+    char **corpus = malloc(lines * sizeof(char*));
+    size_t *lengths = malloc(lines * sizeof(size_t));
+    size_t total_bytes = 0;
+    struct Arena arena;
+    char **args;
+    int count;
+    long total_words = 0;
+    int blocks_before;
+    double start;
+    double elapsed;
+    int i;
+    int j;
+    int r;
+
+    /*Build the corpus*/
+    for (i = 0; i < lines; i++) {
+        size_t cap = 64;
+        size_t len = 0;
+        char *line;
+
+        for (j = 0; j < words; j++) {
+            cap += strlen(word_shapes[(i + j) % shapes]) + 2;
+        }
+        line = malloc(cap);
+        len += sprintf(line, "command%d", i);
+        for (j = 0; j < words; j++) {
+            /*Alternate spaces and tabs between words*/
+            line[len++] = (j % 3 == 0) ? '\t' : ' ';
+            len += sprintf(line + len, "%s", word_shapes[(i + j) % shapes]);
+        }
+        line[len++] = '\n';
+        line[len] = '\0';
+        corpus[i] = line;
+        lengths[i] = len;
+        total_bytes += len;
+    }
+
+    sh_arena_init(&arena, ARENA_BLOCK_SIZE);
+
+    /*Warm up: let the arena grow to fit the longest line*/
+    for (i = 0; i < lines; i++) {
+        sh_arena_reset(&arena);
+        sh_tokenize(&arena, corpus[i], lengths[i], &args, &count, NULL);
+    }
+    sh_arena_reset(&arena);
+    blocks_before = count_blocks(&arena);
+
+    start = now_ns();
+    for (r = 0; r < rounds; r++) {
+        for (i = 0; i < lines; i++) {
+            sh_arena_reset(&arena);
+            sh_tokenize(&arena, corpus[i], lengths[i], &args, &count, NULL);
+            total_words += count;
+        }
+    }
+    elapsed = now_ns() - start;
+
+    printf("lines=%d avg_bytes=%zu avg_words=%ld\n", lines, total_bytes / lines,
+            total_words / ((long)lines * rounds));
+    printf("sh_tokenize: %10.1f ns/line %8.2f ns/word\n",
+            elapsed / ((double)lines * rounds), elapsed / total_words);
+    printf("arena blocks added while timing: %d\n", count_blocks(&arena) - blocks_before);
+
+    sh_arena_free(&arena);
+    for (i = 0; i < lines; i++) {
+        free(corpus[i]);
+    }
+    free(corpus);
+    free(lengths);
+    return 0;
+}
@@ -0,0 +1,65 @@
+#!/bin/sh
+######################################################
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: source_bench.sh
+#   Description: Cold against warm source of an N line
+#       script of builtins. Cold is the first source in
+#       a fresh shell, which tokenizes and compiles every
+#       line; warm is each further source in the same
+#       shell, which runs the compiled lines. "disk" is
+#       the first source in a fresh shell that finds the
+#       script compiled in $SIMPLE_SHELL_CACHE.
+#
+#       usage: source_bench.sh [shell] [lines] [repeats]
+#
+######################################################
+SHELL_BIN=${1:-./main}
+LINES=${2:-10000}
+REPEATS=${3:-10}
+TMP=${TMPDIR:-/tmp}/source_bench.$$
+
+mkdir -p "$TMP/cache" || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+# Variables, && || ; and quoting, cycled until LINES
+i=0
+while [ $i -lt "$LINES" ]; do
+    case $((i % 6)) in
+        0) echo "N=$i" ;;
+        1) echo "test \$N -gt 0 && echo \"line \$N\" || echo none" ;;
+        2) echo "true; false || echo 'fallback' \${N}" ;;
+        3) echo "[ -n \"\$HOME\" ] && printf '%s-%d\\\\n' x $i" ;;
+        4) echo "{ echo grouped \$N; true; }" ;;
+        5) echo "export LAST=\$N" ;;
+    esac
+    i=$((i + 1))
+done > "$TMP/script.sh"
+
+# Milliseconds taken by the shell running $2
+elapsed() {
+    start=$(date +%s%N)
+    env $1 "$SHELL_BIN" -c "$2" > /dev/null
+    end=$(date +%s%N)
+    echo $(( (end - start) / 1000000 ))
+}
+
+WARM_LINE="source $TMP/script.sh"
+j=0
+while [ $j -lt "$REPEATS" ]; do
+    WARM_LINE="$WARM_LINE; source $TMP/script.sh"
+    j=$((j + 1))
+done
+
+cold=$(elapsed "" "source $TMP/script.sh")
+all=$(elapsed "" "$WARM_LINE")
+warm=$(( (all - cold) / REPEATS ))
+elapsed "SIMPLE_SHELL_CACHE=$TMP/cache" "source $TMP/script.sh" > /dev/null
+disk=$(elapsed "SIMPLE_SHELL_CACHE=$TMP/cache" "source $TMP/script.sh")
+
+[ "$warm" -gt 0 ] || warm=1
+echo "cold: $LINES lines in ${cold} ms"
+echo "warm: $LINES lines in ${warm} ms (mean of $REPEATS)"
+echo "disk: $LINES lines in ${disk} ms"
+echo "speedup: $((cold * 10 / warm / 10)).$((cold * 10 / warm % 10))x"
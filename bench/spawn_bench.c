@@ -0,0 +1,110 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: spawn_bench.c
+#   Description: Measures launches per second of the old
+#       fork()+execvp path against the posix_spawn path
+#       used by sh_launch. An optional ballast (in MB) is
+#       touched first to inflate the parent's RSS.
+#
+#       usage: spawn_bench [iterations] [ballast_mb]
+#
+******************************************************/
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char **environ;
+
+/******************************************************
+#   now_sec
+#   @desc: monotonic clock in seconds
+#   @param: n/a
+#   @return: double seconds
+******************************************************/
+static double now_sec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/******************************************************
+#   run_fork
+#   @desc: launches /bin/true n times via fork+execvp
+#   @param: n - iterations
+#   @return: elapsed seconds
+******************************************************/
+static double run_fork(int n)
+{
+    char *argv[] = { "true", NULL };
+    int i;
+    int status;
+    double start = now_sec();
+
+    for (i = 0; i < n; i++) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execvp(argv[0], argv);
+            _exit(127);
+        }
+        waitpid(pid, &status, 0);
+    }
+
+    return now_sec() - start;
+}
+
+/******************************************************
+#   run_spawn
+#   @desc: launches /bin/true n times via posix_spawnp
+#   @param: n - iterations
+#   @return: elapsed seconds
+******************************************************/
+static double run_spawn(int n)
+{
+    char *argv[] = { "true", NULL };
+    int i;
+    int status;
+    pid_t pid;
+    double start = now_sec();
+
+    for (i = 0; i < n; i++) {
+        if (posix_spawnp(&pid, argv[0], NULL, NULL, argv, environ) == 0) {
+            waitpid(pid, &status, 0);
+        }
+    }
+
+    return now_sec() - start;
+}
+
+int main(int argc, char **argv)
+{
+    int n = argc > 1 ? atoi(argv[1]) : 2000;
+    size_t ballast_mb = argc > 2 ? (size_t)atol(argv[2]) : 0;
+    char *ballast = NULL;
+    double t_fork;
+    double t_spawn;
+
+    /*Inflate RSS so page table copying shows up in fork*/
+    if (ballast_mb > 0) {
+        ballast = malloc(ballast_mb << 20);
+        if (ballast != NULL) {
+            memset(ballast, 1, ballast_mb << 20);
+        }
+    }
+
+    t_fork = run_fork(n);
+    t_spawn = run_spawn(n);
+
+    printf("rss_ballast_mb=%zu iterations=%d\n", ballast_mb, n);
+    printf("fork+execvp:  %10.0f spawns/sec\n", n / t_fork);
+    printf("posix_spawnp: %10.0f spawns/sec\n", n / t_spawn);
+
+    free(ballast);
+    return 0;
+}
@@ -0,0 +1,516 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: stream_bench.c
+#   Description: Drives the shell binary with generated
+#       command streams on its stdin, one scenario at a
+#       time: blank lines and comments, builtins, external
+#       commands, redirections and bursts of background
+#       jobs. Each scenario is run twice in a fresh shell:
+#       written all at once for commands per second, then
+#       one command at a time, each followed by an echo
+#       of a marker the driver waits for, for per-command
+#       latency (the marker's echo is part of it). Peak
+#       RSS is the shell's VmHWM. One JSON object per line
+#       is printed for each scenario.
+#
+#       usage: stream_bench [shell] [commands] [samples]
+#
+******************************************************/
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LINE_MAX_LEN 512 /*longest generated line*/
+#define STALL_MS 10000 /*give up when the shell is silent this long*/
+
+extern char **environ;
+
+/*Paths the generated lines use*/
+struct Paths
+{
+    char true_path[256];
+    char cat_path[256];
+    char dir[64]; /*scratch directory*/
+};
+
+typedef void (*LineMaker)(const struct Paths *paths, int i, char *out, size_t cap);
+
+/*A kind of command stream*/
+struct Scenario
+{
+    const char *name;
+    LineMaker make;
+};
+
+/******************************************************
+#   now_sec
+#   @desc: monotonic clock in seconds
+#   @param: n/a
+#   @return: double seconds
+******************************************************/
+static double now_sec()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/******************************************************
+#   make_blank
+#   @desc: empty lines, blanks and comments
+#   @param: paths - paths the lines use
+#   @param: i - number of the line
+#   @param: out - receives the line
+#   @param: cap - size of out
+#   @return: void
+******************************************************/
+static void make_blank(const struct Paths *paths, int i, char *out, size_t cap)
+{
+    (void)paths;
+    switch (i % 3) {
+        case 0: snprintf(out, cap, "%s", ""); break;
+        case 1: snprintf(out, cap, "# comment %d", i); break;
+        default: snprintf(out, cap, "   # indented %d", i); break;
+    }
+}
+
+/******************************************************
+#   make_builtin
+#   @desc: commands that run inside the shell
+#   @param: paths - paths the lines use
+#   @param: i - number of the line
+#   @param: out - receives the line
+#   @param: cap - size of out
+#   @return: void
+******************************************************/
+static void make_builtin(const struct Paths *paths, int i, char *out, size_t cap)
+{
+    (void)paths;
+    switch (i % 5) {
+        case 0: snprintf(out, cap, "true"); break;
+        case 1: snprintf(out, cap, "test %d -ge 0", i); break;
+        case 2: snprintf(out, cap, "X=%d", i); break;
+        case 3: snprintf(out, cap, "echo line %d $X", i); break;
+        default: snprintf(out, cap, "[ -n \"$X\" ]"); break;
+    }
+}
+
+/******************************************************
+#   make_external
+#   @desc: programs run in the foreground
+#   @param: paths - paths the lines use
+#   @param: i - number of the line
+#   @param: out - receives the line
+#   @param: cap - size of out
+#   @return: void
+******************************************************/
+static void make_external(const struct Paths *paths, int i, char *out, size_t cap)
+{
+    if (i % 2 == 0) {
+        snprintf(out, cap, "%s", paths->true_path);
+    }
+    else {
+        snprintf(out, cap, "%s a b %d", paths->true_path, i);
+    }
+}
+
+/******************************************************
+#   make_redirect
+#   @desc: programs and builtins with redirections
+#   @param: paths - paths the lines use
+#   @param: i - number of the line
+#   @param: out - receives the line
+#   @param: cap - size of out
+#   @return: void
+******************************************************/
+static void make_redirect(const struct Paths *paths, int i, char *out, size_t cap)
+{
+    switch (i % 4) {
+        case 0: snprintf(out, cap, "%s > /dev/null", paths->true_path); break;
+        case 1: snprintf(out, cap, "%s < %s/in", paths->cat_path, paths->dir); break;
+        case 2: snprintf(out, cap, "echo %d > %s/out", i, paths->dir); break;
+        default: snprintf(out, cap, "%s 2> /dev/null < %s/in", paths->true_path, paths->dir); break;
+    }
+}
+
+/******************************************************
+#   make_background
+#   @desc: bursts of 16 background jobs, then wait
+#   @param: paths - paths the lines use
+#   @param: i - number of the line
+#   @param: out - receives the line
+#   @param: cap - size of out
+#   @return: void
+******************************************************/
+static void make_background(const struct Paths *paths, int i, char *out, size_t cap)
+{
+    if (i % 17 == 16) {
+        snprintf(out, cap, "wait");
+    }
+    else {
+        snprintf(out, cap, "%s &", paths->true_path);
+    }
+}
+
+static const struct Scenario scenarios[] = {
+    { "blank", make_blank },
+    { "builtin", make_builtin },
+    { "external", make_external },
+    { "redirect", make_redirect },
+    { "background", make_background },
+};
+
+/******************************************************
+#   find_program
+#   @desc: looks a program up in $PATH
+#   @param: name - program
+#   @param: out - receives its path
+#   @param: cap - size of out
+#   @return: 0 on success, -1 if not found
+******************************************************/
+static int find_program(const char *name, char *out, size_t cap)
+{
+    const char *path = getenv("PATH");
+    const char *dir = path != NULL ? path : "/bin:/usr/bin";
+
+    while (*dir != '\0') {
+        size_t len = strcspn(dir, ":");
+        snprintf(out, cap, "%.*s/%s", (int)len, dir, name);
+        if (len > 0 && access(out, X_OK) == 0) {
+            return 0;
+        }
+        dir += len + (dir[len] == ':');
+    }
+    return -1;
+}
+
+/******************************************************
+#   start_shell
+#   @desc: starts the shell reading its stdin from a
+#       pipe and writing its stdout to another; its
+#       stderr is discarded
+#   @param: shell - path of the binary
+#   @param: in_fd - receives the write end of its stdin
+#   @param: out_fd - receives the read end of its stdout
+#   @return: pid, -1 on failure
+******************************************************/
+static pid_t start_shell(const char *shell, int *in_fd, int *out_fd)
+{
+    posix_spawn_file_actions_t actions;
+    char *argv[] = { (char*)shell, NULL };
+    int in_pipe[2];
+    int out_pipe[2];
+    pid_t pid;
+    int result;
+
+    if (pipe2(in_pipe, O_CLOEXEC) == -1 || pipe2(out_pipe, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, in_pipe[0], 0);
+    posix_spawn_file_actions_adddup2(&actions, out_pipe[1], 1);
+    posix_spawn_file_actions_addopen(&actions, 2, "/dev/null", O_WRONLY, 0);
+    result = posix_spawn(&pid, shell, &actions, NULL, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(in_pipe[0]);
+    close(out_pipe[1]);
+    if (result != 0) {
+        close(in_pipe[1]);
+        close(out_pipe[0]);
+        return -1;
+    }
+
+    fcntl(in_pipe[1], F_SETFL, O_NONBLOCK);
+    *in_fd = in_pipe[1];
+    *out_fd = out_pipe[0];
+    return pid;
+}
+
+/******************************************************
+#   pump
+#   @desc: writes data to the shell while reading what
+#       it prints, until needle has been printed. Both
+#       at once, so neither side blocks on a full pipe.
+#   @param: in_fd - shell's stdin
+#   @param: data - bytes to write
+#   @param: len - number of bytes
+#   @param: out_fd - shell's stdout
+#   @param: needle - text to wait for
+#   @return: 0 once seen, -1 on EOF or a stall
+******************************************************/
+static int pump(int in_fd, const char *data, size_t len, int out_fd, const char *needle)
+{
+    size_t needle_len = strlen(needle);
+    char buf[65536 + LINE_MAX_LEN];
+    size_t kept = 0;
+    size_t sent = 0;
+
+    while (1) {
+        struct pollfd ready[2];
+        int count = 1;
+        ssize_t got;
+
+        ready[0].fd = out_fd;
+        ready[0].events = POLLIN;
+        if (sent < len) {
+            ready[1].fd = in_fd;
+            ready[1].events = POLLOUT;
+            count = 2;
+        }
+        if (poll(ready, count, STALL_MS) <= 0) {
+            return -1;
+        }
+
+        if (count == 2 && ready[1].revents != 0) {
+            ssize_t put = write(in_fd, data + sent, len - sent);
+            if (put == -1 && errno != EAGAIN) {
+                return -1;
+            }
+            if (put > 0) {
+                sent += put;
+            }
+        }
+        if (ready[0].revents == 0) {
+            continue;
+        }
+
+        /*Keep the end of what came before, the needle may span reads*/
+        got = read(out_fd, buf + kept, sizeof(buf) - kept);
+        if (got <= 0) {
+            return -1;
+        }
+        kept += got;
+        if (memmem(buf, kept, needle, needle_len) != NULL) {
+            return 0;
+        }
+        if (kept >= needle_len) {
+            memmove(buf, buf + kept - needle_len, needle_len);
+            kept = needle_len;
+        }
+    }
+}
+
+/******************************************************
+#   peak_rss_kb
+#   @desc: high water mark of a process's resident set
+#   @param: pid - process
+#   @return: KB, -1 if unknown
+******************************************************/
+static long peak_rss_kb(pid_t pid)
+{
+    char path[64];
+    char line[256];
+    long kb = -1;
+    FILE *status;
+
+    snprintf(path, sizeof(path), "/proc/%d/status", (int)pid);
+    status = fopen(path, "r");
+    if (status == NULL) {
+        return -1;
+    }
+    while (fgets(line, sizeof(line), status) != NULL) {
+        if (sscanf(line, "VmHWM: %ld", &kb) == 1) {
+            break;
+        }
+    }
+    fclose(status);
+    return kb;
+}
+
+/******************************************************
+#   stop_shell
+#   @desc: ends the shell's input and reaps it
+#   @param: pid - shell
+#   @param: in_fd - its stdin
+#   @param: out_fd - its stdout
+#   @return: void
+******************************************************/
+static void stop_shell(pid_t pid, int in_fd, int out_fd)
+{
+    char buf[4096];
+    int status;
+
+    close(in_fd);
+    while (read(out_fd, buf, sizeof(buf)) > 0) {
+    }
+    close(out_fd);
+    waitpid(pid, &status, 0);
+}
+
+/******************************************************
+#   by_value
+#   @desc: qsort order of doubles
+#   @param: a - first value
+#   @param: b - second value
+#   @return: <0, 0 or >0
+******************************************************/
+static int by_value(const void *a, const void *b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/******************************************************
+#   run_scenario
+#   @desc: runs one scenario and prints its JSON line
+#   @param: shell - path of the binary
+#   @param: paths - paths the lines use
+#   @param: scenario - what to run
+#   @param: n - commands in the stream
+#   @param: samples - commands timed one at a time
+#   @return: 0 on success, -1 on failure
+******************************************************/
+static int run_scenario(const char *shell, const struct Paths *paths, const struct Scenario *scenario,
+        int n, int samples)
+{
+    char *stream = malloc((size_t)n * (LINE_MAX_LEN + 1) + 32);
+    double *latency = malloc((size_t)samples * sizeof(double));
+    char line[LINE_MAX_LEN];
+    char needle[64];
+    size_t len = 0;
+    double start;
+    double seconds;
+    long rss;
+    long rss_one;
+    int in_fd;
+    int out_fd;
+    pid_t pid;
+    int i;
+
+    if (stream == NULL || latency == NULL) {
+        free(stream);
+        free(latency);
+        return -1;
+    }
+
+    /*Whole stream at once; started and idle before the clock starts*/
+    for (i = 0; i < n; i++) {
+        scenario->make(paths, i, line, sizeof(line));
+        len += sprintf(stream + len, "%s\n", line);
+    }
+    len += sprintf(stream + len, "wait\necho @end\n");
+
+    pid = start_shell(shell, &in_fd, &out_fd);
+    if (pid == -1 || pump(in_fd, "echo @ready\n", 12, out_fd, "@ready\n") == -1) {
+        fprintf(stderr, "stream_bench: %s did not start\n", shell);
+        free(stream);
+        free(latency);
+        return -1;
+    }
+    start = now_sec();
+    if (pump(in_fd, stream, len, out_fd, "@end\n") == -1) {
+        fprintf(stderr, "stream_bench: %s: shell stalled\n", scenario->name);
+        kill(pid, SIGKILL);
+        stop_shell(pid, in_fd, out_fd);
+        free(stream);
+        free(latency);
+        return -1;
+    }
+    seconds = now_sec() - start;
+    rss = peak_rss_kb(pid);
+    stop_shell(pid, in_fd, out_fd);
+
+    /*One at a time, each answered by its marker*/
+    pid = start_shell(shell, &in_fd, &out_fd);
+    if (pid == -1) {
+        free(stream);
+        free(latency);
+        return -1;
+    }
+    for (i = 0; i < samples; i++) {
+        double begin;
+        scenario->make(paths, i, line, sizeof(line));
+        len = snprintf(stream, (size_t)n * (LINE_MAX_LEN + 1) + 32, "%s\necho @%d\n", line, i);
+        snprintf(needle, sizeof(needle), "@%d\n", i);
+        begin = now_sec();
+        if (pump(in_fd, stream, len, out_fd, needle) == -1) {
+            fprintf(stderr, "stream_bench: %s: shell stalled\n", scenario->name);
+            kill(pid, SIGKILL);
+            break;
+        }
+        latency[i] = now_sec() - begin;
+    }
+    samples = i;
+    rss_one = peak_rss_kb(pid);
+    stop_shell(pid, in_fd, out_fd);
+
+    qsort(latency, samples, sizeof(double), by_value);
+    printf("{\"bench\":\"stream\",\"scenario\":\"%s\",\"commands\":%d,\"seconds\":%.6f,"
+            "\"cmds_per_sec\":%.0f,\"samples\":%d,\"p50_us\":%.1f,\"p99_us\":%.1f,\"peak_rss_kb\":%ld}\n",
+            scenario->name, n, seconds, n / seconds, samples,
+            samples > 0 ? latency[samples / 2] * 1e6 : 0,
+            samples > 0 ? latency[(samples * 99) / 100] * 1e6 : 0,
+            rss_one > rss ? rss_one : rss);
+    fflush(stdout);
+
+    free(stream);
+    free(latency);
+    return 0;
+}
+
+/******************************************************
+#   main
+#   @desc: runs every scenario against the shell
+#   @param: argc - argument count
+#   @param: argv - [shell] [commands] [samples]
+#   @return: 0, 1 if a scenario failed
+******************************************************/
+int main(int argc, char **argv)
+{
+    const char *shell = argc > 1 ? argv[1] : "./main";
+    int n = argc > 2 ? atoi(argv[2]) : 2000;
+    int samples = argc > 3 ? atoi(argv[3]) : 1000;
+    struct Paths paths;
+    char file[128];
+    FILE *in;
+    int failed = 0;
+    size_t i;
+
+    if (n < 1) {
+        n = 1;
+    }
+    if (samples > n) {
+        samples = n;
+    }
+    if (find_program("true", paths.true_path, sizeof(paths.true_path)) == -1
+            || find_program("cat", paths.cat_path, sizeof(paths.cat_path)) == -1) {
+        fprintf(stderr, "stream_bench: true and cat must be in PATH\n");
+        return 1;
+    }
+    snprintf(paths.dir, sizeof(paths.dir), "%s/stream_bench.XXXXXX",
+            getenv("TMPDIR") != NULL && strlen(getenv("TMPDIR")) < 32 ? getenv("TMPDIR") : "/tmp");
+    if (mkdtemp(paths.dir) == NULL) {
+        perror("stream_bench: mkdtemp");
+        return 1;
+    }
+    snprintf(file, sizeof(file), "%s/in", paths.dir);
+    in = fopen(file, "w");
+    if (in != NULL) {
+        fprintf(in, "input line\n");
+        fclose(in);
+    }
+
+    for (i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        if (run_scenario(shell, &paths, &scenarios[i], n, samples) == -1) {
+            failed = 1;
+        }
+    }
+
+    unlink(file);
+    snprintf(file, sizeof(file), "%s/out", paths.dir);
+    unlink(file);
+    rmdir(paths.dir);
+    return failed;
+}
@@ -17,30 +17,95 @@
 
 #include "simple_shell.h"
 
-int main()
+int main(int argc, char *argv[])
 {
 
-    struct Shell *curUser = sh_init();
+    struct Shell *curUser;
+    int opened;
+    int status;
+    int arg = 1;
 
-    /*Catch signals to ignore CTRL-C*/
+    /*Started by the shell to exec a program under limits*/
+    if (argc > 1 && strcmp(argv[1], LIMIT_EXEC_ARG) == 0) {
+        sh_limit_exec(argc, argv);
+    }
+
+    curUser = sh_init();
+
+    /*--trace FILE writes JSON lines, --trace-chrome FILE a Chrome trace*/
+    while (arg + 1 < argc && (strcmp(argv[arg], "--trace") == 0
+                || strcmp(argv[arg], "--trace-chrome") == 0)) {
+        int chrome = strcmp(argv[arg], "--trace-chrome") == 0;
+        sh_trace_close(&curUser->trace);
+        if (sh_trace_open(&curUser->trace, argv[arg + 1], chrome) == -1) {
+            fprintf(stderr, "simple_shell: cannot open %s for tracing\n", argv[arg + 1]);
+            exit(1);
+        }
+        arg += 2;
+    }
+
+    /*Pick the input: -c string, script file, or stdin*/
+    if (argc > arg + 1 && strcmp(argv[arg], "-c") == 0) {
+        opened = sh_input_string(&curUser->input, argv[arg + 1]);
+    }
+    else if (argc > arg) {
+        int script_fd = open(argv[arg], O_RDONLY | O_CLOEXEC);
+        if (script_fd == -1) {
+            fprintf(stderr, "simple_shell: cannot open %s\n", argv[arg]);
+            exit(127);
+        }
+        opened = sh_input_open(&curUser->input, script_fd);
+    }
+    else {
+        opened = sh_input_open(&curUser->input, 0);
+    }
+    if (opened == -1) {
+        fprintf(stderr, "simple_shell: out of memory\n");
+        exit(1);
+    }
+
+    /*History is kept for terminals, or wherever $HISTFILE says*/
+    if (curUser->input.interactive || getenv("HISTFILE") != NULL) {
+        char history_path[PATH_MAX];
+        const char *path = getenv("HISTFILE");
+        if (path == NULL && getenv("HOME") != NULL) {
+            snprintf(history_path, sizeof(history_path), "%s/%s", getenv("HOME"), HISTORY_FILE);
+            path = history_path;
+        }
+        if (path != NULL) {
+            sh_history_open(&curUser->history, path);
+        }
+    }
+
+    /*On a terminal, jobs get process groups and the terminal*/
+    sh_jobctl_init(curUser);
+
+    /*CTRL-C never kills the shell; background jobs without job control inherit this*/
     struct sigaction ignoreC;
     ignoreC.sa_handler = SIG_IGN;
     ignoreC.sa_flags = 0;
     sigfillset(&(ignoreC.sa_mask));
     sigaction(SIGINT, &ignoreC, NULL);
 
+    /*Input, finished children and CTRL-C arrive as events*/
+    sh_loop_init(curUser);
+
     while (1) {
         sh_catch_bg(curUser);
-        sh_get_commands(curUser);
+        /*End of input acts like exit*/
+        if (sh_get_commands(curUser) == 0) {
+            break;
+        }
         sh_parse_args(curUser);
-        sh_command_ground(curUser);
-        sh_identify_command(curUser);
+        sh_ast_run(curUser, &curUser->line, curUser->line.root);
     }
 
 
-    /*Clean up*/
+    /*Clean up; the last command's status is the shell's*/
+    status = sh_exit_status(curUser);
+    sh_kill_zombies(curUser);
     sh_free(curUser);
 
-    exit(0);
+    exit(status);
 
 }
\ No newline at end of file
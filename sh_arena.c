@@ -0,0 +1,173 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_arena.c
+#   Description: Bump allocator for per-command data.
+#       Everything parsed from one input line lives in
+#       the arena and is released at once by a reset
+#       before the next prompt. Blocks are kept across
+#       resets so steady state parsing never calls malloc.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_arena_new_block
+#   @desc: mallocs a block with room for size bytes
+#   @param: size - usable bytes in the block
+#   @return: new block, NULL if out of memory
+******************************************************/
+static struct ArenaBlock* sh_arena_new_block(size_t size)
+{
+    struct ArenaBlock *block = malloc(sizeof(struct ArenaBlock) + size);
+
+    if (block != NULL) {
+        block->next = NULL;
+        block->size = size;
+        block->used = 0;
+    }
+
+    return block;
+}
+
+/******************************************************
+#   sh_arena_init
+#   @desc: sets up an arena with one block
+#   @param: arena - arena to initialize
+#   @param: size - bytes in the first block
+#   @return: void
+******************************************************/
+void sh_arena_init(struct Arena *arena, size_t size)
+{
+    arena->first = sh_arena_new_block(size);
+    arena->current = arena->first;
+}
+
+/******************************************************
+#   sh_arena_alloc
+#   @desc: returns size bytes aligned for any pointer
+#       type, moving to the next kept block or adding a
+#       new block when the current one is full
+#   @param: arena - arena to allocate from
+#   @param: size - number of bytes
+#   @return: pointer into the arena, NULL if out of memory
+******************************************************/
+void* sh_arena_alloc(struct Arena *arena, size_t size)
+{
+    struct ArenaBlock *block = arena->current;
+    size_t start;
+
+    /*Round up so every allocation stays aligned*/
+    size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+    while (block != NULL) {
+        start = block->used;
+        if (block->size - start >= size) {
+            block->used = start + size;
+            arena->current = block;
+            return block->data + start;
+        }
+
+        /*Reuse blocks kept from earlier commands*/
+        if (block->next == NULL) {
+            size_t grow = block->size * 2;
+            block->next = sh_arena_new_block(grow > size ? grow : size);
+        }
+        block = block->next;
+    }
+
+    return NULL;
+}
+
+/******************************************************
+#   sh_arena_reset
+#   @desc: releases everything allocated from the arena.
+#       If the last command spilled into several blocks
+#       they are merged into one big enough for all of it.
+#   @param: arena - arena to reset
+#   @return: void
+******************************************************/
+void sh_arena_reset(struct Arena *arena)
+{
+    struct ArenaBlock *block = arena->first;
+    size_t total = 0;
+
+    if (block == NULL) {
+        return;
+    }
+
+    /*Common case: a single block, just rewind it*/
+    if (block->next == NULL) {
+        block->used = 0;
+        arena->current = block;
+        return;
+    }
+
+    while (block != NULL) {
+        struct ArenaBlock *next = block->next;
+        total += block->size;
+        free(block);
+        block = next;
+    }
+
+    arena->first = sh_arena_new_block(total);
+    arena->current = arena->first;
+}
+
+/******************************************************
+#   sh_arena_mark
+#   @desc: remembers how much of the arena is in use, so
+#       what is allocated after can be released alone
+#   @param: arena - arena to mark
+#   @param: mark - receives the position
+#   @return: void
+******************************************************/
+void sh_arena_mark(struct Arena *arena, struct ArenaMark *mark)
+{
+    mark->block = arena->current;
+    mark->used = arena->current ? arena->current->used : 0;
+}
+
+/******************************************************
+#   sh_arena_release
+#   @desc: releases everything allocated since the mark,
+#       keeping the blocks for reuse
+#   @param: arena - arena to rewind
+#   @param: mark - position from sh_arena_mark
+#   @return: void
+******************************************************/
+void sh_arena_release(struct Arena *arena, const struct ArenaMark *mark)
+{
+    struct ArenaBlock *block;
+
+    if (mark->block == NULL) {
+        return;
+    }
+    for (block = mark->block->next; block != NULL; block = block->next) {
+        block->used = 0;
+    }
+    mark->block->used = mark->used;
+    arena->current = mark->block;
+}
+
+/******************************************************
+#   sh_arena_free
+#   @desc: returns all blocks to the system
+#   @param: arena - arena to free
+#   @return: void
+******************************************************/
+void sh_arena_free(struct Arena *arena)
+{
+    struct ArenaBlock *block = arena->first;
+
+    while (block != NULL) {
+        struct ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+}
@@ -0,0 +1,814 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_ast.c
+#   Description: Compiled command lines. A line is
+#       tokenized once and parsed into a flat array of
+#       nodes for ;, &, &&, ||, ( ) and { }; pipelines and
+#       simple commands are leaves that refer to their
+#       words by index. Here-doc bodies are read while
+#       compiling. The interpreter walks the nodes,
+#       expanding each command's words into the arena
+#       just before it runs, so a compiled line can be
+#       run any number of times without parsing again.
+#
+******************************************************/
+#include "simple_shell.h"
+
+/*Closing word a list stops at*/
+#define AST_END_LINE 0
+#define AST_END_PAREN 1 /* ) */
+#define AST_END_BRACE 2 /* } */
+
+/*State of the parser over the words of a line*/
+struct AstParser
+{
+    struct Ast *ast;
+    int pos; /*next word*/
+    int error; /*1 once a syntax error was found*/
+};
+
+
+/******************************************************
+#   sh_ast_node
+#   @desc: appends a node to the flat array
+#   @param: parser - parser state
+#   @param: kind - AST_* node kind
+#   @param: left - operand or body, -1 if none
+#   @param: first - first word it uses
+#   @param: count - number of words it uses
+#   @return: index of the new node
+******************************************************/
+static int sh_ast_node(struct AstParser *parser, int kind, int left, int first, int count)
+{
+    struct AstNode *node = &parser->ast->nodes[parser->ast->node_count];
+
+    node->kind = kind;
+    node->left = left;
+    node->right = -1;
+    node->first = first;
+    node->count = count;
+    return parser->ast->node_count++;
+}
+
+/******************************************************
+#   sh_ast_is
+#   @desc: tells whether the next word is an operator
+#   @param: parser - parser state
+#   @param: op - operator (sh_op_*)
+#   @return: 1 if it is, 0 otherwise
+******************************************************/
+static int sh_ast_is(struct AstParser *parser, const char *op)
+{
+    return parser->pos < parser->ast->word_count && parser->ast->words[parser->pos] == op;
+}
+
+/******************************************************
+#   sh_ast_reserved
+#   @desc: tells whether the next word is an unquoted
+#       { or }, which only count where a command starts
+#   @param: parser - parser state
+#   @param: text - "{" or "}"
+#   @return: 1 if it is, 0 otherwise
+******************************************************/
+static int sh_ast_reserved(struct AstParser *parser, const char *text)
+{
+    struct Ast *ast = parser->ast;
+
+    return parser->pos < ast->word_count && ast->flags[parser->pos] == 0
+        && !sh_is_operator(ast->words[parser->pos]) && strcmp(ast->words[parser->pos], text) == 0;
+}
+
+/******************************************************
+#   sh_ast_at_end
+#   @desc: tells whether the list being parsed is over
+#   @param: parser - parser state
+#   @param: end - AST_END_* the list stops at
+#   @return: 1 at the end, 0 otherwise
+******************************************************/
+static int sh_ast_at_end(struct AstParser *parser, int end)
+{
+    if (parser->pos == parser->ast->word_count) {
+        return 1;
+    }
+    if (end == AST_END_PAREN) {
+        return sh_ast_is(parser, sh_op_close);
+    }
+    if (end == AST_END_BRACE) {
+        return sh_ast_reserved(parser, "}");
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_ast_ends_command
+#   @desc: tells whether a word ends a pipeline
+#   @param: word - word from sh_tokenize
+#   @return: 1 for ; & && || ( ), 0 otherwise
+******************************************************/
+static int sh_ast_ends_command(const char *word)
+{
+    return word == sh_op_semicolon || word == sh_op_background || word == sh_op_and
+        || word == sh_op_or || word == sh_op_open || word == sh_op_close;
+}
+
+static int sh_ast_list(struct AstParser *parser, int end);
+
+/******************************************************
+#   sh_ast_interrupted
+#   @desc: tells whether the last command was killed by
+#       CTRL-C
+#   @param: pointer to shell object
+#   @return: 1 if it was, 0 otherwise
+******************************************************/
+static int sh_ast_interrupted(struct Shell *this_shell)
+{
+    return this_shell->signaled && this_shell->status == SIGINT;
+}
+
+/******************************************************
+#   sh_ast_command
+#   @desc: parses a pipeline of simple commands, or a
+#       ( list ) or { list; } with its redirections
+#   @param: parser - parser state
+#   @return: node index, -1 on a syntax error
+******************************************************/
+static int sh_ast_command(struct AstParser *parser)
+{
+    struct Ast *ast = parser->ast;
+    int first = parser->pos;
+    int kind;
+    int body;
+
+    if (sh_ast_is(parser, sh_op_open) || sh_ast_reserved(parser, "{")) {
+        kind = sh_ast_is(parser, sh_op_open) ? AST_SUBSHELL : AST_GROUP;
+        parser->pos++;
+        body = sh_ast_list(parser, kind == AST_SUBSHELL ? AST_END_PAREN : AST_END_BRACE);
+
+        /*Groups need a body and their closing word*/
+        if (body == -1 || !sh_ast_at_end(parser, kind == AST_SUBSHELL ? AST_END_PAREN : AST_END_BRACE)
+                || parser->pos == ast->word_count) {
+            parser->error = 1;
+            return -1;
+        }
+        parser->pos++;
+
+        /*Redirections apply to the whole group*/
+        first = parser->pos;
+        while (parser->pos < ast->word_count) {
+            int used = sh_redirect_words(ast->words[parser->pos]);
+            if (used == 0) {
+                break;
+            }
+            if (parser->pos + used > ast->word_count
+                    || (used == 2 && sh_is_operator(ast->words[parser->pos + 1]))) {
+                parser->error = 1;
+                return -1;
+            }
+            parser->pos += used;
+        }
+        return sh_ast_node(parser, kind, body, first, parser->pos - first);
+    }
+
+    /*Words up to the next control operator; | stays inside*/
+    while (parser->pos < ast->word_count && !sh_ast_ends_command(ast->words[parser->pos])) {
+        parser->pos++;
+    }
+    if (parser->pos == first) {
+        parser->error = 1;
+        return -1;
+    }
+    return sh_ast_node(parser, AST_COMMAND, -1, first, parser->pos - first);
+}
+
+/******************************************************
+#   sh_ast_and_or
+#   @desc: parses pipelines joined by && and ||, which
+#       group from the left
+#   @param: parser - parser state
+#   @return: node index, -1 on a syntax error
+******************************************************/
+static int sh_ast_and_or(struct AstParser *parser)
+{
+    int left = sh_ast_command(parser);
+
+    while (left != -1 && (sh_ast_is(parser, sh_op_and) || sh_ast_is(parser, sh_op_or))) {
+        int kind = sh_ast_is(parser, sh_op_and) ? AST_AND : AST_OR;
+        int right;
+
+        parser->pos++;
+        right = sh_ast_command(parser);
+        if (right == -1) {
+            return -1;
+        }
+        left = sh_ast_node(parser, kind, left, 0, 0);
+        parser->ast->nodes[left].right = right;
+    }
+    return left;
+}
+
+/******************************************************
+#   sh_ast_list
+#   @desc: parses and-or lists separated by ; or &,
+#       chained through AST_SEQUENCE nodes so running a
+#       long list never recurses
+#   @param: parser - parser state
+#   @param: end - AST_END_* the list stops at
+#   @return: first node of the chain, -1 if the list is
+#       empty or on a syntax error
+******************************************************/
+static int sh_ast_list(struct AstParser *parser, int end)
+{
+    int head = -1;
+    int tail = -1;
+
+    while (!sh_ast_at_end(parser, end)) {
+        int item = sh_ast_and_or(parser);
+        int link;
+
+        if (item == -1) {
+            return -1;
+        }
+        if (sh_ast_is(parser, sh_op_background)) {
+            item = sh_ast_node(parser, AST_BACKGROUND, item, 0, 0);
+            parser->pos++;
+        }
+        else if (sh_ast_is(parser, sh_op_semicolon)) {
+            parser->pos++;
+        }
+        else if (!sh_ast_at_end(parser, end)) {
+            parser->error = 1;
+            return -1;
+        }
+
+        link = sh_ast_node(parser, AST_SEQUENCE, item, 0, 0);
+        if (tail == -1) {
+            head = link;
+        }
+        else {
+            parser->ast->nodes[tail].right = link;
+        }
+        tail = link;
+    }
+    return head;
+}
+
+/******************************************************
+#   sh_ast_delimiter
+#   @desc: turns a compiled here-doc delimiter back into
+#       its text, as delimiters are never expanded
+#   @param: word - compiled word
+#   @return: void
+******************************************************/
+static void sh_ast_delimiter(char *word)
+{
+    char *out = word;
+
+    for (; *word != '\0'; word++) {
+        if (*word == '\\' && word[1] != '\0') {
+            *out++ = *++word;
+        }
+        else if (*word == PARAM_UNQUOTED || *word == PARAM_QUOTED) {
+            *out++ = '$';
+        }
+        else if (*word != PARAM_END) {
+            *out++ = *word;
+        }
+    }
+    *out = '\0';
+}
+
+/******************************************************
+#   sh_ast_compile
+#   @desc: tokenizes and parses a line into ast, then
+#       reads the bodies of its here-docs from the input.
+#       A line that doesn't compile keeps why in
+#       ast->error for sh_ast_error.
+#   @param: pointer to shell object
+#   @param: arena - holds the compiled line
+#   @param: line - input line (need not be terminated)
+#   @param: len - number of bytes in line
+#   @param: ast - receives the compiled line
+#   @return: PARSE_OK, PARSE_UNTERMINATED, PARSE_NOMEM or
+#       PARSE_SYNTAX
+******************************************************/
+int sh_ast_compile(struct Shell *this_shell, struct Arena *arena, const char *line, size_t len, struct Ast *ast)
+{
+    struct AstParser parser;
+    int result;
+    int i;
+
+    ast->root = -1;
+    ast->node_count = 0;
+    ast->near = -1;
+
+    result = sh_tokenize(arena, line, len, &ast->words, &ast->word_count, &ast->flags);
+    if (result != PARSE_OK) {
+        ast->word_count = 0;
+        return ast->error = result;
+    }
+
+    /*A word makes at most two nodes: its command and the list link*/
+    ast->nodes = sh_arena_alloc(arena, 2 * (ast->word_count + 1) * sizeof(struct AstNode));
+    if (ast->nodes == NULL) {
+        return ast->error = PARSE_NOMEM;
+    }
+
+    parser.ast = ast;
+    parser.pos = 0;
+    parser.error = 0;
+    ast->root = sh_ast_list(&parser, AST_END_LINE);
+
+    if (parser.error || parser.pos < ast->word_count) {
+        ast->near = parser.pos < ast->word_count ? parser.pos : -1;
+        ast->root = -1;
+        return ast->error = PARSE_SYNTAX;
+    }
+
+    /*Here-doc bodies follow the line*/
+    for (i = 0; i + 1 < ast->word_count; i++) {
+        char *body;
+
+        if ((ast->words[i] != sh_op_heredoc && ast->words[i] != sh_op_heredoc_tab)
+                || sh_is_operator(ast->words[i + 1])) {
+            continue;
+        }
+        sh_ast_delimiter(ast->words[i + 1]);
+        if (sh_redirect_heredoc(this_shell, arena, ast->words[i + 1], ast->words[i] == sh_op_heredoc_tab,
+                    &body) == -1) {
+            ast->root = -1;
+            return ast->error = PARSE_NOMEM;
+        }
+        ast->words[i + 1] = body;
+        ast->flags[i + 1] = 0;
+    }
+
+    return ast->error = PARSE_OK;
+}
+
+/******************************************************
+#   sh_ast_error
+#   @desc: reports why a line didn't compile
+#   @param: ast - line from sh_ast_compile
+#   @return: void
+******************************************************/
+void sh_ast_error(const struct Ast *ast)
+{
+    if (ast->error == PARSE_UNTERMINATED) {
+        fprintf(stdout, "simple_shell: unterminated quote\n");
+    }
+    else if (ast->error == PARSE_SYNTAX) {
+        fprintf(stdout, "simple_shell: syntax error near %s\n",
+                ast->near == -1 ? "newline" : ast->words[ast->near]);
+    }
+    else {
+        fprintf(stdout, "simple_shell: out of memory\n");
+    }
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_ast_span
+#   @desc: finds the words a node was compiled from
+#   @param: ast - compiled line
+#   @param: index - node
+#   @param: lo - lowest word index, updated
+#   @param: hi - one past the highest, updated
+#   @return: void
+******************************************************/
+static void sh_ast_span(const struct Ast *ast, int index, int *lo, int *hi)
+{
+    for (; index != -1; index = ast->nodes[index].right) {
+        const struct AstNode *node = &ast->nodes[index];
+
+        switch (node->kind) {
+        case AST_COMMAND:
+            if (node->first < *lo) {
+                *lo = node->first;
+            }
+            if (node->first + node->count > *hi) {
+                *hi = node->first + node->count;
+            }
+            return;
+        case AST_GROUP:
+        case AST_SUBSHELL:
+            /*From the opening word to the last redirection*/
+            sh_ast_span(ast, node->left, lo, hi);
+            if (*lo > 0) {
+                (*lo)--;
+            }
+            if (node->first + node->count > *hi) {
+                *hi = node->first + node->count;
+            }
+            return;
+        case AST_BACKGROUND:
+            sh_ast_span(ast, node->left, lo, hi);
+            return;
+        default:
+            /*SEQUENCE, AND and OR go on to the right*/
+            sh_ast_span(ast, node->left, lo, hi);
+            break;
+        }
+    }
+}
+
+/******************************************************
+#   sh_ast_text
+#   @desc: writes a node back out as the words it was
+#       compiled from, for the jobs list. Here-doc bodies
+#       are left out.
+#   @param: ast - compiled line
+#   @param: index - node
+#   @return: malloc'd text, NULL if out of memory
+******************************************************/
+char* sh_ast_text(const struct Ast *ast, int index)
+{
+    int lo = ast->word_count;
+    int hi = 0;
+    size_t len = 1;
+    char *text;
+    char *out;
+    int i;
+
+    sh_ast_span(ast, index, &lo, &hi);
+    for (i = lo; i < hi; i++) {
+        len += strlen(ast->words[i]) + 1;
+    }
+    text = malloc(len);
+    if (text == NULL) {
+        return NULL;
+    }
+
+    out = text;
+    for (i = lo; i < hi; i++) {
+        const char *word = ast->words[i];
+
+        if (i > lo && (ast->words[i - 1] == sh_op_heredoc || ast->words[i - 1] == sh_op_heredoc_tab)) {
+            continue;
+        }
+        if (out != text) {
+            *out++ = ' ';
+        }
+        for (; *word != '\0'; word++) {
+            if (*word == '\\' && word[1] != '\0') {
+                *out++ = *++word;
+            }
+            else if (*word == PARAM_UNQUOTED || *word == PARAM_QUOTED) {
+                *out++ = '$';
+            }
+            else if (*word != PARAM_END) {
+                *out++ = *word;
+            }
+        }
+    }
+    *out = '\0';
+
+    return text;
+}
+
+/******************************************************
+#   sh_ast_expand
+#   @desc: expands count words of a compiled line into
+#       this_shell->arguments: parameters are filled in,
+#       words that expand to nothing are dropped and
+#       patterns are replaced by the files they match.
+#       Words that need neither are used as they are.
+#   @param: pointer to shell object
+#   @param: ast - compiled line
+#   @param: first - first word
+#   @param: count - number of words
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_ast_expand(struct Shell *this_shell, const struct Ast *ast, int first, int count)
+{
+    char **argv = sh_arena_alloc(&this_shell->arena, (count + 1) * sizeof(char*));
+    unsigned char *globs = NULL;
+    int argc = 0;
+    int i;
+
+    if (argv == NULL) {
+        return -1;
+    }
+
+    for (i = first; i < first + count; i++) {
+        char *word = ast->words[i];
+        int flags = ast->flags[i];
+        int glob = (flags & WORD_GLOB) != 0;
+
+        if (flags & WORD_PARAM) {
+            word = sh_expand_word(this_shell, word, &glob);
+            if (word == NULL) {
+                return -1;
+            }
+            /*Unquoted expansion of nothing leaves no word*/
+            if (*word == '\0' && !(flags & WORD_QUOTED)) {
+                continue;
+            }
+        }
+
+        if (glob) {
+            if (globs == NULL) {
+                globs = sh_arena_alloc(&this_shell->arena, count + 1);
+                if (globs == NULL) {
+                    return -1;
+                }
+                memset(globs, 0, count + 1);
+            }
+            globs[argc] = 1;
+        }
+        argv[argc++] = word;
+    }
+    argv[argc] = NULL;
+
+    this_shell->arguments = argv;
+    this_shell->args_count = argc;
+    this_shell->glob.words = globs;
+
+    return sh_glob_expand(this_shell);
+}
+
+/******************************************************
+#   sh_ast_redirect
+#   @desc: expands and opens the redirections of a group
+#   @param: pointer to shell object
+#   @param: ast - compiled line
+#   @param: node - group node
+#   @param: list - receives the opened redirections
+#   @param: count - receives number of redirections
+#   @return: 0 on success, -1 after reporting the error
+******************************************************/
+static int sh_ast_redirect(struct Shell *this_shell, const struct Ast *ast, const struct AstNode *node,
+        struct Redirect **list, int *count)
+{
+    *list = NULL;
+    *count = 0;
+
+    if (node->count == 0) {
+        return 0;
+    }
+    if (sh_ast_expand(this_shell, ast, node->first, node->count) == -1
+            || sh_redirect_extract(this_shell, this_shell->arguments, &this_shell->args_count, list, count) == -1
+            || this_shell->args_count != 0) {
+        fprintf(stdout, "simple_shell: syntax error in redirection\n");
+        fflush(stdout);
+        return -1;
+    }
+    return sh_redirect_open(*list, *count);
+}
+
+/******************************************************
+#   sh_ast_group
+#   @desc: runs the body of { } or ( ) with the group's
+#       redirections applied to the shell around it
+#   @param: pointer to shell object
+#   @param: ast - compiled line
+#   @param: node - group node
+#   @return: void
+******************************************************/
+static void sh_ast_group(struct Shell *this_shell, const struct Ast *ast, const struct AstNode *node)
+{
+    struct Redirect *list;
+    int count;
+    int saved[REDIRECT_FDS];
+
+    if (sh_ast_redirect(this_shell, ast, node, &list, &count) == -1) {
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+    if (count == 0) {
+        sh_ast_run(this_shell, ast, node->left);
+        return;
+    }
+
+    sh_redirect_push(list, count, saved);
+    sh_ast_run(this_shell, ast, node->left);
+    sh_redirect_pop(saved);
+    sh_redirect_close(list, count);
+}
+
+static void sh_ast_node_run(struct Shell *this_shell, const struct Ast *ast, int index, int background);
+
+/******************************************************
+#   sh_ast_fork
+#   @desc: runs a node in a copy of the shell: a ( )
+#       group, or a list sent to the background. The
+#       copy forgets the shell's jobs and trace, runs
+#       the node and exits with its status. It is a job
+#       of its own like any program, while the commands
+#       it runs stay in its process group.
+#   @param: pointer to shell object
+#   @param: ast - compiled line
+#   @param: index - node run by the copy
+#   @param: background - 1 to leave it running
+#   @return: void
+******************************************************/
+static void sh_ast_fork(struct Shell *this_shell, const struct Ast *ast, int index, int background)
+{
+    const struct AstNode *node = &ast->nodes[index];
+    struct JobControl *control = &this_shell->control;
+    int own_group;
+    struct sigaction action;
+    sigset_t interrupt;
+    pid_t child_PID;
+    int made_group;
+    int own_deadline;
+    int capturing;
+
+    /*Job gets a cgroup of its own if the session has a root for them*/
+    made_group = sh_limit_begin(this_shell);
+    /*A deadline needs a group to signal*/
+    own_deadline = sh_deadline_begin(this_shell);
+    own_group = background || control->enabled || own_deadline;
+    capturing = background && sh_capture_begin(this_shell);
+
+    /*Output written so far must not be written twice*/
+    fflush(stdout);
+    child_PID = fork();
+
+    if (child_PID == 0) {
+        /*Limit itself before starting anything, which then inherits them*/
+        sh_limit_attach(this_shell);
+        sh_limit_child(this_shell);
+        sh_captures_child(&this_shell->captures);
+        sh_timers_child(&this_shell->timers);
+
+        /*In the subshell: out of reach of CTRL-C at the terminal, or in its own group*/
+        if (own_group) {
+            setpgid(0, 0);
+            if (control->enabled && !background) {
+                tcsetpgrp(control->tty_fd, getpid());
+            }
+        }
+        action.sa_handler = (background && !control->enabled) ? SIG_IGN : SIG_DFL;
+        action.sa_flags = 0;
+        sigfillset(&(action.sa_mask));
+        sigaction(SIGINT, &action, NULL);
+        action.sa_handler = SIG_DFL;
+        sigaction(SIGTSTP, &action, NULL);
+        sigaction(SIGTTIN, &action, NULL);
+        sigaction(SIGTTOU, &action, NULL);
+        sigemptyset(&interrupt);
+        sigaddset(&interrupt, SIGINT);
+        sigprocmask(SIG_UNBLOCK, &interrupt, NULL);
+
+        control->enabled = 0;
+        sh_jobs_free(&this_shell->jobs);
+        sh_jobs_init(&this_shell->jobs);
+        this_shell->trace.fd = -1;
+
+        if (node->kind == AST_SUBSHELL) {
+            sh_ast_group(this_shell, ast, node);
+        }
+        else {
+            sh_ast_node_run(this_shell, ast, index, 0);
+        }
+        fflush(stdout);
+
+        /*Die the way its last command did*/
+        if (this_shell->signaled) {
+            sigset_t none;
+            signal(this_shell->status, SIG_DFL);
+            sigemptyset(&none);
+            sigprocmask(SIG_SETMASK, &none, NULL);
+            raise(this_shell->status);
+        }
+        _exit(this_shell->status);
+    }
+
+    if (capturing) {
+        sh_capture_end(this_shell, child_PID > 0);
+    }
+    if (child_PID == -1) {
+        fprintf(stdout, "simple_shell: fork failed\n");
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        if (made_group) {
+            sh_limit_end(this_shell);
+        }
+        if (own_deadline) {
+            sh_deadline_end(this_shell);
+        }
+        return;
+    }
+
+    /*Set the group from both sides to avoid a race*/
+    if (own_group) {
+        setpgid(child_PID, child_PID);
+        sh_deadline_arm(this_shell, -child_PID);
+    }
+    this_shell->job_ast = ast;
+    this_shell->job_node = index;
+
+    if (background) {
+        printf("background pid is %d\n", child_PID);
+        this_shell->last_bg = child_PID;
+        fflush(stdout);
+        sh_job_started(this_shell, child_PID, child_PID);
+        if (own_deadline) {
+            sh_deadline_end(this_shell);
+        }
+        return;
+    }
+
+    if (control->enabled) {
+        sh_job_foreground(this_shell, child_PID);
+    }
+    sh_usage_begin(&this_shell->usage);
+    sh_wait_fg(this_shell, own_group ? child_PID : -1, &child_PID, 1);
+    sh_usage_end(&this_shell->usage);
+    if (made_group) {
+        sh_limit_end(this_shell);
+    }
+    if (own_deadline) {
+        sh_deadline_end(this_shell);
+    }
+}
+
+/******************************************************
+#   sh_ast_node_run
+#   @desc: runs one node. Pipelines and simple commands
+#       go through sh_command_ground and
+#       sh_identify_command as typed lines always did;
+#       anything else sent to the background runs in a
+#       subshell.
+#   @param: pointer to shell object
+#   @param: ast - compiled line
+#   @param: index - node to run
+#   @param: background - 1 if followed by &
+#   @return: void
+******************************************************/
+static void sh_ast_node_run(struct Shell *this_shell, const struct Ast *ast, int index, int background)
+{
+    const struct AstNode *node = &ast->nodes[index];
+
+    switch (node->kind) {
+    case AST_COMMAND:
+        if (sh_ast_expand(this_shell, ast, node->first, node->count) == -1) {
+            fprintf(stdout, "simple_shell: out of memory\n");
+            fflush(stdout);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            return;
+        }
+        this_shell->ground = background;
+        this_shell->job_ast = ast;
+        this_shell->job_node = index;
+        sh_command_ground(this_shell);
+        sh_identify_command(this_shell);
+        return;
+    case AST_BACKGROUND:
+        sh_ast_node_run(this_shell, ast, node->left, 1);
+        return;
+    case AST_SUBSHELL:
+        sh_ast_fork(this_shell, ast, index, background);
+        return;
+    default:
+        break;
+    }
+
+    if (background) {
+        sh_ast_fork(this_shell, ast, index, 1);
+        return;
+    }
+
+    switch (node->kind) {
+    case AST_SEQUENCE:
+        sh_ast_run(this_shell, ast, index);
+        break;
+    case AST_AND:
+    case AST_OR:
+        sh_ast_node_run(this_shell, ast, node->left, 0);
+        /*&& goes on after success, || after failure*/
+        if (!sh_ast_interrupted(this_shell)
+                && (this_shell->status == 0 && !this_shell->signaled) == (node->kind == AST_AND)) {
+            sh_ast_node_run(this_shell, ast, node->right, 0);
+        }
+        break;
+    case AST_GROUP:
+        sh_ast_group(this_shell, ast, node);
+        break;
+    }
+}
+
+/******************************************************
+#   sh_ast_run
+#   @desc: runs a compiled list: each item of the
+#       AST_SEQUENCE chain starting at node in turn. A
+#       command killed by CTRL-C abandons the rest.
+#   @param: pointer to shell object
+#   @param: ast - compiled line
+#   @param: node - first link of the list, -1 for none
+#   @return: void
+******************************************************/
+void sh_ast_run(struct Shell *this_shell, const struct Ast *ast, int node)
+{
+    for (; node != -1; node = ast->nodes[node].right) {
+        sh_ast_node_run(this_shell, ast, ast->nodes[node].left, 0);
+        if (sh_ast_interrupted(this_shell)) {
+            break;
+        }
+    }
+}
@@ -0,0 +1,190 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_builtin.c
+#   Description: Builtin command table. Builtins are
+#       registered once in sh_builtins with their handler
+#       and flags. A perfect hash over the names is found
+#       at startup, so telling a builtin from a program is
+#       one hash and one exact compare per command.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/*Registered builtins; add new ones here*/
+static const struct Builtin sh_builtins[] = {
+    { "cd",       sh_change_directory, BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "exit",     exitShell,           BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "status",   sh_command_status,   BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "hash",     sh_hash_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "parallel", sh_parallel_command, BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "time",     sh_time_command,     BUILTIN_IN_PROCESS | BUILTIN_PREFIX },
+    { "limit",    sh_limit_command,    BUILTIN_IN_PROCESS | BUILTIN_PREFIX },
+    { "timeout",  sh_timeout_command,  BUILTIN_IN_PROCESS | BUILTIN_PREFIX },
+    { "retry",    sh_retry_command,    BUILTIN_IN_PROCESS | BUILTIN_PREFIX },
+    { "memo",     sh_memo_command,     BUILTIN_IN_PROCESS | BUILTIN_PREFIX },
+    { "echo",     sh_echo_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "printf",   sh_printf_command,   BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "test",     sh_test_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "[",        sh_test_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "true",     sh_true_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "false",    sh_false_command,    BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "pwd",      sh_pwd_command,      BUILTIN_IN_PROCESS | BUILTIN_REDIRECT | BUILTIN_PROGRAM },
+    { "read",     sh_read_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "history",  sh_history_command,  BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "export",   sh_export_command,   BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "unset",    sh_unset_command,    BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "jobs",     sh_jobs_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "fg",       sh_fg_command,       BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "bg",       sh_bg_command,       BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "wait",     sh_wait_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "kill",     sh_kill_command,     BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { "source",   sh_source_command,   BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+    { ".",        sh_source_command,   BUILTIN_IN_PROCESS | BUILTIN_REDIRECT },
+};
+
+#define BUILTIN_COUNT (int)(sizeof(sh_builtins) / sizeof(sh_builtins[0]))
+
+/*Slot -> index into sh_builtins, -1 if empty*/
+static signed char sh_builtin_slots[BUILTIN_SLOTS];
+static unsigned int sh_builtin_seed;
+
+/******************************************************
+#   sh_builtin_hash
+#   @desc: seeded FNV-1a hash of a name
+#   @param: name - command name
+#   @param: seed - varies the hash until it is perfect
+#   @return: slot in sh_builtin_slots
+******************************************************/
+static unsigned int sh_builtin_hash(const char *name, unsigned int seed)
+{
+    unsigned int hash = 2166136261u ^ seed;
+
+    while (*name != '\0') {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+
+    return (hash ^ (hash >> 16)) & (BUILTIN_SLOTS - 1);
+}
+
+/******************************************************
+#   sh_builtin_init
+#   @desc: tries seeds until every builtin name hashes
+#       to its own slot. The table is small and sparse,
+#       so this takes a handful of tries.
+#   @param: n/a
+#   @return: 0 on success, -1 if no seed was found
+******************************************************/
+int sh_builtin_init()
+{
+    unsigned int seed;
+    int i;
+
+    for (seed = 0; seed < 65536; seed++) {
+        memset(sh_builtin_slots, -1, sizeof(sh_builtin_slots));
+
+        for (i = 0; i < BUILTIN_COUNT; i++) {
+            unsigned int slot = sh_builtin_hash(sh_builtins[i].name, seed);
+            if (sh_builtin_slots[slot] != -1) {
+                break;
+            }
+            sh_builtin_slots[slot] = i;
+        }
+
+        if (i == BUILTIN_COUNT) {
+            sh_builtin_seed = seed;
+            return 0;
+        }
+    }
+
+    memset(sh_builtin_slots, -1, sizeof(sh_builtin_slots));
+    return -1;
+}
+
+/******************************************************
+#   sh_builtin_find
+#   @desc: looks up a builtin by its exact name
+#   @param: name - first word of the command
+#   @return: builtin entry, NULL if name is not a builtin
+******************************************************/
+const struct Builtin* sh_builtin_find(const char *name)
+{
+    int index = sh_builtin_slots[sh_builtin_hash(name, sh_builtin_seed)];
+
+    if (index == -1 || strcmp(sh_builtins[index].name, name) != 0) {
+        return NULL;
+    }
+    return &sh_builtins[index];
+}
+
+/******************************************************
+#   sh_builtin_name
+#   @desc: walks the builtin names, for completion
+#   @param: i - index from 0
+#   @return: name, NULL past the last builtin
+******************************************************/
+const char* sh_builtin_name(int i)
+{
+    return (i >= 0 && i < BUILTIN_COUNT) ? sh_builtins[i].name : NULL;
+}
+
+/******************************************************
+#   sh_builtin_run
+#   @desc: runs a builtin. For one that takes redirection
+#       the shell's own descriptors are pointed at the
+#       command's redirections for the duration and then
+#       put back, so no child is needed. With a trailing &
+#       the program of the same name runs as a background
+#       job instead; a builtin that only makes sense in the
+#       shell itself is refused.
+#   @param: pointer to shell object
+#   @param: builtin - entry from sh_builtin_find
+#   @return: void
+******************************************************/
+void sh_builtin_run(struct Shell *this_shell, const struct Builtin *builtin)
+{
+    /*source runs other commands, which replace this_shell->redirects*/
+    struct Redirect *redirects = this_shell->redirects;
+    int count = this_shell->redirect_count;
+    int saved[REDIRECT_FDS];
+
+    /*Backgrounded: a job needs a process of its own*/
+    if (this_shell->ground && (builtin->flags & BUILTIN_PREFIX) == 0) {
+        if (builtin->flags & BUILTIN_PROGRAM) {
+            sh_other_command(this_shell);
+            return;
+        }
+        fprintf(stdout, "%s: cannot run in the background\n", builtin->name);
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*Its usage is the shell's own: status -v has none to show.
+      Prefixes run a command that records its own, status reports
+      on the one before it.*/
+    if ((builtin->flags & BUILTIN_PREFIX) == 0 && builtin->handler != sh_command_status) {
+        this_shell->usage.builtin = builtin->name;
+    }
+
+    if ((builtin->flags & BUILTIN_REDIRECT) == 0 || count == 0) {
+        builtin->handler(this_shell);
+        return;
+    }
+
+    if (sh_redirect_open(redirects, count) == -1) {
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    sh_redirect_push(redirects, count, saved);
+    builtin->handler(this_shell);
+    sh_redirect_pop(saved);
+
+    sh_redirect_close(redirects, count);
+}
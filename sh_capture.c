@@ -0,0 +1,507 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_capture.c
+#   Description: Output capture for background jobs.
+#       With $SIMPLE_SHELL_CAPTURE set to a size in KB,
+#       a background job's stdout and stderr go into a
+#       pipe the shell drains from its event loop into a
+#       ring buffer of that size, so only the last of the
+#       output is kept. All rings together stay within
+#       CAPTURE_BUDGET; finished jobs' output is dropped
+#       oldest first to make room. jobs -o shows it.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include <sys/epoll.h>
+#include <sys/uio.h>
+
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_captures_init
+#   @desc: sets up an empty capture list. The epoll set
+#       is made when the first job is captured.
+#   @param: list - capture list
+#   @return: void
+******************************************************/
+void sh_captures_init(struct CaptureList *list)
+{
+    list->oldest = NULL;
+    list->newest = NULL;
+    list->pending = NULL;
+    list->used = 0;
+    list->open = 0;
+    list->epoll_fd = -1;
+    list->watch = NULL;
+    list->saved[0] = -1;
+    list->saved[1] = -1;
+    list->disabled = 0;
+}
+
+/******************************************************
+#   sh_capture_close
+#   @desc: stops reading a job's pipe
+#   @param: list - capture list
+#   @param: capture - the job's capture
+#   @return: void
+******************************************************/
+static void sh_capture_close(struct CaptureList *list, struct Capture *capture)
+{
+    if (capture->fd == -1) {
+        return;
+    }
+    epoll_ctl(list->epoll_fd, EPOLL_CTL_DEL, capture->fd, NULL);
+    close(capture->fd);
+    capture->fd = -1;
+    list->open--;
+}
+
+/******************************************************
+#   sh_capture_destroy
+#   @desc: closes a capture and gives its ring back to
+#       the budget. It must already be off the list.
+#   @param: list - capture list
+#   @param: capture - the capture
+#   @return: void
+******************************************************/
+static void sh_capture_destroy(struct CaptureList *list, struct Capture *capture)
+{
+    sh_capture_close(list, capture);
+    list->used -= capture->size;
+    free(capture->ring);
+    free(capture->command);
+    free(capture);
+}
+
+/******************************************************
+#   sh_captures_free
+#   @desc: drops all captured output
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_captures_free(struct Shell *this_shell)
+{
+    struct CaptureList *list = &this_shell->captures;
+    struct Capture *capture = list->oldest;
+
+    while (capture != NULL) {
+        struct Capture *next = capture->next;
+        sh_capture_destroy(list, capture);
+        capture = next;
+    }
+    if (list->pending != NULL) {
+        sh_capture_destroy(list, list->pending);
+    }
+    if (list->epoll_fd != -1) {
+        sh_loop_unwatch(this_shell, list->watch);
+        close(list->epoll_fd);
+    }
+    sh_captures_init(list);
+}
+
+/******************************************************
+#   sh_captures_child
+#   @desc: in a forked subshell: its output is already
+#       where it should be, and the pipes are the
+#       parent's to read, so it never captures
+#   @param: list - capture list
+#   @return: void
+******************************************************/
+void sh_captures_child(struct CaptureList *list)
+{
+    int i;
+
+    for (i = 0; i < 2; i++) {
+        if (list->saved[i] >= 0) {
+            close(list->saved[i]);
+        }
+        list->saved[i] = -1;
+    }
+    if (list->epoll_fd != -1) {
+        close(list->epoll_fd);
+    }
+    list->epoll_fd = -1;
+    list->pending = NULL;
+    list->open = 0;
+    list->disabled = 1;
+}
+
+/******************************************************
+#   sh_capture_drain
+#   @desc: reads what the job has written straight into
+#       its ring, overwriting the oldest output, until
+#       the pipe is empty. Never blocks.
+#   @param: list - capture list
+#   @param: capture - the job's capture
+#   @return: void
+******************************************************/
+static void sh_capture_drain(struct CaptureList *list, struct Capture *capture)
+{
+    struct iovec parts[2];
+    ssize_t got;
+
+    while (capture->fd != -1) {
+        size_t at = capture->total % capture->size;
+
+        /*From the write position to the end, then around*/
+        parts[0].iov_base = capture->ring + at;
+        parts[0].iov_len = capture->size - at;
+        parts[1].iov_base = capture->ring;
+        parts[1].iov_len = at;
+        got = readv(capture->fd, parts, at == 0 ? 1 : 2);
+
+        if (got > 0) {
+            if (capture->echo) {
+                size_t first = (size_t)got < parts[0].iov_len ? (size_t)got : parts[0].iov_len;
+                fwrite(parts[0].iov_base, 1, first, stdout);
+                fwrite(capture->ring, 1, got - first, stdout);
+                fflush(stdout);
+            }
+            capture->total += got;
+            continue;
+        }
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got == -1 && errno == EAGAIN) {
+            return;
+        }
+
+        /*End of output: the job and anything it started closed the pipe*/
+        sh_capture_close(list, capture);
+    }
+}
+
+/******************************************************
+#   sh_capture_on_ready
+#   @desc: the capture epoll set is readable: drain the
+#       pipes that have output
+#   @param: pointer to shell object
+#   @param: fd - the capture epoll set
+#   @param: data - unused
+#   @return: void
+******************************************************/
+static void sh_capture_on_ready(struct Shell *this_shell, int fd, void *data)
+{
+    struct epoll_event events[LOOP_MAX_EVENTS];
+    int ready;
+    int i;
+
+    (void)data;
+    ready = epoll_wait(fd, events, LOOP_MAX_EVENTS, 0);
+    for (i = 0; i < ready; i++) {
+        sh_capture_drain(&this_shell->captures, events[i].data.ptr);
+    }
+}
+
+/******************************************************
+#   sh_capture_ready
+#   @desc: drains the pipes that have output, for waits
+#       outside the event loop
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_capture_ready(struct Shell *this_shell)
+{
+    sh_capture_on_ready(this_shell, this_shell->captures.epoll_fd, NULL);
+}
+
+/******************************************************
+#   sh_capture_evict
+#   @desc: drops the output of the oldest finished job
+#   @param: list - capture list
+#   @return: 0 if one was dropped, -1 if none finished
+******************************************************/
+static int sh_capture_evict(struct CaptureList *list)
+{
+    struct Capture *prev = NULL;
+    struct Capture *capture;
+
+    for (capture = list->oldest; capture != NULL; prev = capture, capture = capture->next) {
+        if (!capture->done) {
+            continue;
+        }
+        if (prev != NULL) {
+            prev->next = capture->next;
+        }
+        else {
+            list->oldest = capture->next;
+        }
+        if (list->newest == capture) {
+            list->newest = prev;
+        }
+        sh_capture_destroy(list, capture);
+        return 0;
+    }
+    return -1;
+}
+
+/******************************************************
+#   sh_capture_begin
+#   @desc: for a background job about to start: makes
+#       its ring and pipe and points the shell's stdout
+#       and stderr at the pipe, so the job inherits them
+#       unless it redirects them itself. Running jobs
+#       keep their rings; if they fill the budget the job
+#       writes to the terminal as usual.
+#   @param: pointer to shell object
+#   @return: 1 if the job's output is captured, else 0
+******************************************************/
+int sh_capture_begin(struct Shell *this_shell)
+{
+    struct CaptureList *list = &this_shell->captures;
+    const char *text = sh_env_get(&this_shell->env, "SIMPLE_SHELL_CAPTURE");
+    struct Capture *capture;
+    struct epoll_event event;
+    int pipe_fds[2];
+    long kb;
+    size_t size;
+
+    if (list->disabled || text == NULL || (kb = strtol(text, NULL, 10)) <= 0) {
+        return 0;
+    }
+    size = kb > CAPTURE_BUDGET / 1024 ? CAPTURE_BUDGET : (size_t)kb * 1024;
+    if (size < CAPTURE_MIN) {
+        size = CAPTURE_MIN;
+    }
+
+    /*A job that never started holds nothing*/
+    if (list->pending != NULL) {
+        sh_capture_destroy(list, list->pending);
+        list->pending = NULL;
+    }
+
+    /*Make room from the oldest finished jobs*/
+    while (list->used + size > CAPTURE_BUDGET && sh_capture_evict(list) == 0) {
+    }
+    if (list->used + size > CAPTURE_BUDGET) {
+        return 0;
+    }
+
+    if (list->epoll_fd == -1) {
+        list->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (list->epoll_fd == -1) {
+            return 0;
+        }
+        list->watch = sh_loop_watch(this_shell, list->epoll_fd, sh_capture_on_ready, NULL);
+    }
+
+    capture = malloc(sizeof(struct Capture));
+    if (capture == NULL) {
+        return 0;
+    }
+    capture->ring = malloc(size);
+    if (capture->ring == NULL || pipe2(pipe_fds, O_CLOEXEC) == -1) {
+        free(capture->ring);
+        free(capture);
+        return 0;
+    }
+
+    /*A bigger pipe lets it run on while the shell waits for something else*/
+    fcntl(pipe_fds[0], F_SETPIPE_SZ, (int)size);
+    fcntl(pipe_fds[0], F_SETFL, O_NONBLOCK);
+    event.events = EPOLLIN;
+    event.data.ptr = capture;
+    if (epoll_ctl(list->epoll_fd, EPOLL_CTL_ADD, pipe_fds[0], &event) == -1) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        free(capture->ring);
+        free(capture);
+        return 0;
+    }
+
+    capture->id = 0;
+    capture->pid = 0;
+    capture->command = NULL;
+    capture->size = size;
+    capture->total = 0;
+    capture->fd = pipe_fds[0];
+    capture->done = 0;
+    capture->echo = 0;
+    capture->next = NULL;
+    list->used += size;
+    list->open++;
+    list->pending = capture;
+
+    /*The shell's own output goes back in sh_capture_end*/
+    fflush(stdout);
+    fflush(stderr);
+    list->saved[0] = fcntl(1, F_DUPFD_CLOEXEC, REDIRECT_FDS);
+    list->saved[1] = fcntl(2, F_DUPFD_CLOEXEC, REDIRECT_FDS);
+    dup2(pipe_fds[1], 1);
+    dup2(pipe_fds[1], 2);
+    close(pipe_fds[1]);
+
+    return 1;
+}
+
+/******************************************************
+#   sh_capture_write
+#   @desc: writes the last lines of a capture to stdout
+#   @param: capture - the capture
+#   @param: lines - lines from the end, 0 for all kept
+#   @return: void
+******************************************************/
+static void sh_capture_write(const struct Capture *capture, long lines)
+{
+    size_t kept = capture->total < capture->size ? (size_t)capture->total : capture->size;
+    size_t start = capture->total <= capture->size ? 0 : (size_t)(capture->total % capture->size);
+    size_t from = 0;
+    size_t at;
+    size_t length;
+    size_t first;
+
+    if (lines > 0) {
+        size_t k = kept;
+
+        /*A final newline ends the last line, it doesn't start one*/
+        if (k > 0 && capture->ring[(start + k - 1) % capture->size] == '\n') {
+            k--;
+        }
+        while (k > 0) {
+            if (capture->ring[(start + k - 1) % capture->size] == '\n' && --lines == 0) {
+                break;
+            }
+            k--;
+        }
+        from = k;
+    }
+    else if (capture->total > capture->size) {
+        fprintf(stdout, "[%llu bytes dropped]\n", capture->total - capture->size);
+    }
+
+    /*Bytes from..kept of the output, in at most two pieces of the ring*/
+    at = (start + from) % capture->size;
+    length = kept - from;
+    first = capture->size - at < length ? capture->size - at : length;
+    fwrite(capture->ring + at, 1, first, stdout);
+    fwrite(capture->ring, 1, length - first, stdout);
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_capture_end
+#   @desc: puts the shell's stdout and stderr back once
+#       the job has started. If it didn't start, what it
+#       wrote (the error) is shown instead of kept.
+#   @param: pointer to shell object
+#   @param: started - 1 if the job is running
+#   @return: void
+******************************************************/
+void sh_capture_end(struct Shell *this_shell, int started)
+{
+    struct CaptureList *list = &this_shell->captures;
+    int i;
+
+    fflush(stdout);
+    fflush(stderr);
+    for (i = 0; i < 2; i++) {
+        if (list->saved[i] >= 0) {
+            dup2(list->saved[i], i + 1);
+            close(list->saved[i]);
+        }
+        else {
+            close(i + 1);
+        }
+        list->saved[i] = -1;
+    }
+
+    if (!started && list->pending != NULL) {
+        sh_capture_drain(list, list->pending);
+        sh_capture_write(list->pending, 0);
+        sh_capture_destroy(list, list->pending);
+        list->pending = NULL;
+    }
+}
+
+/******************************************************
+#   sh_capture_take
+#   @desc: gives the capture made by sh_capture_begin
+#       to the job just recorded for it
+#   @param: pointer to shell object
+#   @param: job - the new job
+#   @return: void
+******************************************************/
+void sh_capture_take(struct Shell *this_shell, struct Job *job)
+{
+    struct CaptureList *list = &this_shell->captures;
+    struct Capture *capture = list->pending;
+
+    job->capture = capture;
+    if (capture == NULL) {
+        return;
+    }
+    list->pending = NULL;
+
+    capture->id = job->id;
+    capture->pid = job->pid;
+    capture->command = job->command != NULL ? strdup(job->command) : NULL;
+
+    if (list->newest != NULL) {
+        list->newest->next = capture;
+    }
+    else {
+        list->oldest = capture;
+    }
+    list->newest = capture;
+}
+
+/******************************************************
+#   sh_capture_find
+#   @desc: finds the newest capture a spec names: %n by
+#       job number, %text by the start of the command, a
+#       pid, or % %% %+ and NULL for the newest
+#   @param: list - capture list
+#   @param: spec - job spec or pid
+#   @return: the capture, NULL if none matches
+******************************************************/
+static struct Capture* sh_capture_find(struct CaptureList *list, const char *spec)
+{
+    struct Capture *found = NULL;
+    struct Capture *capture;
+    char *end;
+    long number;
+
+    if (spec == NULL || strcmp(spec, "%") == 0 || strcmp(spec, "%%") == 0 || strcmp(spec, "%+") == 0) {
+        return list->newest;
+    }
+
+    number = strtol(spec[0] == '%' ? spec + 1 : spec, &end, 10);
+    for (capture = list->oldest; capture != NULL; capture = capture->next) {
+        if (*end == '\0' && end != spec + (spec[0] == '%')) {
+            if ((spec[0] == '%' && capture->id == number) || (spec[0] != '%' && capture->pid == number)) {
+                found = capture;
+            }
+        }
+        else if (spec[0] == '%' && capture->command != NULL
+                && strncmp(capture->command, spec + 1, strlen(spec + 1)) == 0) {
+            found = capture;
+        }
+    }
+    return found;
+}
+
+/******************************************************
+#   sh_capture_show
+#   @desc: writes a job's captured output to stdout, all
+#       that is kept or the last lines, whether or not
+#       the job has finished
+#   @param: pointer to shell object
+#   @param: spec - job spec or pid, NULL for the newest
+#   @param: lines - lines from the end, 0 for all
+#   @return: 0 on success, -1 if nothing was captured
+******************************************************/
+int sh_capture_show(struct Shell *this_shell, const char *spec, long lines)
+{
+    struct Capture *capture = sh_capture_find(&this_shell->captures, spec);
+
+    if (capture == NULL) {
+        return -1;
+    }
+    sh_capture_drain(&this_shell->captures, capture);
+    sh_capture_write(capture, lines);
+    return 0;
+}
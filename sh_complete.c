@@ -0,0 +1,721 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_complete.c
+#   Description: Tab completion. Command names come from
+#       a trie of every executable in PATH plus the
+#       builtins. Each PATH directory remembers its mtime
+#       and the names it contributed, so a completion only
+#       rescans directories that changed since the last
+#       one. File names come from the directory listing
+#       cache, where matches are a binary searched range.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/*Characters escaped with a backslash when inserted*/
+static const char sh_complete_special[] = " \t\n\\'\"|&;<>()$`*?[]{}!#";
+
+/******************************************************
+#   sh_complete_node
+#   @desc: allocates an empty trie node
+#   @param: completer - completion state
+#   @return: node index, -1 if out of memory
+******************************************************/
+static int sh_complete_node(struct Completer *completer)
+{
+    struct TrieNode *node;
+
+    if (completer->node_count == completer->node_cap) {
+        int new_cap = completer->node_cap ? completer->node_cap * 2 : 1024;
+        struct TrieNode *nodes = realloc(completer->nodes, new_cap * sizeof(struct TrieNode));
+        if (nodes == NULL) {
+            return -1;
+        }
+        completer->nodes = nodes;
+        completer->node_cap = new_cap;
+    }
+
+    node = &completer->nodes[completer->node_count];
+    node->child = -1;
+    node->next = -1;
+    node->below = 0;
+    node->refs = 0;
+    node->c = '\0';
+    return completer->node_count++;
+}
+
+/******************************************************
+#   sh_complete_child
+#   @desc: finds (or adds) the child of node reached by
+#       ch. Children are kept in character order so the
+#       candidates come out sorted.
+#   @param: completer - completion state
+#   @param: node - parent node
+#   @param: ch - character
+#   @param: create - 1 adds a missing child
+#   @return: child index, -1 if missing
+******************************************************/
+static int sh_complete_child(struct Completer *completer, int node, char ch, int create)
+{
+    int prev = -1;
+    int cur = completer->nodes[node].child;
+    int fresh;
+
+    while (cur != -1 && (unsigned char)completer->nodes[cur].c < (unsigned char)ch) {
+        prev = cur;
+        cur = completer->nodes[cur].next;
+    }
+    if (cur != -1 && completer->nodes[cur].c == ch) {
+        return cur;
+    }
+    if (!create) {
+        return -1;
+    }
+
+    /*nodes may move: link by index afterwards*/
+    fresh = sh_complete_node(completer);
+    if (fresh == -1) {
+        return -1;
+    }
+    completer->nodes[fresh].c = ch;
+    completer->nodes[fresh].next = cur;
+    if (prev == -1) {
+        completer->nodes[node].child = fresh;
+    }
+    else {
+        completer->nodes[prev].next = fresh;
+    }
+    return fresh;
+}
+
+/******************************************************
+#   sh_complete_insert
+#   @desc: adds one provider of name to the trie
+#   @param: completer - completion state
+#   @param: name - command name
+#   @return: void
+******************************************************/
+static void sh_complete_insert(struct Completer *completer, const char *name)
+{
+    int path[NAME_MAX + 2];
+    int depth = 0;
+    int node = 0;
+    int i;
+
+    path[depth++] = node;
+    for (; *name != '\0' && depth <= NAME_MAX; name++) {
+        node = sh_complete_child(completer, node, *name, 1);
+        if (node == -1) {
+            return;
+        }
+        path[depth++] = node;
+    }
+
+    /*A name counts once however many dirs have it*/
+    if (completer->nodes[node].refs++ == 0) {
+        for (i = 0; i < depth; i++) {
+            completer->nodes[path[i]].below++;
+        }
+    }
+}
+
+/******************************************************
+#   sh_complete_remove
+#   @desc: drops one provider of name from the trie.
+#       Emptied nodes stay but are skipped by below == 0.
+#   @param: completer - completion state
+#   @param: name - command name
+#   @return: void
+******************************************************/
+static void sh_complete_remove(struct Completer *completer, const char *name)
+{
+    int path[NAME_MAX + 2];
+    int depth = 0;
+    int node = 0;
+    int i;
+
+    path[depth++] = node;
+    for (; *name != '\0' && depth <= NAME_MAX; name++) {
+        node = sh_complete_child(completer, node, *name, 0);
+        if (node == -1) {
+            return;
+        }
+        path[depth++] = node;
+    }
+
+    if (completer->nodes[node].refs > 0 && --completer->nodes[node].refs == 0) {
+        for (i = 0; i < depth; i++) {
+            completer->nodes[path[i]].below--;
+        }
+    }
+}
+
+/******************************************************
+#   sh_complete_drop_dirs
+#   @desc: forgets the PATH directories
+#   @param: completer - completion state
+#   @return: void
+******************************************************/
+static void sh_complete_drop_dirs(struct Completer *completer)
+{
+    int i;
+
+    for (i = 0; i < completer->dir_count; i++) {
+        free(completer->dirs[i].path);
+        free(completer->dirs[i].names);
+    }
+    free(completer->dirs);
+    free(completer->path_env);
+    completer->dirs = NULL;
+    completer->dir_count = 0;
+    completer->path_env = NULL;
+}
+
+/******************************************************
+#   sh_complete_split_path
+#   @desc: starts a new trie holding only the builtins
+#       and makes one unscanned record per PATH entry
+#   @param: completer - completion state
+#   @param: path_env - PATH value
+#   @return: void
+******************************************************/
+static void sh_complete_split_path(struct Completer *completer, const char *path_env)
+{
+    const char *dir = path_env;
+    const char *name;
+    int count = 1;
+    int i;
+
+    sh_complete_drop_dirs(completer);
+    completer->node_count = 0;
+    sh_complete_node(completer);
+    for (i = 0; (name = sh_builtin_name(i)) != NULL; i++) {
+        sh_complete_insert(completer, name);
+    }
+
+    for (name = path_env; *name != '\0'; name++) {
+        count += (*name == ':');
+    }
+    completer->dirs = calloc(count, sizeof(struct PathDir));
+    if (completer->dirs == NULL) {
+        return;
+    }
+    completer->path_env = strdup(path_env);
+
+    while (1) {
+        const char *end = strchr(dir, ':');
+        size_t dir_len = end ? (size_t)(end - dir) : strlen(dir);
+
+        /*Empty entry means current directory*/
+        completer->dirs[completer->dir_count++].path = dir_len ? strndup(dir, dir_len) : strdup(".");
+
+        if (end == NULL) {
+            break;
+        }
+        dir = end + 1;
+    }
+}
+
+/******************************************************
+#   sh_complete_scan
+#   @desc: reads the executables of one PATH directory
+#       into the record and the trie
+#   @param: completer - completion state
+#   @param: record - PATH directory record
+#   @return: void
+******************************************************/
+static void sh_complete_scan(struct Completer *completer, struct PathDir *record)
+{
+    DIR *dir = opendir(record->path);
+    struct dirent *entry;
+    struct stat info;
+    size_t cap = 4096;
+    const char *name;
+
+    if (dir == NULL) {
+        return;
+    }
+    record->names = malloc(cap);
+    record->names_len = 0;
+
+    while (record->names != NULL && (entry = readdir(dir)) != NULL) {
+        size_t len = strlen(entry->d_name) + 1;
+
+        if (entry->d_name[0] == '.' || entry->d_type == DT_DIR) {
+            continue;
+        }
+        if (fstatat(dirfd(dir), entry->d_name, &info, 0) == -1
+                || !S_ISREG(info.st_mode) || (info.st_mode & 0111) == 0) {
+            continue;
+        }
+        if (record->names_len + len > cap) {
+            char *grown = realloc(record->names, cap * 2);
+            if (grown == NULL) {
+                break;
+            }
+            record->names = grown;
+            cap *= 2;
+        }
+        memcpy(record->names + record->names_len, entry->d_name, len);
+        record->names_len += len;
+    }
+    closedir(dir);
+
+    for (name = record->names; name != NULL && name < record->names + record->names_len;
+            name += strlen(name) + 1) {
+        sh_complete_insert(completer, name);
+    }
+}
+
+/******************************************************
+#   sh_complete_sync
+#   @desc: brings the trie up to date. The whole trie is
+#       rebuilt when PATH changes; otherwise only the
+#       directories whose mtime moved are rescanned.
+#   @param: completer - completion state
+#   @return: void
+******************************************************/
+static void sh_complete_sync(struct Completer *completer)
+{
+    const char *path_env = sh_env_get(completer->env, "PATH");
+    struct stat info;
+    int i;
+
+    if (path_env == NULL) {
+        path_env = DEFAULT_PATH;
+    }
+    if (completer->path_env == NULL || strcmp(completer->path_env, path_env) != 0) {
+        sh_complete_split_path(completer, path_env);
+    }
+
+    for (i = 0; i < completer->dir_count; i++) {
+        struct PathDir *record = &completer->dirs[i];
+        int found = (stat(record->path, &info) == 0);
+
+        if (found && record->names != NULL
+                && record->mtime.tv_sec == info.st_mtim.tv_sec
+                && record->mtime.tv_nsec == info.st_mtim.tv_nsec) {
+            continue;
+        }
+
+        /*Take out what the directory used to have*/
+        if (record->names != NULL) {
+            const char *name;
+            for (name = record->names; name < record->names + record->names_len;
+                    name += strlen(name) + 1) {
+                sh_complete_remove(completer, name);
+            }
+            free(record->names);
+            record->names = NULL;
+        }
+
+        if (found) {
+            record->mtime = info.st_mtim;
+            sh_complete_scan(completer, record);
+        }
+    }
+}
+
+/******************************************************
+#   sh_complete_add_match
+#   @desc: records a candidate for listing
+#   @param: completer - completion state
+#   @param: name - candidate
+#   @param: len - length of name
+#   @param: suffix - '/' for directories, 0 for none
+#   @return: void
+******************************************************/
+static void sh_complete_add_match(struct Completer *completer, const char *name, size_t len, char suffix)
+{
+    size_t need = len + 2;
+
+    if (completer->match_count >= COMPLETE_SHOW) {
+        return;
+    }
+    if (completer->matches_len + need > completer->matches_cap) {
+        size_t new_cap = completer->matches_cap ? completer->matches_cap * 2 : 4096;
+        char *grown;
+        while (completer->matches_len + need > new_cap) {
+            new_cap *= 2;
+        }
+        grown = realloc(completer->matches, new_cap);
+        if (grown == NULL) {
+            return;
+        }
+        completer->matches = grown;
+        completer->matches_cap = new_cap;
+    }
+
+    memcpy(completer->matches + completer->matches_len, name, len);
+    completer->matches_len += len;
+    if (suffix != '\0') {
+        completer->matches[completer->matches_len++] = suffix;
+    }
+    completer->matches[completer->matches_len++] = '\0';
+    completer->match_count++;
+}
+
+/******************************************************
+#   sh_complete_collect
+#   @desc: lists the names below a trie node in order
+#   @param: completer - completion state
+#   @param: node - trie node
+#   @param: buf - name so far
+#   @param: depth - length of name so far
+#   @return: void
+******************************************************/
+static void sh_complete_collect(struct Completer *completer, int node, char *buf, size_t depth)
+{
+    int child;
+
+    if (completer->nodes[node].refs > 0) {
+        sh_complete_add_match(completer, buf, depth, '\0');
+    }
+    if (depth >= PATH_MAX - 1) {
+        return;
+    }
+    for (child = completer->nodes[node].child; child != -1
+            && completer->match_count < COMPLETE_SHOW; child = completer->nodes[child].next) {
+        if (completer->nodes[child].below > 0) {
+            buf[depth] = completer->nodes[child].c;
+            sh_complete_collect(completer, child, buf, depth + 1);
+        }
+    }
+}
+
+/******************************************************
+#   sh_complete_command
+#   @desc: completes a command name from the trie
+#   @param: completer - completion state
+#   @param: prefix - typed part of the name
+#   @param: common - receives the longest common name
+#   @return: number of matching names
+******************************************************/
+static size_t sh_complete_command(struct Completer *completer, const char *prefix, char *common)
+{
+    size_t len = strlen(prefix);
+    int node = 0;
+    size_t i;
+
+    sh_complete_sync(completer);
+    if (completer->nodes == NULL) {
+        return 0;
+    }
+
+    for (i = 0; i < len && node != -1; i++) {
+        node = sh_complete_child(completer, node, prefix[i], 0);
+    }
+    if (node == -1 || completer->nodes[node].below == 0) {
+        return 0;
+    }
+
+    /*Follow the trie while there is only one way down*/
+    memcpy(common, prefix, len);
+    while (completer->nodes[node].refs == 0 && len < PATH_MAX - 1) {
+        int only = -1;
+        int child;
+        for (child = completer->nodes[node].child; child != -1; child = completer->nodes[child].next) {
+            if (completer->nodes[child].below > 0) {
+                if (only != -1) {
+                    only = -2;
+                    break;
+                }
+                only = child;
+            }
+        }
+        if (only < 0) {
+            break;
+        }
+        common[len++] = completer->nodes[only].c;
+        node = only;
+    }
+    common[len] = '\0';
+
+    if (completer->nodes[node].below > 1) {
+        sh_complete_collect(completer, node, common, len);
+        common[len] = '\0';
+    }
+    return completer->nodes[node].below;
+}
+
+/******************************************************
+#   sh_complete_is_dir
+#   @desc: tells whether a listed name is a directory,
+#       following symlinks when the type says link
+#   @param: dir - directory listed
+#   @param: name - name from its listing
+#   @return: 1 if a directory, 0 otherwise
+******************************************************/
+static int sh_complete_is_dir(const char *dir, const char *name)
+{
+    unsigned char type = sh_dircache_type(name);
+    char path[PATH_MAX];
+    struct stat info;
+
+    if (type == DT_DIR) {
+        return 1;
+    }
+    if (type != DT_LNK && type != DT_UNKNOWN) {
+        return 0;
+    }
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+/******************************************************
+#   sh_complete_file
+#   @desc: completes a path from the listing of its
+#       directory. Hidden names only match a prefix that
+#       starts with '.'.
+#   @param: completer - completion state
+#   @param: word - typed path
+#   @param: common - receives the longest common name
+#   @param: is_dir - receives 1 if the one match is a dir
+#   @return: number of matching names
+******************************************************/
+static size_t sh_complete_file(struct Completer *completer, const char *word, char *common, int *is_dir)
+{
+    const char *slash = strrchr(word, '/');
+    const char *base = slash ? slash + 1 : word;
+    const struct DirListing *listing;
+    char dir[PATH_MAX];
+    size_t first;
+    size_t count;
+    size_t last;
+    size_t hidden_first = 0;
+    size_t hidden = 0;
+    size_t len;
+    size_t i;
+
+    /*Directory part, with ~ expanded*/
+    if (slash == NULL) {
+        strcpy(dir, ".");
+    }
+    else if (word[0] == '~' && word + 1 == slash && sh_env_get(completer->env, "HOME") != NULL) {
+        snprintf(dir, sizeof(dir), "%s/", sh_env_get(completer->env, "HOME"));
+    }
+    else {
+        snprintf(dir, sizeof(dir), "%.*s", (int)(slash - word + 1), word);
+    }
+
+    listing = sh_dircache_get(completer->listings, dir);
+    if (listing == NULL) {
+        return 0;
+    }
+    count = sh_dircache_prefix(listing, base, &first);
+
+    /*Names starting with '.' are one block of the sorted listing*/
+    if (base[0] == '\0') {
+        hidden = sh_dircache_prefix(listing, ".", &hidden_first);
+    }
+    count -= hidden;
+    if (count == 0) {
+        return 0;
+    }
+    if (hidden > 0 && hidden_first == first) {
+        first += hidden;
+    }
+    last = first + count - 1;
+    if (hidden > 0 && last >= hidden_first && first < hidden_first) {
+        last += hidden;
+    }
+
+    /*Names in order: the first and last share the common part*/
+    for (len = 0; len < PATH_MAX - 1 && listing->names[first][len] != '\0'
+            && listing->names[first][len] == listing->names[last][len]; len++) {
+        common[len] = listing->names[first][len];
+    }
+    common[len] = '\0';
+
+    if (count == 1) {
+        *is_dir = sh_complete_is_dir(dir, listing->names[first]);
+        return 1;
+    }
+
+    for (i = first; i <= last && completer->match_count < COMPLETE_SHOW; i++) {
+        const char *name = listing->names[i];
+        if (hidden > 0 && i >= hidden_first && i < hidden_first + hidden) {
+            continue;
+        }
+        sh_complete_add_match(completer, name, strlen(name),
+                sh_complete_is_dir(dir, name) ? '/' : '\0');
+    }
+    return count;
+}
+
+/******************************************************
+#   sh_complete_word
+#   @desc: finds the word ending at the cursor, with its
+#       quotes and escapes removed, and whether it is in
+#       command position
+#   @param: line - line being edited
+#   @param: cursor - cursor offset
+#   @param: word - receives the word
+#   @param: command - receives 1 for a command name
+#   @param: quote - receives the quote left open, or 0
+#   @return: 0 on success, -1 if the word is too long
+******************************************************/
+static int sh_complete_word(const char *line, size_t cursor, char *word, int *command, char *quote)
+{
+    size_t len = 0;
+    int expect_command = 1;
+    size_t i;
+
+    *quote = '\0';
+    for (i = 0; i < cursor; i++) {
+        char c = line[i];
+
+        if (*quote != '\0') {
+            if (c == *quote) {
+                *quote = '\0';
+                continue;
+            }
+        }
+        else if (c == '\'' || c == '"') {
+            *quote = c;
+            continue;
+        }
+        else if (c == '\\' && i + 1 < cursor) {
+            c = line[++i];
+        }
+        else if (c == ' ' || c == '\t') {
+            if (len > 0) {
+                expect_command = 0;
+            }
+            len = 0;
+            continue;
+        }
+        else if (strchr("|&;()", c) != NULL) {
+            expect_command = 1;
+            len = 0;
+            continue;
+        }
+        else if (c == '<' || c == '>') {
+            /*A redirection target is a file*/
+            expect_command = 0;
+            len = 0;
+            continue;
+        }
+
+        if (len >= PATH_MAX - 1) {
+            return -1;
+        }
+        word[len++] = c;
+    }
+    word[len] = '\0';
+    *command = expect_command;
+
+    return 0;
+}
+
+/******************************************************
+#   sh_complete_init
+#   @desc: sets up empty completion state. The trie is
+#       built on the first completion.
+#   @param: completer - completion state
+#   @return: void
+******************************************************/
+void sh_complete_init(struct Completer *completer)
+{
+    completer->nodes = NULL;
+    completer->node_count = 0;
+    completer->node_cap = 0;
+    completer->dirs = NULL;
+    completer->dir_count = 0;
+    completer->path_env = NULL;
+    completer->matches = NULL;
+    completer->matches_len = 0;
+    completer->matches_cap = 0;
+    completer->match_count = 0;
+    completer->env = NULL;
+    completer->listings = NULL;
+}
+
+/******************************************************
+#   sh_complete_free
+#   @desc: releases the trie
+#   @param: completer - completion state
+#   @return: void
+******************************************************/
+void sh_complete_free(struct Completer *completer)
+{
+    sh_complete_drop_dirs(completer);
+    free(completer->nodes);
+    free(completer->matches);
+    completer->nodes = NULL;
+    completer->matches = NULL;
+}
+
+/******************************************************
+#   sh_complete
+#   @desc: completes the word before the cursor. The
+#       text to insert extends the word as far as all
+#       matches agree, escaped for the tokenizer, and
+#       ends the word when only one name matches. With
+#       several matches they are left in matches.
+#   @param: completer - completion state
+#   @param: line - line being edited
+#   @param: cursor - cursor offset
+#   @param: insert - receives text to insert at cursor
+#   @param: insert_cap - size of insert
+#   @return: number of matching names
+******************************************************/
+size_t sh_complete(struct Completer *completer, const char *line, size_t cursor,
+        char *insert, size_t insert_cap)
+{
+    char word[PATH_MAX];
+    char common[PATH_MAX];
+    const char *typed;
+    int command;
+    int is_dir = 0;
+    char quote;
+    size_t count;
+    size_t out = 0;
+    const char *cur;
+
+    insert[0] = '\0';
+    completer->matches_len = 0;
+    completer->match_count = 0;
+
+    if (sh_complete_word(line, cursor, word, &command, &quote) == -1) {
+        return 0;
+    }
+
+    if (command && strchr(word, '/') == NULL) {
+        typed = word;
+        count = sh_complete_command(completer, word, common);
+    }
+    else {
+        typed = strrchr(word, '/') ? strrchr(word, '/') + 1 : word;
+        count = sh_complete_file(completer, word, common, &is_dir);
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    /*Only the part not typed yet is inserted*/
+    for (cur = common + strlen(typed); *cur != '\0' && out + 3 < insert_cap; cur++) {
+        if (quote == '\0' && strchr(sh_complete_special, *cur) != NULL) {
+            insert[out++] = '\\';
+        }
+        insert[out++] = *cur;
+    }
+
+    if (count == 1 && out + 3 < insert_cap) {
+        if (is_dir) {
+            insert[out++] = '/';
+        }
+        else {
+            if (quote != '\0') {
+                insert[out++] = quote;
+            }
+            insert[out++] = ' ';
+        }
+    }
+    insert[out] = '\0';
+
+    return count;
+}
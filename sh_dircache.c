@@ -0,0 +1,282 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_dircache.c
+#   Description: Directory listing cache. A listing is
+#       the sorted names of one directory, known by its
+#       device and inode; it is kept until the directory's
+#       mtime or ctime changes, so asking
+#       for the same directory again costs one stat, and
+#       names with a given prefix are found by binary
+#       search instead of scanning the directory. Used by
+#       completion and globbing.
+#
+******************************************************/
+#include <sys/syscall.h>
+
+#include "simple_shell.h"
+
+/*Record returned by getdents64*/
+struct DirEntry64
+{
+    uint64_t d_ino;
+    int64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+
+/******************************************************
+#   sh_dircache_compare
+#   @desc: qsort order of names in a listing
+#   @param: a, b - pointers to names
+#   @return: strcmp order
+******************************************************/
+static int sh_dircache_compare(const void *a, const void *b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/******************************************************
+#   sh_dircache_clear
+#   @desc: frees one listing
+#   @param: listing - listing to empty
+#   @return: void
+******************************************************/
+static void sh_dircache_clear(struct DirListing *listing)
+{
+    free(listing->names);
+    free(listing->pool);
+    memset(listing, 0, sizeof(*listing));
+}
+
+/******************************************************
+#   sh_dircache_read
+#   @desc: reads a directory into a listing with
+#       getdents64, a large batch of entries per call.
+#       Each name is stored in one growing pool right
+#       after its d_type byte, so the type moves with
+#       the name when the pointers are sorted; a listing
+#       costs a handful of allocations however many
+#       entries it has.
+#   @param: cache - directory cache (owns the read buffer)
+#   @param: listing - listing to fill (empty)
+#   @param: fd - open directory
+#   @return: 0 on success, -1 on failure
+******************************************************/
+static int sh_dircache_read(struct DirCache *cache, struct DirListing *listing, int fd)
+{
+    size_t pool_len = 0;
+    size_t pool_cap = 4096;
+    size_t count = 0;
+    size_t i;
+    char *cur;
+    long got;
+
+    if (cache->read_buf == NULL) {
+        cache->read_buf = malloc(DIR_READ_BUFFER);
+    }
+    listing->pool = malloc(pool_cap);
+    if (cache->read_buf == NULL || listing->pool == NULL) {
+        return -1;
+    }
+
+    while ((got = syscall(SYS_getdents64, fd, cache->read_buf, DIR_READ_BUFFER)) > 0) {
+        long offset = 0;
+
+        while (offset < got) {
+            struct DirEntry64 *entry = (struct DirEntry64*)(cache->read_buf + offset);
+            size_t len = strlen(entry->d_name) + 2;
+
+            offset += entry->d_reclen;
+            if (entry->d_name[0] == '.' && (entry->d_name[1] == '\0'
+                        || (entry->d_name[1] == '.' && entry->d_name[2] == '\0'))) {
+                continue;
+            }
+            if (pool_len + len > pool_cap) {
+                char *grown;
+                while (pool_len + len > pool_cap) {
+                    pool_cap *= 2;
+                }
+                grown = realloc(listing->pool, pool_cap);
+                if (grown == NULL) {
+                    return -1;
+                }
+                listing->pool = grown;
+            }
+            listing->pool[pool_len] = entry->d_type;
+            memcpy(listing->pool + pool_len + 1, entry->d_name, len - 1);
+            pool_len += len;
+            count++;
+        }
+    }
+    if (got < 0) {
+        return -1;
+    }
+
+    /*Pool has stopped moving: point at the names*/
+    listing->names = malloc((count + 1) * sizeof(char*));
+    if (listing->names == NULL) {
+        return -1;
+    }
+    cur = listing->pool;
+    for (i = 0; i < count; i++) {
+        listing->names[i] = cur + 1;
+        cur += strlen(cur + 1) + 2;
+    }
+    qsort(listing->names, count, sizeof(char*), sh_dircache_compare);
+    listing->count = count;
+
+    return 0;
+}
+
+/******************************************************
+#   sh_dircache_init
+#   @desc: sets up an empty cache
+#   @param: cache - directory cache
+#   @return: void
+******************************************************/
+void sh_dircache_init(struct DirCache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+/******************************************************
+#   sh_dircache_free
+#   @desc: frees every listing
+#   @param: cache - directory cache
+#   @return: void
+******************************************************/
+void sh_dircache_free(struct DirCache *cache)
+{
+    int i;
+
+    for (i = 0; i < DIR_CACHE_SIZE; i++) {
+        sh_dircache_clear(&cache->listings[i]);
+    }
+    free(cache->read_buf);
+    cache->read_buf = NULL;
+}
+
+/******************************************************
+#   sh_dircache_get
+#   @desc: returns the listing of a directory, reading it
+#       only if it is not cached or its mtime or ctime
+#       changed. Listings are matched by device and inode,
+#       not by path, so "." after a cd is another
+#       directory. The least recently used listing makes
+#       room.
+#   @param: cache - directory cache
+#   @param: path - directory
+#   @return: listing (owned by cache), NULL on failure
+******************************************************/
+const struct DirListing* sh_dircache_get(struct DirCache *cache, const char *path)
+{
+    struct DirListing *listing = NULL;
+    struct stat info;
+    int fd;
+    int i;
+
+    if (stat(path, &info) == -1 || !S_ISDIR(info.st_mode)) {
+        return NULL;
+    }
+
+    cache->tick++;
+    for (i = 0; i < DIR_CACHE_SIZE; i++) {
+        struct DirListing *entry = &cache->listings[i];
+        if (entry->names != NULL && entry->dev == info.st_dev && entry->ino == info.st_ino) {
+            listing = entry;
+            break;
+        }
+        /*Remember the oldest (or an empty) slot*/
+        if (listing == NULL || entry->used < listing->used) {
+            listing = entry;
+        }
+    }
+
+    if (listing->names != NULL && listing->dev == info.st_dev && listing->ino == info.st_ino
+            && listing->mtime.tv_sec == info.st_mtim.tv_sec
+            && listing->mtime.tv_nsec == info.st_mtim.tv_nsec
+            && listing->ctime.tv_sec == info.st_ctim.tv_sec
+            && listing->ctime.tv_nsec == info.st_ctim.tv_nsec) {
+        listing->used = cache->tick;
+        return listing;
+    }
+
+    sh_dircache_clear(listing);
+    fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd == -1) {
+        return NULL;
+    }
+    /*Times of what is read, in case it changed since the stat*/
+    if (fstat(fd, &info) == -1 || sh_dircache_read(cache, listing, fd) == -1) {
+        close(fd);
+        sh_dircache_clear(listing);
+        return NULL;
+    }
+    close(fd);
+    listing->dev = info.st_dev;
+    listing->ino = info.st_ino;
+    listing->mtime = info.st_mtim;
+    listing->ctime = info.st_ctim;
+    listing->used = cache->tick;
+
+    return listing;
+}
+
+/******************************************************
+#   sh_dircache_prefix
+#   @desc: finds the names starting with prefix. They are
+#       consecutive in the sorted listing.
+#   @param: listing - directory listing
+#   @param: prefix - start of the name
+#   @param: first - receives index of the first match
+#   @return: number of matches
+******************************************************/
+size_t sh_dircache_prefix(const struct DirListing *listing, const char *prefix, size_t *first)
+{
+    size_t prefix_len = strlen(prefix);
+    size_t low = 0;
+    size_t high = listing->count;
+    size_t end;
+
+    /*First name >= prefix*/
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (strcmp(listing->names[mid], prefix) < 0) {
+            low = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+    *first = low;
+
+    /*Matches run until a name no longer starts with it*/
+    end = low;
+    high = listing->count;
+    while (end < high) {
+        size_t mid = end + (high - end) / 2;
+        if (strncmp(listing->names[mid], prefix, prefix_len) == 0) {
+            end = mid + 1;
+        }
+        else {
+            high = mid;
+        }
+    }
+
+    return end - low;
+}
+
+/******************************************************
+#   sh_dircache_type
+#   @desc: d_type stored with a listed name
+#   @param: name - pointer from a listing's names
+#   @return: DT_* value (DT_UNKNOWN if the fs gave none)
+******************************************************/
+unsigned char sh_dircache_type(const char *name)
+{
+    return (unsigned char)name[-1];
+}
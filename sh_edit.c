@@ -0,0 +1,674 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_edit.c
+#   Description: Line editor for terminal input. While a
+#       line is typed the terminal is in raw mode and every
+#       key is handled here from the event loop: cursor
+#       movement, deletion, history recall and Tab
+#       completion. The finished line is handed to the
+#       input reader as if it had been read, and commands
+#       run with the terminal back in its normal mode.
+#
+******************************************************/
+#include <sys/ioctl.h>
+
+#include "simple_shell.h"
+
+
+#define KEY_CTRL(c) ((c) & 0x1f) /*byte sent by CTRL-c*/
+
+/******************************************************
+#   sh_edit_write
+#   @desc: writes all of buf to the terminal
+#   @param: buf - bytes to write
+#   @param: len - number of bytes
+#   @return: void
+******************************************************/
+static void sh_edit_write(const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t put = write(STDOUT_FILENO, buf, len);
+        if (put <= 0) {
+            if (put < 0 && errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        buf += put;
+        len -= put;
+    }
+}
+
+/******************************************************
+#   sh_edit_columns
+#   @desc: width of the terminal
+#   @param: n/a
+#   @return: columns, 80 if unknown
+******************************************************/
+static int sh_edit_columns()
+{
+    struct winsize size;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) == -1 || size.ws_col == 0) {
+        return 80;
+    }
+    return size.ws_col;
+}
+
+/******************************************************
+#   sh_edit_raw
+#   @desc: switches the terminal to raw mode, keeping
+#       signal keys (CTRL-C) and output processing
+#   @param: editor - line editor
+#   @return: 0 on success, -1 if not a terminal
+******************************************************/
+static int sh_edit_raw(struct LineEditor *editor)
+{
+    struct termios raw;
+
+    if (tcgetattr(STDIN_FILENO, &editor->saved) == -1) {
+        return -1;
+    }
+    raw = editor->saved;
+    raw.c_iflag &= ~(IXON | ICRNL | INLCR | IGNCR);
+    raw.c_lflag &= ~(ICANON | ECHO | IEXTEN);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    if (tcsetattr(STDIN_FILENO, TCSADRAIN, &raw) == -1) {
+        return -1;
+    }
+    editor->raw = 1;
+    return 0;
+}
+
+/******************************************************
+#   sh_edit_cooked
+#   @desc: puts back the terminal settings from before
+#       the line was edited
+#   @param: editor - line editor
+#   @return: void
+******************************************************/
+static void sh_edit_cooked(struct LineEditor *editor)
+{
+    if (editor->raw) {
+        tcsetattr(STDIN_FILENO, TCSADRAIN, &editor->saved);
+        editor->raw = 0;
+    }
+}
+
+/******************************************************
+#   sh_edit_reserve
+#   @desc: makes room for len bytes in a buffer
+#   @param: buf - buffer to grow
+#   @param: cap - size of buf
+#   @param: len - bytes needed
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_edit_reserve(char **buf, size_t *cap, size_t len)
+{
+    size_t new_cap = *cap ? *cap : EDIT_LINE;
+    char *grown;
+
+    if (len <= *cap) {
+        return 0;
+    }
+    while (new_cap < len) {
+        new_cap *= 2;
+    }
+    grown = realloc(*buf, new_cap);
+    if (grown == NULL) {
+        return -1;
+    }
+    *buf = grown;
+    *cap = new_cap;
+    return 0;
+}
+
+/******************************************************
+#   sh_edit_insert
+#   @desc: inserts text at the cursor
+#   @param: editor - line editor
+#   @param: text - bytes to insert
+#   @param: len - number of bytes
+#   @return: void
+******************************************************/
+static void sh_edit_insert(struct LineEditor *editor, const char *text, size_t len)
+{
+    if (sh_edit_reserve(&editor->buf, &editor->cap, editor->len + len + 1) == -1) {
+        return;
+    }
+    memmove(editor->buf + editor->pos + len, editor->buf + editor->pos, editor->len - editor->pos);
+    memcpy(editor->buf + editor->pos, text, len);
+    editor->len += len;
+    editor->pos += len;
+}
+
+/******************************************************
+#   sh_edit_delete
+#   @desc: removes bytes [from, to) of the line and puts
+#       the cursor at from
+#   @param: editor - line editor
+#   @param: from - first byte removed
+#   @param: to - one past the last byte removed
+#   @return: void
+******************************************************/
+static void sh_edit_delete(struct LineEditor *editor, size_t from, size_t to)
+{
+    memmove(editor->buf + from, editor->buf + to, editor->len - to);
+    editor->len -= to - from;
+    editor->pos = from;
+}
+
+/******************************************************
+#   sh_edit_set
+#   @desc: replaces the whole line, cursor at the end
+#   @param: editor - line editor
+#   @param: text - new line
+#   @param: len - its length
+#   @return: void
+******************************************************/
+static void sh_edit_set(struct LineEditor *editor, const char *text, size_t len)
+{
+    editor->len = 0;
+    editor->pos = 0;
+    sh_edit_insert(editor, text, len);
+}
+
+/******************************************************
+#   sh_edit_history
+#   @desc: steps through history (^P/^N, up/down). The
+#       line being typed is kept and comes back after
+#       the newest entry.
+#   @param: pointer to shell object
+#   @param: step - -1 older, 1 newer
+#   @return: void
+******************************************************/
+static void sh_edit_history(struct Shell *this_shell, int step)
+{
+    struct LineEditor *editor = &this_shell->editor;
+    size_t count = sh_history_count(&this_shell->history);
+    size_t at = editor->history_at;
+    const char *text;
+    size_t len;
+
+    if (step < 0) {
+        at = (at == 0) ? count : at - 1;
+        if (at == 0) {
+            return;
+        }
+    }
+    else {
+        if (at == 0) {
+            return;
+        }
+        at = (at >= count) ? 0 : at + 1;
+    }
+
+    /*Leaving the new line: keep it*/
+    if (editor->history_at == 0) {
+        size_t draft_cap = editor->draft ? editor->draft_len + 1 : 0;
+        if (sh_edit_reserve(&editor->draft, &draft_cap, editor->len + 1) == -1) {
+            return;
+        }
+        memcpy(editor->draft, editor->buf, editor->len);
+        editor->draft_len = editor->len;
+    }
+
+    if (at == 0) {
+        sh_edit_set(editor, editor->draft, editor->draft_len);
+    }
+    else {
+        text = sh_history_entry(&this_shell->history, at, &len);
+        if (text == NULL) {
+            return;
+        }
+        sh_edit_set(editor, text, len);
+    }
+    editor->history_at = at;
+}
+
+/******************************************************
+#   sh_edit_list
+#   @desc: prints completion candidates in columns below
+#       the line, then redraws the line
+#   @param: pointer to shell object
+#   @param: count - total number of matches
+#   @return: void
+******************************************************/
+static void sh_edit_list(struct Shell *this_shell, size_t count)
+{
+    struct Completer *completer = &this_shell->completer;
+    const char *name;
+    size_t widest = 0;
+    size_t per_line;
+    size_t shown = 0;
+
+    for (name = completer->matches; name < completer->matches + completer->matches_len;
+            name += strlen(name) + 1) {
+        if (strlen(name) > widest) {
+            widest = strlen(name);
+        }
+    }
+    per_line = sh_edit_columns() / (widest + 2);
+    if (per_line == 0) {
+        per_line = 1;
+    }
+
+    fprintf(stdout, "\r\n");
+    for (name = completer->matches; name < completer->matches + completer->matches_len;
+            name += strlen(name) + 1) {
+        shown++;
+        fprintf(stdout, "%-*s%s", (int)(widest + 2), name,
+                (shown % per_line == 0 || shown == completer->match_count) ? "\r\n" : "");
+    }
+    if (count > shown) {
+        fprintf(stdout, "(%zu more)\r\n", count - shown);
+    }
+    fflush(stdout);
+    sh_edit_redraw(&this_shell->editor);
+}
+
+/******************************************************
+#   sh_edit_tab
+#   @desc: completes the word before the cursor. A second
+#       Tab with nothing left to add lists the matches.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+static void sh_edit_tab(struct Shell *this_shell)
+{
+    struct LineEditor *editor = &this_shell->editor;
+    char insert[PATH_MAX];
+    size_t count;
+
+    /*Completer reads the line as a string*/
+    if (sh_edit_reserve(&editor->buf, &editor->cap, editor->len + 1) == -1) {
+        return;
+    }
+    editor->buf[editor->len] = '\0';
+
+    count = sh_complete(&this_shell->completer, editor->buf, editor->pos, insert, sizeof(insert));
+    if (insert[0] != '\0') {
+        sh_edit_insert(editor, insert, strlen(insert));
+        /*Still ambiguous: the next Tab lists*/
+        editor->tabs = (count > 1);
+        return;
+    }
+    if (count == 0 || editor->tabs++ == 0) {
+        sh_edit_write("\a", 1);
+        return;
+    }
+    sh_edit_list(this_shell, count);
+}
+
+/******************************************************
+#   sh_edit_finish
+#   @desc: Enter: ends the line and passes it on to the
+#       input reader with its newline
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+static void sh_edit_finish(struct Shell *this_shell)
+{
+    struct LineEditor *editor = &this_shell->editor;
+
+    editor->pos = editor->len;
+    sh_edit_redraw(editor);
+    sh_edit_write("\r\n", 2);
+    sh_edit_cooked(editor);
+    editor->active = 0;
+
+    sh_edit_insert(editor, "\n", 1);
+    if (sh_input_push(&this_shell->input, editor->buf, editor->len) == -1) {
+        this_shell->input.eof = 1;
+    }
+}
+
+/******************************************************
+#   sh_edit_escape
+#   @desc: handles a complete escape sequence (arrows,
+#       Home, End, Delete)
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+static void sh_edit_escape(struct Shell *this_shell)
+{
+    struct LineEditor *editor = &this_shell->editor;
+    char *seq = editor->esc + 1;
+    char key = editor->esc[editor->esc_len - 1];
+
+    /*ESC [ n ~ forms*/
+    if (seq[0] == '[' && key == '~') {
+        key = seq[1];
+    }
+
+    switch (key) {
+    case 'A':
+        sh_edit_history(this_shell, -1);
+        break;
+    case 'B':
+        sh_edit_history(this_shell, 1);
+        break;
+    case 'C':
+        if (editor->pos < editor->len) {
+            editor->pos++;
+        }
+        break;
+    case 'D':
+        if (editor->pos > 0) {
+            editor->pos--;
+        }
+        break;
+    case 'H':
+    case '1':
+    case '7':
+        editor->pos = 0;
+        break;
+    case 'F':
+    case '4':
+    case '8':
+        editor->pos = editor->len;
+        break;
+    case '3':
+        if (editor->pos < editor->len) {
+            sh_edit_delete(editor, editor->pos, editor->pos + 1);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/******************************************************
+#   sh_edit_key
+#   @desc: handles one byte typed at the terminal
+#   @param: pointer to shell object
+#   @param: c - byte read
+#   @return: void
+******************************************************/
+static void sh_edit_key(struct Shell *this_shell, unsigned char c)
+{
+    struct LineEditor *editor = &this_shell->editor;
+    size_t from;
+
+    /*Inside an escape sequence*/
+    if (editor->esc_len > 0) {
+        editor->esc[editor->esc_len++] = c;
+        if (editor->esc_len == 2 && c != '[' && c != 'O') {
+            editor->esc_len = 0;
+        }
+        else if (editor->esc_len > 2 && ((c >= 'A' && c <= 'Z') || c == '~'
+                    || editor->esc_len == (int)sizeof(editor->esc))) {
+            sh_edit_escape(this_shell);
+            editor->esc_len = 0;
+            sh_edit_redraw(editor);
+        }
+        return;
+    }
+
+    if (c != '\t') {
+        editor->tabs = 0;
+    }
+
+    switch (c) {
+    case '\r':
+    case '\n':
+        sh_edit_finish(this_shell);
+        return;
+    case 27:
+        editor->esc[0] = c;
+        editor->esc_len = 1;
+        return;
+    case '\t':
+        sh_edit_tab(this_shell);
+        break;
+    case KEY_CTRL('A'):
+        editor->pos = 0;
+        break;
+    case KEY_CTRL('E'):
+        editor->pos = editor->len;
+        break;
+    case KEY_CTRL('B'):
+        if (editor->pos > 0) {
+            editor->pos--;
+        }
+        break;
+    case KEY_CTRL('F'):
+        if (editor->pos < editor->len) {
+            editor->pos++;
+        }
+        break;
+    case KEY_CTRL('D'):
+        /*End of input on an empty line*/
+        if (editor->len == 0) {
+            sh_edit_write("\r\n", 2);
+            sh_edit_cooked(editor);
+            editor->active = 0;
+            this_shell->input.eof = 1;
+            return;
+        }
+        if (editor->pos < editor->len) {
+            sh_edit_delete(editor, editor->pos, editor->pos + 1);
+        }
+        break;
+    case KEY_CTRL('H'):
+    case 127:
+        if (editor->pos > 0) {
+            sh_edit_delete(editor, editor->pos - 1, editor->pos);
+        }
+        break;
+    case KEY_CTRL('K'):
+        editor->len = editor->pos;
+        break;
+    case KEY_CTRL('U'):
+        sh_edit_delete(editor, 0, editor->pos);
+        break;
+    case KEY_CTRL('W'):
+        /*Word before the cursor and the blanks after it*/
+        from = editor->pos;
+        while (from > 0 && editor->buf[from - 1] == ' ') {
+            from--;
+        }
+        while (from > 0 && editor->buf[from - 1] != ' ') {
+            from--;
+        }
+        sh_edit_delete(editor, from, editor->pos);
+        break;
+    case KEY_CTRL('L'):
+        sh_edit_write("\033[H\033[2J", 7);
+        break;
+    case KEY_CTRL('P'):
+        sh_edit_history(this_shell, -1);
+        break;
+    case KEY_CTRL('N'):
+        sh_edit_history(this_shell, 1);
+        break;
+    default:
+        if (c >= 32) {
+            char ch = c;
+            sh_edit_insert(editor, &ch, 1);
+        }
+        break;
+    }
+
+    sh_edit_redraw(editor);
+}
+
+/******************************************************
+#   sh_edit_init
+#   @desc: sets up an idle line editor
+#   @param: editor - line editor
+#   @return: void
+******************************************************/
+void sh_edit_init(struct LineEditor *editor)
+{
+    const char *term = getenv("TERM");
+
+    memset(editor, 0, sizeof(*editor));
+    editor->disabled = (term == NULL || strcmp(term, "dumb") == 0);
+}
+
+/******************************************************
+#   sh_edit_free
+#   @desc: restores the terminal and frees the buffers
+#   @param: editor - line editor
+#   @return: void
+******************************************************/
+void sh_edit_free(struct LineEditor *editor)
+{
+    sh_edit_cooked(editor);
+    free(editor->buf);
+    free(editor->draft);
+    editor->buf = NULL;
+    editor->draft = NULL;
+    editor->active = 0;
+}
+
+/******************************************************
+#   sh_edit_begin
+#   @desc: starts editing a new line: raw mode and prompt
+#   @param: pointer to shell object
+#   @param: prompt - shown before the line
+#   @return: 0 if editing, -1 if the terminal can't be
+#       edited on (caller prints the prompt itself)
+******************************************************/
+int sh_edit_begin(struct Shell *this_shell, const char *prompt)
+{
+    struct LineEditor *editor = &this_shell->editor;
+
+    if (editor->disabled || this_shell->loop.input_watch == NULL) {
+        return -1;
+    }
+    if (sh_edit_reserve(&editor->buf, &editor->cap, EDIT_LINE) == -1) {
+        return -1;
+    }
+    if (sh_edit_raw(editor) == -1) {
+        editor->disabled = 1;
+        return -1;
+    }
+
+    editor->active = 1;
+    editor->prompt = prompt;
+    editor->len = 0;
+    editor->pos = 0;
+    editor->scroll = 0;
+    editor->history_at = 0;
+    editor->tabs = 0;
+    editor->esc_len = 0;
+    sh_edit_redraw(editor);
+
+    return 0;
+}
+
+/******************************************************
+#   sh_edit_read
+#   @desc: terminal is readable: handles the keys typed
+#       and keeps anything after Enter for the next line
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_edit_read(struct Shell *this_shell)
+{
+    struct LineEditor *editor = &this_shell->editor;
+    unsigned char keys[256];
+    ssize_t got = read(this_shell->input.fd, keys, sizeof(keys));
+    ssize_t i;
+
+    if (got <= 0) {
+        if (got == 0 || (errno != EINTR && errno != EAGAIN)) {
+            sh_edit_cooked(editor);
+            editor->active = 0;
+            this_shell->input.eof = 1;
+        }
+        return;
+    }
+
+    for (i = 0; i < got && editor->active; i++) {
+        sh_edit_key(this_shell, keys[i]);
+    }
+
+    /*Typed ahead past Enter: goes to the next command*/
+    if (i < got && !this_shell->input.eof) {
+        sh_input_push(&this_shell->input, (char*)keys + i, got - i);
+    }
+}
+
+/******************************************************
+#   sh_edit_cancel
+#   @desc: abandons the line (CTRL-C)
+#   @param: editor - line editor
+#   @return: void
+******************************************************/
+void sh_edit_cancel(struct LineEditor *editor)
+{
+    if (!editor->active) {
+        return;
+    }
+    editor->pos = editor->len;
+    sh_edit_redraw(editor);
+    sh_edit_cooked(editor);
+    editor->active = 0;
+}
+
+/******************************************************
+#   sh_edit_hide
+#   @desc: clears the line from the screen so other
+#       output (job notices) can be printed there
+#   @param: editor - line editor
+#   @return: void
+******************************************************/
+void sh_edit_hide(struct LineEditor *editor)
+{
+    if (editor->active) {
+        sh_edit_write("\r\033[K", 4);
+    }
+}
+
+/******************************************************
+#   sh_edit_redraw
+#   @desc: draws the prompt and the part of the line
+#       around the cursor that fits the terminal
+#   @param: editor - line editor
+#   @return: void
+******************************************************/
+void sh_edit_redraw(struct LineEditor *editor)
+{
+    size_t prompt_len;
+    size_t columns;
+    size_t width;
+    size_t shown;
+    char *screen;
+    int used;
+
+    if (!editor->active) {
+        return;
+    }
+    prompt_len = strlen(editor->prompt);
+    columns = sh_edit_columns();
+    width = columns > prompt_len + 1 ? columns - prompt_len - 1 : 1;
+
+    /*Scroll so the cursor stays visible*/
+    if (editor->pos < editor->scroll) {
+        editor->scroll = editor->pos;
+    }
+    if (editor->pos >= editor->scroll + width) {
+        editor->scroll = editor->pos - width + 1;
+    }
+    shown = editor->len - editor->scroll;
+    if (shown > width) {
+        shown = width;
+    }
+
+    screen = malloc(prompt_len + shown + 32);
+    if (screen == NULL) {
+        return;
+    }
+    used = sprintf(screen, "\r%s%.*s\033[K\r", editor->prompt, (int)shown, editor->buf + editor->scroll);
+    if (prompt_len + editor->pos - editor->scroll > 0) {
+        used += sprintf(screen + used, "\033[%zuC", prompt_len + editor->pos - editor->scroll);
+    }
+    sh_edit_write(screen, used);
+    free(screen);
+}
@@ -0,0 +1,503 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_env.c
+#   Description: Shell variables and the environment.
+#       Variables live in a hash table keyed by name and
+#       are stored as "NAME=value" so exported ones can be
+#       handed to exec as they are. The envp array is
+#       built the first time a command is launched after
+#       an exported variable changed, and the same array
+#       is reused by every launch until the next change.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_env_hash
+#   @desc: FNV-1a hash of a variable name
+#   @param: name - start of the name
+#   @param: len - length of the name
+#   @return: unsigned int hash
+******************************************************/
+static unsigned int sh_env_hash(const char *name, size_t len)
+{
+    unsigned int hash = 2166136261u;
+
+    while (len-- > 0) {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/******************************************************
+#   sh_env_find
+#   @desc: finds the link pointing at a variable
+#   @param: env - variables
+#   @param: name - start of the name (need not end)
+#   @param: len - length of the name
+#   @return: link to the variable, or to the NULL at the
+#       end of its bucket if there is none
+******************************************************/
+static struct EnvVar** sh_env_find(struct Env *env, const char *name, size_t len)
+{
+    unsigned int hash = sh_env_hash(name, len);
+    struct EnvVar **link = &env->buckets[hash & (env->bucket_count - 1)];
+
+    while (*link != NULL) {
+        struct EnvVar *var = *link;
+        if (var->hash == hash && var->name_len == len && memcmp(var->pair, name, len) == 0) {
+            break;
+        }
+        link = &var->next;
+    }
+    return link;
+}
+
+/******************************************************
+#   sh_env_changed
+#   @desc: drops the envp array after an exported
+#       variable changed; the next launch rebuilds it
+#   @param: env - variables
+#   @return: void
+******************************************************/
+static void sh_env_changed(struct Env *env)
+{
+    free(env->envp);
+    env->envp = NULL;
+}
+
+/******************************************************
+#   sh_env_grow
+#   @desc: doubles the bucket array and rehashes
+#   @param: env - variables
+#   @return: void
+******************************************************/
+static void sh_env_grow(struct Env *env)
+{
+    int new_count = env->bucket_count * 2;
+    struct EnvVar **new_buckets = calloc(new_count, sizeof(struct EnvVar*));
+    int i;
+
+    /*Keep the old table if memory is short*/
+    if (new_buckets == NULL) {
+        return;
+    }
+
+    for (i = 0; i < env->bucket_count; i++) {
+        struct EnvVar *var = env->buckets[i];
+        while (var != NULL) {
+            struct EnvVar *next = var->next;
+            int slot = var->hash & (new_count - 1);
+            var->next = new_buckets[slot];
+            new_buckets[slot] = var;
+            var = next;
+        }
+    }
+
+    free(env->buckets);
+    env->buckets = new_buckets;
+    env->bucket_count = new_count;
+}
+
+/******************************************************
+#   sh_env_valid_name
+#   @desc: checks a variable name: a letter or _ then
+#       letters, digits and _
+#   @param: name - start of the name
+#   @param: len - length of the name
+#   @return: 1 if valid, 0 otherwise
+******************************************************/
+int sh_env_valid_name(const char *name, size_t len)
+{
+    size_t i;
+
+    if (len == 0 || (name[0] >= '0' && name[0] <= '9')) {
+        return 0;
+    }
+    for (i = 0; i < len; i++) {
+        char c = name[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/******************************************************
+#   sh_env_init
+#   @desc: loads the environment the shell was started
+#       with; all of it is exported
+#   @param: env - variables
+#   @param: envp - NAME=value strings, NULL terminated
+#   @return: void
+******************************************************/
+void sh_env_init(struct Env *env, char **envp)
+{
+    env->bucket_count = ENV_BUCKETS;
+    env->buckets = calloc(env->bucket_count, sizeof(struct EnvVar*));
+    env->count = 0;
+    env->envp = NULL;
+
+    for (; envp != NULL && *envp != NULL; envp++) {
+        const char *equals = strchr(*envp, '=');
+        if (equals != NULL) {
+            sh_env_setn(env, *envp, equals - *envp, equals + 1, ENV_EXPORT);
+        }
+    }
+}
+
+/******************************************************
+#   sh_env_free
+#   @desc: releases every variable
+#   @param: env - variables
+#   @return: void
+******************************************************/
+void sh_env_free(struct Env *env)
+{
+    int i;
+
+    for (i = 0; i < env->bucket_count; i++) {
+        struct EnvVar *var = env->buckets[i];
+        while (var != NULL) {
+            struct EnvVar *next = var->next;
+            free(var->pair);
+            free(var);
+            var = next;
+        }
+    }
+    free(env->buckets);
+    sh_env_changed(env);
+    env->buckets = NULL;
+    env->count = 0;
+}
+
+/******************************************************
+#   sh_env_getn
+#   @desc: value of a variable whose name is not
+#       terminated (as found inside a word)
+#   @param: env - variables
+#   @param: name - start of the name
+#   @param: len - length of the name
+#   @return: value (owned by env), NULL if unset
+******************************************************/
+const char* sh_env_getn(struct Env *env, const char *name, size_t len)
+{
+    struct EnvVar *var = *sh_env_find(env, name, len);
+
+    return var ? var->pair + var->name_len + 1 : NULL;
+}
+
+/******************************************************
+#   sh_env_get
+#   @desc: value of a variable
+#   @param: env - variables
+#   @param: name - variable name
+#   @return: value (owned by env), NULL if unset
+******************************************************/
+const char* sh_env_get(struct Env *env, const char *name)
+{
+    return sh_env_getn(env, name, strlen(name));
+}
+
+/******************************************************
+#   sh_env_setn
+#   @desc: sets a variable, creating it if needed
+#   @param: env - variables
+#   @param: name - start of the name
+#   @param: len - length of the name
+#   @param: value - new value, NULL to keep the old one
+#       (export NAME)
+#   @param: mode - ENV_EXPORT to export it, ENV_KEEP to
+#       leave an existing variable as it is
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_env_setn(struct Env *env, const char *name, size_t len, const char *value, int mode)
+{
+    struct EnvVar **link = sh_env_find(env, name, len);
+    struct EnvVar *var = *link;
+    char *pair;
+    size_t value_len;
+
+    if (var == NULL) {
+        var = malloc(sizeof(struct EnvVar));
+        if (var == NULL) {
+            return -1;
+        }
+        var->pair = NULL;
+        var->name_len = len;
+        var->hash = sh_env_hash(name, len);
+        var->exported = 0;
+        if (value == NULL) {
+            value = "";
+        }
+        if (env->count >= env->bucket_count) {
+            sh_env_grow(env);
+            link = sh_env_find(env, name, len);
+        }
+        var->next = NULL;
+        *link = var;
+        env->count++;
+    }
+
+    if (value != NULL) {
+        value_len = strlen(value);
+        pair = malloc(len + value_len + 2);
+        if (pair == NULL) {
+            return -1;
+        }
+        memcpy(pair, name, len);
+        pair[len] = '=';
+        memcpy(pair + len + 1, value, value_len + 1);
+        free(var->pair);
+        var->pair = pair;
+        if (var->exported) {
+            sh_env_changed(env);
+        }
+    }
+
+    if (mode == ENV_EXPORT && !var->exported) {
+        var->exported = 1;
+        sh_env_changed(env);
+    }
+
+    return 0;
+}
+
+/******************************************************
+#   sh_env_set
+#   @desc: sets a variable from a terminated name
+#   @param: env - variables
+#   @param: name - variable name
+#   @param: value - new value
+#   @param: mode - ENV_EXPORT or ENV_KEEP
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_env_set(struct Env *env, const char *name, const char *value, int mode)
+{
+    return sh_env_setn(env, name, strlen(name), value, mode);
+}
+
+/******************************************************
+#   sh_env_unset
+#   @desc: removes a variable
+#   @param: env - variables
+#   @param: name - variable name
+#   @return: void
+******************************************************/
+void sh_env_unset(struct Env *env, const char *name)
+{
+    struct EnvVar **link = sh_env_find(env, name, strlen(name));
+    struct EnvVar *var = *link;
+
+    if (var == NULL) {
+        return;
+    }
+    *link = var->next;
+    if (var->exported) {
+        sh_env_changed(env);
+    }
+    free(var->pair);
+    free(var);
+    env->count--;
+}
+
+/******************************************************
+#   sh_env_envp
+#   @desc: environment for a launched command. Built on
+#       the first call after an exported variable
+#       changed; other calls return the same array.
+#   @param: env - variables
+#   @return: NULL terminated NAME=value array (owned by
+#       env), NULL if out of memory
+******************************************************/
+char** sh_env_envp(struct Env *env)
+{
+    int used = 0;
+    int i;
+
+    if (env->envp != NULL) {
+        return env->envp;
+    }
+
+    env->envp = malloc((env->count + 1) * sizeof(char*));
+    if (env->envp == NULL) {
+        return NULL;
+    }
+    for (i = 0; i < env->bucket_count; i++) {
+        struct EnvVar *var;
+        for (var = env->buckets[i]; var != NULL; var = var->next) {
+            if (var->exported) {
+                env->envp[used++] = var->pair;
+            }
+        }
+    }
+    env->envp[used] = NULL;
+
+    return env->envp;
+}
+
+/******************************************************
+#   sh_env_compare
+#   @desc: qsort order of variables by name
+#   @param: a, b - pointers to variables
+#   @return: strcmp order
+******************************************************/
+static int sh_env_compare(const void *a, const void *b)
+{
+    return strcmp((*(struct EnvVar* const*)a)->pair, (*(struct EnvVar* const*)b)->pair);
+}
+
+/******************************************************
+#   sh_env_list
+#   @desc: prints the exported variables by name, in a
+#       form that can be fed back as input
+#   @param: env - variables
+#   @return: void
+******************************************************/
+static void sh_env_list(struct Env *env)
+{
+    struct EnvVar **sorted = malloc((env->count + 1) * sizeof(struct EnvVar*));
+    int used = 0;
+    int i;
+
+    if (sorted == NULL) {
+        return;
+    }
+    for (i = 0; i < env->bucket_count; i++) {
+        struct EnvVar *var;
+        for (var = env->buckets[i]; var != NULL; var = var->next) {
+            if (var->exported) {
+                sorted[used++] = var;
+            }
+        }
+    }
+    qsort(sorted, used, sizeof(struct EnvVar*), sh_env_compare);
+
+    for (i = 0; i < used; i++) {
+        const char *value = sorted[i]->pair + sorted[i]->name_len + 1;
+        fprintf(stdout, "export %.*s=\"", (int)sorted[i]->name_len, sorted[i]->pair);
+        for (; *value != '\0'; value++) {
+            if (strchr("\"\\$`", *value) != NULL) {
+                fputc('\\', stdout);
+            }
+            fputc(*value, stdout);
+        }
+        fprintf(stdout, "\"\n");
+    }
+    fflush(stdout);
+    free(sorted);
+}
+
+/******************************************************
+#   sh_env_assign
+#   @desc: applies a NAME=value word
+#   @param: env - variables
+#   @param: word - assignment word
+#   @param: mode - ENV_EXPORT or ENV_KEEP
+#   @return: 0 on success, -1 if word is not NAME=value
+******************************************************/
+int sh_env_assign(struct Env *env, const char *word, int mode)
+{
+    const char *equals = strchr(word, '=');
+
+    if (equals == NULL || !sh_env_valid_name(word, equals - word)) {
+        return -1;
+    }
+    return sh_env_setn(env, word, equals - word, equals + 1, mode);
+}
+
+/******************************************************
+#   sh_export_command
+#   @desc: exports variables to launched commands
+#       export                  list exported variables
+#       export NAME             export an existing one
+#       export NAME=value       set and export
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_export_command(struct Shell *this_shell)
+{
+    char **args = this_shell->arguments;
+    int failed = 0;
+    int i;
+
+    if (this_shell->args_count == 1) {
+        sh_env_list(&this_shell->env);
+    }
+
+    for (i = 1; i < this_shell->args_count; i++) {
+        int result;
+        if (strchr(args[i], '=') != NULL) {
+            result = sh_env_assign(&this_shell->env, args[i], ENV_EXPORT);
+        }
+        else if (sh_env_valid_name(args[i], strlen(args[i]))) {
+            result = sh_env_set(&this_shell->env, args[i], NULL, ENV_EXPORT);
+        }
+        else {
+            result = -1;
+        }
+        if (result == -1) {
+            fprintf(stdout, "export: %s: not a valid name\n", args[i]);
+            fflush(stdout);
+            failed = 1;
+        }
+    }
+
+    this_shell->status = failed;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_unset_command
+#   @desc: removes variables (unset NAME...)
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_unset_command(struct Shell *this_shell)
+{
+    int i;
+
+    for (i = 1; i < this_shell->args_count; i++) {
+        sh_env_unset(&this_shell->env, this_shell->arguments[i]);
+    }
+
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_env_param
+#   @desc: value of a parameter named inside a word:
+#       a variable, or $? (status), $$ (shell pid) and
+#       $! (last background pid), formatted here
+#   @param: pointer to shell object
+#   @param: name - start of the name
+#   @param: len - length of the name
+#   @param: buf - room for a formatted number
+#   @return: value, NULL if unset
+******************************************************/
+const char* sh_env_param(struct Shell *this_shell, const char *name, size_t len, char *buf)
+{
+    if (len == 1 && name[0] == '?') {
+        /*Signals read as 128+n, like other shells*/
+        sprintf(buf, "%d", this_shell->signaled ? 128 + this_shell->status : this_shell->status);
+        return buf;
+    }
+    if (len == 1 && name[0] == '$') {
+        sprintf(buf, "%d", (int)this_shell->shell_pid);
+        return buf;
+    }
+    if (len == 1 && name[0] == '!') {
+        if (this_shell->last_bg <= 0) {
+            return NULL;
+        }
+        sprintf(buf, "%d", (int)this_shell->last_bg);
+        return buf;
+    }
+    return sh_env_getn(&this_shell->env, name, len);
+}
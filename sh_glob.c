@@ -0,0 +1,534 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_glob.c
+#   Description: Filename expansion. Words flagged by the
+#       tokenizer as patterns (*, ?, [...] and ** for any
+#       number of directories) are replaced by the sorted
+#       paths they match. Directories are read through the
+#       listing cache, so a pattern over a directory that
+#       has not changed costs a stat and a scan of names
+#       already sorted in memory; a literal prefix like
+#       app-2026* narrows the scan by binary search. Paths
+#       are built in the command's arena and collected in
+#       an array kept between commands, so expanding a
+#       pattern does no per-match heap allocation.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_glob_bracket
+#   @desc: matches one character against a [...] set
+#   @param: pat - points at the '['
+#   @param: pat_end - end of the pattern component
+#   @param: c - character to test
+#   @param: matched - receives 1 if c is in the set
+#   @return: pointer past the ']', NULL if the set is
+#       not closed (the '[' is then an ordinary char)
+******************************************************/
+static const char* sh_glob_bracket(const char *pat, const char *pat_end, unsigned char c, int *matched)
+{
+    int negate = 0;
+    int found = 0;
+    int first = 1;
+
+    pat++;
+    if (pat < pat_end && (*pat == '!' || *pat == '^')) {
+        negate = 1;
+        pat++;
+    }
+
+    while (pat < pat_end && (*pat != ']' || first)) {
+        unsigned char low = *pat++;
+        unsigned char high;
+
+        first = 0;
+        if (low == '\\' && pat < pat_end) {
+            low = *pat++;
+        }
+        high = low;
+
+        /*Range a-z, but a trailing - is literal*/
+        if (pat + 1 < pat_end && *pat == '-' && pat[1] != ']') {
+            pat++;
+            high = *pat++;
+            if (high == '\\' && pat < pat_end) {
+                high = *pat++;
+            }
+        }
+        if (c >= low && c <= high) {
+            found = 1;
+        }
+    }
+    if (pat >= pat_end) {
+        return NULL;
+    }
+
+    *matched = found != negate;
+    return pat + 1;
+}
+
+/******************************************************
+#   sh_glob_match
+#   @desc: matches a name against one path component of
+#       a pattern. A * backtracks only to the last star,
+#       so matching is linear for typical patterns.
+#   @param: pat - pattern component
+#   @param: pat_end - end of the component
+#   @param: name - file name
+#   @return: 1 if name matches, 0 otherwise
+******************************************************/
+static int sh_glob_match(const char *pat, const char *pat_end, const char *name)
+{
+    const char *star = NULL;
+    const char *star_name = NULL;
+
+    while (*name != '\0') {
+        if (pat < pat_end) {
+            const char *next;
+            int matched;
+
+            switch (*pat) {
+            case '*':
+                /*Remember where to resume if the rest fails*/
+                star = ++pat;
+                star_name = name;
+                continue;
+            case '?':
+                pat++;
+                name++;
+                continue;
+            case '[':
+                next = sh_glob_bracket(pat, pat_end, *name, &matched);
+                if (next != NULL) {
+                    if (matched) {
+                        pat = next;
+                        name++;
+                        continue;
+                    }
+                    break;
+                }
+                /*Unclosed [ is literal*/
+                if (*name == '[') {
+                    pat++;
+                    name++;
+                    continue;
+                }
+                break;
+            case '\\':
+                if (pat + 1 < pat_end && pat[1] == *name) {
+                    pat += 2;
+                    name++;
+                    continue;
+                }
+                break;
+            default:
+                if (*pat == *name) {
+                    pat++;
+                    name++;
+                    continue;
+                }
+                break;
+            }
+        }
+
+        /*Mismatch: let the last * eat one more char*/
+        if (star == NULL) {
+            return 0;
+        }
+        pat = star;
+        name = ++star_name;
+    }
+
+    while (pat < pat_end && *pat == '*') {
+        pat++;
+    }
+    return pat == pat_end;
+}
+
+/******************************************************
+#   sh_glob_is_pattern
+#   @desc: tells whether a component has an unescaped
+#       * ? or [
+#   @param: pat - pattern component
+#   @param: pat_end - end of the component
+#   @return: 1 if it must be matched, 0 if literal
+******************************************************/
+static int sh_glob_is_pattern(const char *pat, const char *pat_end)
+{
+    for (; pat < pat_end; pat++) {
+        if (*pat == '\\' && pat + 1 < pat_end) {
+            pat++;
+        }
+        else if (*pat == '*' || *pat == '?' || *pat == '[') {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_glob_literal
+#   @desc: copies the unescaped characters of a pattern
+#       component up to its first pattern character
+#   @param: pat - pattern component
+#   @param: pat_end - end of the component
+#   @param: out - receives the text, terminated
+#   @param: out_cap - size of out
+#   @return: length of the text
+******************************************************/
+static size_t sh_glob_literal(const char *pat, const char *pat_end, char *out, size_t out_cap)
+{
+    size_t len = 0;
+
+    while (pat < pat_end && len + 1 < out_cap) {
+        if (*pat == '\\' && pat + 1 < pat_end) {
+            pat++;
+        }
+        else if (*pat == '*' || *pat == '?' || *pat == '[') {
+            break;
+        }
+        out[len++] = *pat++;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+/******************************************************
+#   sh_glob_add
+#   @desc: records a matching path, copied into the arena
+#   @param: pointer to shell object
+#   @param: path - path built so far
+#   @param: len - length of path
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_glob_add(struct Shell *this_shell, const char *path, size_t len)
+{
+    struct Glob *glob = &this_shell->glob;
+    char *copy;
+
+    if (glob->count == glob->cap) {
+        size_t new_cap = glob->cap ? glob->cap * 2 : 256;
+        char **grown = realloc(glob->paths, new_cap * sizeof(char*));
+        if (grown == NULL) {
+            return -1;
+        }
+        glob->paths = grown;
+        glob->cap = new_cap;
+    }
+
+    copy = sh_arena_alloc(&this_shell->arena, len + 1);
+    if (copy == NULL) {
+        return -1;
+    }
+    memcpy(copy, path, len);
+    copy[len] = '\0';
+    glob->paths[glob->count++] = copy;
+    return 0;
+}
+
+/******************************************************
+#   sh_glob_is_dir
+#   @desc: tells whether a listed name is a directory,
+#       without following symlinks (so ** can't loop)
+#   @param: path - path of the name
+#   @param: name - name from a listing
+#   @return: 1 if a directory, 0 otherwise
+******************************************************/
+static int sh_glob_is_dir(const char *path, const char *name)
+{
+    unsigned char type = sh_dircache_type(name);
+    struct stat info;
+
+    if (type != DT_UNKNOWN) {
+        return type == DT_DIR;
+    }
+    return lstat(path, &info) == 0 && S_ISDIR(info.st_mode);
+}
+
+/******************************************************
+#   sh_glob_walk
+#   @desc: matches the rest of a pattern below path.
+#       Names to descend into are copied into the arena
+#       before descending, since deeper listings can push
+#       this one out of the cache.
+#   @param: pointer to shell object
+#   @param: path - buffer holding the path so far
+#   @param: len - length of the path so far
+#   @param: rest - pattern components still to match
+#   @param: literal - 1 if the last component was literal
+#       and its existence is not known yet
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_glob_walk(struct Shell *this_shell, char *path, size_t len, const char *rest, int literal)
+{
+    const struct DirListing *listing;
+    const char *comp_end;
+    const char *next;
+    char prefix[NAME_MAX + 1];
+    char **keep = NULL;
+    size_t keep_count = 0;
+    size_t first;
+    size_t count;
+    size_t i;
+    int dirs_only;
+    struct stat info;
+
+    /*All of the pattern used: path matched*/
+    if (*rest == '\0') {
+        path[len] = '\0';
+        if (literal && lstat(path, &info) == -1) {
+            return 0;
+        }
+        return sh_glob_add(this_shell, path, len);
+    }
+
+    comp_end = strchr(rest, '/');
+    if (comp_end == NULL) {
+        comp_end = rest + strlen(rest);
+    }
+    next = (*comp_end == '/') ? comp_end + 1 : comp_end;
+    dirs_only = (*comp_end == '/');
+
+    /*Literal component: take it as it is*/
+    if (!sh_glob_is_pattern(rest, comp_end)) {
+        size_t comp_len = sh_glob_literal(rest, comp_end, path + len, PATH_MAX - len - 1);
+        if (len + comp_len + 2 >= PATH_MAX) {
+            return 0;
+        }
+        len += comp_len;
+        if (dirs_only) {
+            path[len++] = '/';
+        }
+        return sh_glob_walk(this_shell, path, len, next, 1);
+    }
+
+    path[len] = '\0';
+    listing = sh_dircache_get(&this_shell->dircache, len ? path : ".");
+    if (listing == NULL) {
+        return 0;
+    }
+
+    /*** matches any run of directories, including none*/
+    if (comp_end - rest == 2 && rest[0] == '*' && rest[1] == '*') {
+        count = listing->count;
+        keep = sh_arena_alloc(&this_shell->arena, (count + 1) * sizeof(char*));
+        if (keep == NULL) {
+            return -1;
+        }
+        for (i = 0; i < count; i++) {
+            const char *name = listing->names[i];
+            size_t name_len = strlen(name);
+            if (name[0] == '.' || len + name_len + 2 >= PATH_MAX) {
+                continue;
+            }
+            memcpy(path + len, name, name_len + 1);
+            if (sh_glob_is_dir(path, name)) {
+                keep[keep_count] = sh_arena_alloc(&this_shell->arena, name_len + 1);
+                if (keep[keep_count] == NULL) {
+                    return -1;
+                }
+                memcpy(keep[keep_count++], name, name_len + 1);
+            }
+        }
+
+        /*A final ** lists everything below*/
+        if (sh_glob_walk(this_shell, path, len, *next ? next : "*", 0) == -1) {
+            return -1;
+        }
+        for (i = 0; i < keep_count; i++) {
+            size_t name_len = strlen(keep[i]);
+            memcpy(path + len, keep[i], name_len);
+            path[len + name_len] = '/';
+            if (sh_glob_walk(this_shell, path, len + name_len + 1, rest, 0) == -1) {
+                return -1;
+            }
+        }
+        return 0;
+    }
+
+    /*Names sharing the literal start are one sorted range*/
+    sh_glob_literal(rest, comp_end, prefix, sizeof(prefix));
+    count = sh_dircache_prefix(listing, prefix, &first);
+
+    if (*next != '\0') {
+        keep = sh_arena_alloc(&this_shell->arena, (count + 1) * sizeof(char*));
+        if (keep == NULL) {
+            return -1;
+        }
+    }
+
+    for (i = first; i < first + count; i++) {
+        const char *name = listing->names[i];
+        size_t name_len = strlen(name);
+
+        /*Hidden names need the pattern to start with a dot*/
+        if (name[0] == '.' && rest[0] != '.') {
+            continue;
+        }
+        if (!sh_glob_match(rest, comp_end, name) || len + name_len + 2 >= PATH_MAX) {
+            continue;
+        }
+
+        if (keep != NULL) {
+            keep[keep_count] = sh_arena_alloc(&this_shell->arena, name_len + 1);
+            if (keep[keep_count] == NULL) {
+                return -1;
+            }
+            memcpy(keep[keep_count++], name, name_len + 1);
+            continue;
+        }
+
+        /*Last component: the name is a match*/
+        memcpy(path + len, name, name_len);
+        if (dirs_only) {
+            path[len + name_len] = '\0';
+            if (!sh_glob_is_dir(path, name)) {
+                continue;
+            }
+            path[len + name_len++] = '/';
+        }
+        if (sh_glob_add(this_shell, path, len + name_len) == -1) {
+            return -1;
+        }
+    }
+
+    for (i = 0; i < keep_count; i++) {
+        size_t name_len = strlen(keep[i]);
+        memcpy(path + len, keep[i], name_len);
+        path[len + name_len] = '/';
+        if (sh_glob_walk(this_shell, path, len + name_len + 1, next, 0) == -1) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_glob_compare
+#   @desc: qsort order of matched paths
+#   @param: a, b - pointers to paths
+#   @return: strcmp order
+******************************************************/
+static int sh_glob_compare(const void *a, const void *b)
+{
+    return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/******************************************************
+#   sh_glob_word
+#   @desc: expands one pattern into glob->paths
+#   @param: pointer to shell object
+#   @param: pattern - word with literal chars escaped
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_glob_word(struct Shell *this_shell, const char *pattern)
+{
+    char path[PATH_MAX];
+    size_t len = 0;
+
+    this_shell->glob.count = 0;
+
+    if (pattern[0] == '/') {
+        path[len++] = '/';
+        while (*pattern == '/') {
+            pattern++;
+        }
+    }
+    if (sh_glob_walk(this_shell, path, len, pattern, 0) == -1) {
+        return -1;
+    }
+
+    /*Listings come out sorted; ** interleaves levels*/
+    if (strstr(pattern, "**") != NULL) {
+        qsort(this_shell->glob.paths, this_shell->glob.count, sizeof(char*), sh_glob_compare);
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_glob_expand
+#   @desc: replaces each flagged word of the command by
+#       the paths it matches. A pattern that matches
+#       nothing stays as typed, as in other shells.
+#   @param: pointer to shell object
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_glob_expand(struct Shell *this_shell)
+{
+    unsigned char *flags = this_shell->glob.words;
+    char **args = this_shell->arguments;
+    char **expanded;
+    size_t used = 0;
+    size_t cap;
+    int i;
+
+    if (flags == NULL) {
+        return 0;
+    }
+
+    cap = this_shell->args_count + 1;
+    expanded = sh_arena_alloc(&this_shell->arena, cap * sizeof(char*));
+    if (expanded == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < this_shell->args_count; i++) {
+        size_t j;
+
+        if (!flags[i] || sh_glob_word(this_shell, args[i]) == -1 || this_shell->glob.count == 0) {
+            /*The compiled word is shared: clean a copy*/
+            if (flags[i]) {
+                size_t len = strlen(args[i]);
+                char *copy = sh_arena_alloc(&this_shell->arena, len + 1);
+                if (copy == NULL) {
+                    return -1;
+                }
+                memcpy(copy, args[i], len + 1);
+                sh_unescape(copy);
+                expanded[used++] = copy;
+                continue;
+            }
+            expanded[used++] = args[i];
+            continue;
+        }
+
+        /*Make room for the matches*/
+        if (used + this_shell->glob.count + (this_shell->args_count - i) > cap) {
+            char **bigger;
+            cap = (used + this_shell->glob.count + (this_shell->args_count - i)) * 2;
+            bigger = sh_arena_alloc(&this_shell->arena, cap * sizeof(char*));
+            if (bigger == NULL) {
+                return -1;
+            }
+            memcpy(bigger, expanded, used * sizeof(char*));
+            expanded = bigger;
+        }
+        for (j = 0; j < this_shell->glob.count; j++) {
+            expanded[used++] = this_shell->glob.paths[j];
+        }
+    }
+
+    expanded[used] = NULL;
+    this_shell->arguments = expanded;
+    this_shell->args_count = used;
+    this_shell->glob.words = NULL;
+    return 0;
+}
+
+/******************************************************
+#   sh_glob_free
+#   @desc: releases the match array
+#   @param: glob - filename expansion state
+#   @return: void
+******************************************************/
+void sh_glob_free(struct Glob *glob)
+{
+    free(glob->paths);
+    glob->paths = NULL;
+    glob->count = 0;
+    glob->cap = 0;
+}
@@ -0,0 +1,337 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_hash.c
+#   Description: Command path resolution cache. Maps a
+#       command name to the absolute path found in PATH
+#       so launches can exec it directly instead of
+#       walking every PATH entry each time. Entries are
+#       filled lazily and dropped when PATH changes.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_hash_string
+#   @desc: FNV-1a hash of a command name
+#   @param: name - command name
+#   @return: unsigned int hash
+******************************************************/
+static unsigned int sh_hash_string(const char *name)
+{
+    unsigned int hash = 2166136261u;
+
+    while (*name != '\0') {
+        hash ^= (unsigned char)*name++;
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+/******************************************************
+#   sh_hash_resolve
+#   @desc: walks the PATH entries looking for an
+#       executable regular file called name
+#   @param: path_env - colon separated list of dirs
+#   @param: name - command name (no slash)
+#   @return: malloc'd absolute path, NULL if not found
+******************************************************/
+static char* sh_hash_resolve(const char *path_env, const char *name)
+{
+    size_t name_len = strlen(name);
+    const char *dir = path_env;
+    char candidate[PATH_MAX];
+    struct stat info;
+
+    while (1) {
+        const char *end = strchr(dir, ':');
+        size_t dir_len = end ? (size_t)(end - dir) : strlen(dir);
+
+        /*Empty entry means current directory*/
+        if (dir_len == 0) {
+            dir = ".";
+            dir_len = 1;
+        }
+
+        if (dir_len + name_len + 2 <= sizeof(candidate)) {
+            memcpy(candidate, dir, dir_len);
+            candidate[dir_len] = '/';
+            memcpy(candidate + dir_len + 1, name, name_len + 1);
+
+            if (stat(candidate, &info) == 0 && S_ISREG(info.st_mode)
+                    && access(candidate, X_OK) == 0) {
+                return strdup(candidate);
+            }
+        }
+
+        if (end == NULL) {
+            break;
+        }
+        dir = end + 1;
+    }
+
+    return NULL;
+}
+
+/******************************************************
+#   sh_hash_grow
+#   @desc: doubles the bucket array and rehashes
+#   @param: cache - path cache
+#   @return: void
+******************************************************/
+static void sh_hash_grow(struct PathCache *cache)
+{
+    int new_count = cache->bucket_count * 2;
+    struct PathEntry **new_buckets = calloc(new_count, sizeof(struct PathEntry*));
+    int i;
+
+    /*Keep the old table if memory is short*/
+    if (new_buckets == NULL) {
+        return;
+    }
+
+    for (i = 0; i < cache->bucket_count; i++) {
+        struct PathEntry *entry = cache->buckets[i];
+        while (entry != NULL) {
+            struct PathEntry *next = entry->next;
+            int slot = entry->hash & (new_count - 1);
+            entry->next = new_buckets[slot];
+            new_buckets[slot] = entry;
+            entry = next;
+        }
+    }
+
+    free(cache->buckets);
+    cache->buckets = new_buckets;
+    cache->bucket_count = new_count;
+}
+
+/******************************************************
+#   sh_hash_sync_path
+#   @desc: drops every entry if PATH changed since the
+#       entries were resolved
+#   @param: cache - path cache
+#   @return: current PATH value
+******************************************************/
+static const char* sh_hash_sync_path(struct PathCache *cache)
+{
+    const char *path_env = sh_env_get(cache->env, "PATH");
+
+    if (path_env == NULL) {
+        path_env = DEFAULT_PATH;
+    }
+
+    if (cache->path_env == NULL || strcmp(cache->path_env, path_env) != 0) {
+        sh_hash_clear(cache);
+        free(cache->path_env);
+        cache->path_env = strdup(path_env);
+    }
+
+    return path_env;
+}
+
+/******************************************************
+#   sh_hash_init
+#   @desc: sets up an empty path cache
+#   @param: cache - path cache
+#   @return: void
+******************************************************/
+void sh_hash_init(struct PathCache *cache)
+{
+    cache->bucket_count = PATH_CACHE_BUCKETS;
+    cache->buckets = calloc(cache->bucket_count, sizeof(struct PathEntry*));
+    cache->count = 0;
+    cache->path_env = NULL;
+    cache->env = NULL;
+}
+
+/******************************************************
+#   sh_hash_clear
+#   @desc: forgets every cached command (hash -r)
+#   @param: cache - path cache
+#   @return: void
+******************************************************/
+void sh_hash_clear(struct PathCache *cache)
+{
+    int i;
+
+    for (i = 0; i < cache->bucket_count; i++) {
+        struct PathEntry *entry = cache->buckets[i];
+        while (entry != NULL) {
+            struct PathEntry *next = entry->next;
+            free(entry->name);
+            free(entry->path);
+            free(entry);
+            entry = next;
+        }
+        cache->buckets[i] = NULL;
+    }
+    cache->count = 0;
+}
+
+/******************************************************
+#   sh_hash_free
+#   @desc: releases all memory held by the cache
+#   @param: cache - path cache
+#   @return: void
+******************************************************/
+void sh_hash_free(struct PathCache *cache)
+{
+    sh_hash_clear(cache);
+    free(cache->buckets);
+    free(cache->path_env);
+    cache->buckets = NULL;
+    cache->path_env = NULL;
+}
+
+/******************************************************
+#   sh_hash_add
+#   @desc: caches path as the location of name,
+#       replacing any previous entry (hash -p)
+#   @param: cache - path cache
+#   @param: name - command name
+#   @param: path - absolute path of the command
+#   @return: new entry, NULL if out of memory
+******************************************************/
+struct PathEntry* sh_hash_add(struct PathCache *cache, const char *name, const char *path)
+{
+    unsigned int hash = sh_hash_string(name);
+    struct PathEntry *entry;
+    int slot;
+
+    sh_hash_sync_path(cache);
+    sh_hash_forget(cache, name);
+
+    entry = malloc(sizeof(struct PathEntry));
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->name = strdup(name);
+    entry->path = strdup(path);
+    entry->hash = hash;
+    entry->hits = 0;
+
+    if (cache->count >= cache->bucket_count) {
+        sh_hash_grow(cache);
+    }
+    slot = hash & (cache->bucket_count - 1);
+    entry->next = cache->buckets[slot];
+    cache->buckets[slot] = entry;
+    cache->count++;
+
+    return entry;
+}
+
+/******************************************************
+#   sh_hash_lookup
+#   @desc: returns the absolute path for name, resolving
+#       it through PATH and caching it on a miss. The
+#       whole cache is dropped if PATH has changed.
+#   @param: cache - path cache
+#   @param: name - command name
+#   @return: path (owned by cache), NULL if not found
+******************************************************/
+const char* sh_hash_lookup(struct PathCache *cache, const char *name)
+{
+    const char *path_env;
+    unsigned int hash;
+    struct PathEntry *entry;
+    char *path;
+
+    /*Names with a slash are never searched or cached*/
+    if (strchr(name, '/') != NULL) {
+        return name;
+    }
+
+    path_env = sh_hash_sync_path(cache);
+
+    hash = sh_hash_string(name);
+    for (entry = cache->buckets[hash & (cache->bucket_count - 1)];
+            entry != NULL; entry = entry->next) {
+        if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+            entry->hits++;
+            return entry->path;
+        }
+    }
+
+    /*Miss: walk PATH once*/
+    path = sh_hash_resolve(path_env, name);
+    if (path == NULL) {
+        return NULL;
+    }
+
+    entry = sh_hash_add(cache, name, path);
+    free(path);
+    if (entry == NULL) {
+        return NULL;
+    }
+    entry->hits = 1;
+
+    return entry->path;
+}
+
+/******************************************************
+#   sh_hash_forget
+#   @desc: drops one cached command, used when its
+#       cached path no longer exists
+#   @param: cache - path cache
+#   @param: name - command name
+#   @return: void
+******************************************************/
+void sh_hash_forget(struct PathCache *cache, const char *name)
+{
+    unsigned int hash = sh_hash_string(name);
+    struct PathEntry **link = &cache->buckets[hash & (cache->bucket_count - 1)];
+
+    while (*link != NULL) {
+        struct PathEntry *entry = *link;
+        if (entry->hash == hash && strcmp(entry->name, name) == 0) {
+            *link = entry->next;
+            free(entry->name);
+            free(entry->path);
+            free(entry);
+            cache->count--;
+            return;
+        }
+        link = &entry->next;
+    }
+}
+
+/******************************************************
+#   sh_hash_list
+#   @desc: prints the cached commands
+#   @param: cache - path cache
+#   @param: reusable - 1 prints in a form that can be
+#       fed back as input (hash -l), 0 prints hit counts
+#   @return: void
+******************************************************/
+void sh_hash_list(struct PathCache *cache, int reusable)
+{
+    int i;
+
+    if (cache->count == 0) {
+        fprintf(stdout, "hash: hash table empty\n");
+        fflush(stdout);
+        return;
+    }
+
+    if (reusable == 0) {
+        fprintf(stdout, "hits\tcommand\n");
+    }
+
+    for (i = 0; i < cache->bucket_count; i++) {
+        struct PathEntry *entry;
+        for (entry = cache->buckets[i]; entry != NULL; entry = entry->next) {
+            if (reusable == 1) {
+                fprintf(stdout, "hash -p %s %s\n", entry->path, entry->name);
+            }
+            else {
+                fprintf(stdout, "%4d\t%s\n", entry->hits, entry->path);
+            }
+        }
+    }
+    fflush(stdout);
+}
@@ -0,0 +1,570 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_history.c
+#   Description: Persistent command history. Commands
+#       are appended to a text file, one per line, and the
+#       offset of each is appended to an index file of
+#       64-bit offsets. Both are mapped into memory, so
+#       opening a history of any size costs two mmaps and
+#       entry n is found without reading the file. Shells
+#       sharing the files append under flock() and pick up
+#       each other's entries by remapping when they grow.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_history_unmap
+#   @desc: drops both mappings
+#   @param: history - history object
+#   @return: void
+******************************************************/
+static void sh_history_unmap(struct History *history)
+{
+    if (history->data != NULL) {
+        munmap(history->data, history->data_len);
+    }
+    if (history->index != NULL) {
+        munmap(history->index, history->count * sizeof(uint64_t));
+    }
+    history->data = NULL;
+    history->index = NULL;
+    history->data_len = 0;
+    history->count = 0;
+}
+
+/******************************************************
+#   sh_history_sync
+#   @desc: remaps the files if they grew since they were
+#       mapped, by this shell or another one. The index is
+#       sized first: data is always written before the
+#       offset that points at it.
+#   @param: history - history object
+#   @return: void
+******************************************************/
+static void sh_history_sync(struct History *history)
+{
+    struct stat index_info;
+    struct stat data_info;
+    size_t count;
+
+    if (history->fd == -1
+            || fstat(history->index_fd, &index_info) == -1
+            || fstat(history->fd, &data_info) == -1) {
+        return;
+    }
+
+    count = index_info.st_size / sizeof(uint64_t);
+    if (count == history->count && (size_t)data_info.st_size == history->data_len) {
+        return;
+    }
+
+    sh_history_unmap(history);
+    if (count == 0 || data_info.st_size == 0) {
+        return;
+    }
+
+    history->index = mmap(NULL, count * sizeof(uint64_t), PROT_READ, MAP_SHARED, history->index_fd, 0);
+    history->data = mmap(NULL, data_info.st_size, PROT_READ, MAP_SHARED, history->fd, 0);
+    if (history->index == MAP_FAILED || history->data == MAP_FAILED) {
+        if (history->index != MAP_FAILED) {
+            munmap(history->index, count * sizeof(uint64_t));
+        }
+        if (history->data != MAP_FAILED) {
+            munmap(history->data, data_info.st_size);
+        }
+        history->index = NULL;
+        history->data = NULL;
+        return;
+    }
+    history->count = count;
+    history->data_len = data_info.st_size;
+}
+
+/******************************************************
+#   sh_history_rebuild
+#   @desc: writes the index for a history file that has
+#       none (first use, or index deleted). This is the
+#       only time the whole file is read.
+#   @param: history - history object
+#   @return: void
+******************************************************/
+static void sh_history_rebuild(struct History *history)
+{
+    struct stat info;
+    char *data;
+    uint64_t offset = 0;
+
+    if (fstat(history->fd, &info) == -1 || info.st_size == 0) {
+        return;
+    }
+    data = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, history->fd, 0);
+    if (data == MAP_FAILED) {
+        return;
+    }
+
+    while (offset < (uint64_t)info.st_size) {
+        char *end = memchr(data + offset, '\n', info.st_size - offset);
+        if (write(history->index_fd, &offset, sizeof(offset)) != sizeof(offset)) {
+            break;
+        }
+        if (end == NULL) {
+            break;
+        }
+        offset = end + 1 - data;
+    }
+
+    munmap(data, info.st_size);
+}
+
+/******************************************************
+#   sh_history_open
+#   @desc: opens (creating if needed) the history file
+#       and its index and maps them
+#   @param: history - history object
+#   @param: path - history file, index is path + ".idx"
+#   @return: 0 on success, -1 if history is unavailable
+******************************************************/
+int sh_history_open(struct History *history, const char *path)
+{
+    char index_path[PATH_MAX];
+    struct stat index_info;
+
+    history->fd = -1;
+    history->index_fd = -1;
+    history->data = NULL;
+    history->index = NULL;
+    history->data_len = 0;
+    history->count = 0;
+
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", path) >= (int)sizeof(index_path)) {
+        return -1;
+    }
+
+    history->fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    history->index_fd = open(index_path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    if (history->fd == -1 || history->index_fd == -1) {
+        sh_history_close(history);
+        return -1;
+    }
+
+    /*History without an index: build it once*/
+    flock(history->fd, LOCK_EX);
+    if (fstat(history->index_fd, &index_info) == 0 && index_info.st_size == 0) {
+        sh_history_rebuild(history);
+    }
+    flock(history->fd, LOCK_UN);
+
+    sh_history_sync(history);
+    return 0;
+}
+
+/******************************************************
+#   sh_history_close
+#   @desc: unmaps and closes the history files
+#   @param: history - history object
+#   @return: void
+******************************************************/
+void sh_history_close(struct History *history)
+{
+    sh_history_unmap(history);
+    if (history->fd != -1) {
+        close(history->fd);
+    }
+    if (history->index_fd != -1) {
+        close(history->index_fd);
+    }
+    history->fd = -1;
+    history->index_fd = -1;
+}
+
+/******************************************************
+#   sh_history_add
+#   @desc: appends a command. The lock keeps the data and
+#       the index in the same order when several shells
+#       append at once.
+#   @param: history - history object
+#   @param: line - command text (no newline)
+#   @param: len - length of line
+#   @return: void
+******************************************************/
+void sh_history_add(struct History *history, const char *line, size_t len)
+{
+    struct stat info;
+    uint64_t offset;
+    struct iovec parts[2];
+
+    if (history->fd == -1 || len == 0) {
+        return;
+    }
+
+    flock(history->fd, LOCK_EX);
+    if (fstat(history->fd, &info) == 0) {
+        offset = info.st_size;
+        parts[0].iov_base = (void*)line;
+        parts[0].iov_len = len;
+        parts[1].iov_base = "\n";
+        parts[1].iov_len = 1;
+        if (writev(history->fd, parts, 2) == (ssize_t)len + 1) {
+            if (write(history->index_fd, &offset, sizeof(offset)) != sizeof(offset)) {
+                /*Index is short: the entry is just not found*/
+            }
+        }
+    }
+    flock(history->fd, LOCK_UN);
+}
+
+/******************************************************
+#   sh_history_count
+#   @desc: number of entries, including ones appended by
+#       other shells since the last look
+#   @param: history - history object
+#   @return: entry count
+******************************************************/
+size_t sh_history_count(struct History *history)
+{
+    if (history->fd == -1) {
+        return 0;
+    }
+    sh_history_sync(history);
+    return history->count;
+}
+
+/******************************************************
+#   sh_history_entry
+#   @desc: finds entry n (1 = oldest)
+#   @param: history - history object
+#   @param: n - entry number
+#   @param: len - receives length of the entry
+#   @return: entry text (not terminated), NULL if no such
+******************************************************/
+const char* sh_history_entry(struct History *history, size_t n, size_t *len)
+{
+    uint64_t offset;
+    const char *end;
+
+    sh_history_sync(history);
+    if (n == 0 || n > history->count) {
+        return NULL;
+    }
+
+    offset = history->index[n - 1];
+    if (offset >= history->data_len) {
+        return NULL;
+    }
+    end = memchr(history->data + offset, '\n', history->data_len - offset);
+    *len = (end ? (size_t)(end - history->data) : history->data_len) - offset;
+    return history->data + offset;
+}
+
+/******************************************************
+#   sh_history_find_prefix
+#   @desc: newest entry starting with prefix
+#   @param: history - history object
+#   @param: prefix - text to match
+#   @param: prefix_len - length of prefix
+#   @return: entry number, 0 if none matches
+******************************************************/
+size_t sh_history_find_prefix(struct History *history, const char *prefix, size_t prefix_len)
+{
+    size_t n;
+
+    sh_history_sync(history);
+    for (n = history->count; n > 0; n--) {
+        uint64_t offset = history->index[n - 1];
+        if (offset + prefix_len <= history->data_len
+                && memcmp(history->data + offset, prefix, prefix_len) == 0) {
+            return n;
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_history_locate
+#   @desc: entry number holding a byte of the file, by
+#       binary search of the (sorted) offsets
+#   @param: history - history object
+#   @param: offset - byte offset in the history file
+#   @return: entry number
+******************************************************/
+static size_t sh_history_locate(struct History *history, uint64_t offset)
+{
+    size_t low = 0;
+    size_t high = history->count;
+
+    /*Last entry whose start is <= offset*/
+    while (high - low > 1) {
+        size_t mid = low + (high - low) / 2;
+        if (history->index[mid] <= offset) {
+            low = mid;
+        }
+        else {
+            high = mid;
+        }
+    }
+    return low + 1;
+}
+
+/******************************************************
+#   sh_history_print
+#   @desc: prints one numbered entry
+#   @param: history - history object
+#   @param: n - entry number
+#   @return: void
+******************************************************/
+static void sh_history_print(struct History *history, size_t n)
+{
+    size_t len;
+    const char *text = sh_history_entry(history, n, &len);
+
+    if (text != NULL) {
+        fprintf(stdout, "%5zu  %.*s\n", n, (int)len, text);
+    }
+}
+
+/******************************************************
+#   sh_history_search
+#   @desc: prints every entry containing text. memmem
+#       runs over the whole mapped file at once and each
+#       hit is mapped back to its entry through the index.
+#   @param: history - history object
+#   @param: text - substring to look for
+#   @return: number of entries printed
+******************************************************/
+static size_t sh_history_search(struct History *history, const char *text)
+{
+    size_t text_len = strlen(text);
+    const char *cur;
+    const char *end;
+    size_t found = 0;
+
+    sh_history_sync(history);
+    if (history->data == NULL || text_len == 0) {
+        return 0;
+    }
+
+    cur = history->data;
+    end = history->data + history->data_len;
+    while (cur < end) {
+        const char *hit = memmem(cur, end - cur, text, text_len);
+        const char *line_end;
+        size_t n;
+
+        if (hit == NULL) {
+            break;
+        }
+        /*A match across a newline is not inside one entry*/
+        line_end = memchr(hit, '\n', end - hit);
+        if (line_end != NULL && (size_t)(line_end - hit) < text_len) {
+            cur = line_end + 1;
+            continue;
+        }
+
+        n = sh_history_locate(history, hit - history->data);
+        sh_history_print(history, n);
+        found++;
+
+        /*One line per entry however many matches it has*/
+        if (line_end == NULL) {
+            break;
+        }
+        cur = line_end + 1;
+    }
+
+    return found;
+}
+
+/******************************************************
+#   sh_history_command
+#   @desc: history [n] lists all or the last n entries;
+#       history -s text lists entries containing text
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_history_command(struct Shell *this_shell)
+{
+    struct History *history = &this_shell->history;
+    char **args = this_shell->arguments;
+    size_t first = 1;
+    size_t n;
+
+    this_shell->status = 0;
+
+    if (history->fd == -1) {
+        fprintf(stdout, "history: no history file\n");
+        this_shell->status = 1;
+    }
+    else if (this_shell->args_count == 3 && strcmp(args[1], "-s") == 0) {
+        if (sh_history_search(history, args[2]) == 0) {
+            this_shell->status = 1;
+        }
+    }
+    else if (this_shell->args_count == 2 && args[1][0] >= '0' && args[1][0] <= '9') {
+        size_t last = strtoul(args[1], NULL, 10);
+        sh_history_sync(history);
+        if (last < history->count) {
+            first = history->count - last + 1;
+        }
+        for (n = first; n <= history->count; n++) {
+            sh_history_print(history, n);
+        }
+    }
+    else if (this_shell->args_count == 1) {
+        sh_history_sync(history);
+        for (n = 1; n <= history->count; n++) {
+            sh_history_print(history, n);
+        }
+    }
+    else {
+        fprintf(stdout, "history: usage: history [n] | history -s text\n");
+        this_shell->status = 2;
+    }
+
+    fflush(stdout);
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_history_event
+#   @desc: resolves the event after a '!': !!, !n, !-n
+#       or !prefix
+#   @param: history - history object
+#   @param: cur - character after the '!'
+#   @param: end - end of the line
+#   @param: used - receives characters consumed
+#   @return: entry number, 0 if not found
+******************************************************/
+static size_t sh_history_event(struct History *history, const char *cur, const char *end, size_t *used)
+{
+    const char *start = cur;
+    size_t n;
+
+    sh_history_sync(history);
+
+    if (*cur == '!') {
+        *used = 1;
+        return history->count;
+    }
+
+    if (*cur == '-' || (*cur >= '0' && *cur <= '9')) {
+        int back = (*cur == '-');
+        if (back) {
+            cur++;
+        }
+        n = 0;
+        while (cur < end && *cur >= '0' && *cur <= '9') {
+            n = n * 10 + (*cur++ - '0');
+        }
+        *used = cur - start;
+        if (back) {
+            return n > 0 && n <= history->count ? history->count - n + 1 : 0;
+        }
+        return n;
+    }
+
+    /*Prefix runs to the end of the word*/
+    while (cur < end && strchr(" \t\n;&|<>()", *cur) == NULL) {
+        cur++;
+    }
+    *used = cur - start;
+    return sh_history_find_prefix(history, start, cur - start);
+}
+
+/******************************************************
+#   sh_history_expand
+#   @desc: replaces !!, !n, !-n and !prefix in a line
+#       with the entries they name. Single quotes and a
+#       backslash protect a '!', as does a following blank
+#       or a '$' before it ($!).
+#   @param: history - history object
+#   @param: arena - receives the expanded line
+#   @param: line - input line
+#   @param: len - length of line
+#   @param: out - receives the expanded line
+#   @param: out_len - receives its length
+#   @return: 0 unchanged, 1 expanded, -1 event not found
+******************************************************/
+int sh_history_expand(struct History *history, struct Arena *arena, const char *line, size_t len,
+        char **out, size_t *out_len)
+{
+    const char *cur = line;
+    const char *end = line + len;
+    char *text = NULL;
+    size_t text_len = 0;
+    size_t cap = 0;
+    int quoted = 0;
+    int expanded = 0;
+
+    if (history->fd == -1 || memchr(line, '!', len) == NULL) {
+        return 0;
+    }
+
+    while (cur < end) {
+        const char *piece = cur;
+        size_t piece_len = 1;
+        size_t advance = 1;
+
+        if (*cur == '\'') {
+            quoted = !quoted;
+        }
+        else if (*cur == '\\' && !quoted && cur + 1 < end) {
+            piece_len = 2;
+            advance = 2;
+        }
+        else if (*cur == '!' && !quoted && cur + 1 < end
+                && strchr(" \t\n=(", cur[1]) == NULL && (cur == line || cur[-1] != '$')) {
+            size_t used;
+            size_t n = sh_history_event(history, cur + 1, end, &used);
+
+            piece = sh_history_entry(history, n, &piece_len);
+            if (piece == NULL) {
+                fprintf(stdout, "simple_shell: %.*s: event not found\n", (int)used + 1, cur);
+                fflush(stdout);
+                free(text);
+                return -1;
+            }
+            advance = used + 1;
+            expanded = 1;
+        }
+
+        if (text_len + piece_len > cap) {
+            char *grown;
+            cap = (text_len + piece_len) * 2 + 64;
+            grown = realloc(text, cap);
+            if (grown == NULL) {
+                free(text);
+                return 0;
+            }
+            text = grown;
+        }
+        memcpy(text + text_len, piece, piece_len);
+        text_len += piece_len;
+        cur += advance;
+    }
+
+    if (!expanded) {
+        free(text);
+        return 0;
+    }
+
+    /*Expanded line lives with the command's words*/
+    *out = sh_arena_alloc(arena, text_len + 1);
+    if (*out == NULL) {
+        free(text);
+        return 0;
+    }
+    memcpy(*out, text, text_len);
+    (*out)[text_len] = '\0';
+    *out_len = text_len;
+    free(text);
+    return 1;
+}
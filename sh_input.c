@@ -0,0 +1,195 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_input.c
+#   Description: Buffered line reader for the shell's
+#       input. Reads the terminal, a script file or a
+#       -c string in large chunks and hands out lines of
+#       any length straight from its buffer.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_input_open
+#   @desc: sets up a reader on an open descriptor
+#   @param: reader - reader to initialize
+#   @param: fd - descriptor to read from
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_input_open(struct InputReader *reader, int fd)
+{
+    reader->fd = fd;
+    reader->cap = INPUT_CHUNK;
+    reader->buf = malloc(reader->cap);
+    reader->start = 0;
+    reader->end = 0;
+    reader->eof = 0;
+    reader->interactive = isatty(fd);
+    reader->scanned = 0;
+
+    return reader->buf == NULL ? -1 : 0;
+}
+
+/******************************************************
+#   sh_input_string
+#   @desc: sets up a reader over a fixed string (-c)
+#   @param: reader - reader to initialize
+#   @param: text - commands to run
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_input_string(struct InputReader *reader, const char *text)
+{
+    size_t len = strlen(text);
+
+    reader->fd = -1;
+    reader->cap = len + 1;
+    reader->buf = malloc(reader->cap);
+    reader->start = 0;
+    reader->end = len;
+    reader->eof = 1;
+    reader->interactive = 0;
+    reader->scanned = 0;
+
+    if (reader->buf == NULL) {
+        return -1;
+    }
+    memcpy(reader->buf, text, len);
+
+    return 0;
+}
+
+/******************************************************
+#   sh_input_next
+#   @desc: returns the next complete line already in the
+#       buffer, including its '\n' when there is one. At
+#       end of input a last line without '\n' is returned
+#       as is. The line stays valid until the next call.
+#   @param: reader - reader to take the line from
+#   @param: len - receives the length of the line
+#   @return: pointer to the line, NULL if more input is
+#       needed (or at end of input)
+******************************************************/
+char* sh_input_next(struct InputReader *reader, size_t *len)
+{
+    char *newline = memchr(reader->buf + reader->scanned, '\n', reader->end - reader->scanned);
+    char *line = reader->buf + reader->start;
+
+    if (newline != NULL) {
+        *len = newline + 1 - line;
+        reader->start += *len;
+        reader->scanned = reader->start;
+        return line;
+    }
+
+    /*Don't search the partial line again*/
+    reader->scanned = reader->end;
+
+    /*Last line without a newline*/
+    if (reader->eof && reader->start < reader->end) {
+        *len = reader->end - reader->start;
+        reader->start = reader->end;
+        return line;
+    }
+
+    return NULL;
+}
+
+/******************************************************
+#   sh_input_fill
+#   @desc: does one read into the buffer, first moving a
+#       partial line to the front and growing the buffer
+#       if the partial line fills it
+#   @param: reader - reader to fill
+#   @return: bytes read, 0 at end of input, -1 if the
+#       read was interrupted or would block
+******************************************************/
+ssize_t sh_input_fill(struct InputReader *reader)
+{
+    ssize_t got;
+
+    if (reader->eof) {
+        return 0;
+    }
+
+    /*Move the partial line to the front*/
+    if (reader->start > 0) {
+        memmove(reader->buf, reader->buf + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->scanned -= reader->start;
+        reader->start = 0;
+    }
+
+    /*Partial line fills the buffer*/
+    if (reader->end == reader->cap) {
+        char *bigger = realloc(reader->buf, reader->cap * 2);
+        if (bigger == NULL) {
+            reader->eof = 1;
+            return 0;
+        }
+        reader->buf = bigger;
+        reader->cap *= 2;
+    }
+
+    got = read(reader->fd, reader->buf + reader->end, reader->cap - reader->end);
+    if (got > 0) {
+        reader->end += got;
+        return got;
+    }
+    if (got == -1 && (errno == EINTR || errno == EAGAIN)) {
+        return -1;
+    }
+
+    reader->eof = 1;
+    return 0;
+}
+
+/******************************************************
+#   sh_input_push
+#   @desc: appends text to the buffer as if it had been
+#       read, used for lines finished in the line editor
+#   @param: reader - reader to add to
+#   @param: text - bytes to add
+#   @param: len - number of bytes
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_input_push(struct InputReader *reader, const char *text, size_t len)
+{
+    /*Move the partial line to the front*/
+    if (reader->start > 0) {
+        memmove(reader->buf, reader->buf + reader->start, reader->end - reader->start);
+        reader->end -= reader->start;
+        reader->scanned -= reader->start;
+        reader->start = 0;
+    }
+
+    while (reader->end + len > reader->cap) {
+        char *bigger = realloc(reader->buf, reader->cap * 2);
+        if (bigger == NULL) {
+            return -1;
+        }
+        reader->buf = bigger;
+        reader->cap *= 2;
+    }
+
+    memcpy(reader->buf + reader->end, text, len);
+    reader->end += len;
+    return 0;
+}
+
+/******************************************************
+#   sh_input_close
+#   @desc: frees the buffer and closes a script file
+#   @param: reader - reader to close
+#   @return: void
+******************************************************/
+void sh_input_close(struct InputReader *reader)
+{
+    if (reader->fd > 2) {
+        close(reader->fd);
+    }
+    free(reader->buf);
+    reader->buf = NULL;
+}
@@ -0,0 +1,844 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_jobctl.c
+#   Description: Job control. On a terminal every job
+#       runs in a process group of its own and the shell
+#       hands the terminal to the foreground one, so
+#       CTRL-C and CTRL-Z reach only that job. A job that
+#       stops joins the job table, where jobs, fg, bg,
+#       wait and kill %n find it. The shell itself keeps
+#       SIGINT and SIGCHLD on its signalfd and ignores the
+#       terminal stop signals; it installs no handlers.
+#
+******************************************************/
+#include "simple_shell.h"
+
+/*Signal names kill accepts, without SIG*/
+static const struct
+{
+    const char *name;
+    int number;
+} sh_signals[] = {
+    { "HUP", SIGHUP }, { "INT", SIGINT }, { "QUIT", SIGQUIT }, { "KILL", SIGKILL },
+    { "USR1", SIGUSR1 }, { "USR2", SIGUSR2 }, { "PIPE", SIGPIPE }, { "ALRM", SIGALRM },
+    { "TERM", SIGTERM }, { "CHLD", SIGCHLD }, { "CONT", SIGCONT }, { "STOP", SIGSTOP },
+    { "TSTP", SIGTSTP }, { "TTIN", SIGTTIN }, { "TTOU", SIGTTOU }, { "WINCH", SIGWINCH },
+};
+
+#define SIGNAL_COUNT (int)(sizeof(sh_signals) / sizeof(sh_signals[0]))
+
+
+/******************************************************
+#   sh_jobctl_init
+#   @desc: turns job control on when commands come from
+#       a terminal: waits until the shell is in the
+#       foreground, ignores the terminal stop signals,
+#       puts the shell in a group of its own and takes
+#       the terminal
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_jobctl_init(struct Shell *this_shell)
+{
+    struct JobControl *control = &this_shell->control;
+    int fd = this_shell->input.fd;
+    struct sigaction action;
+    pid_t pgrp;
+
+    if (!this_shell->input.interactive || fd == -1 || !isatty(fd)) {
+        return;
+    }
+
+    /*Started in the background: wait to be brought forward*/
+    while (tcgetpgrp(fd) != (pgrp = getpgrp())) {
+        kill(-pgrp, SIGTTIN);
+    }
+
+    action.sa_handler = SIG_IGN;
+    action.sa_flags = 0;
+    sigfillset(&(action.sa_mask));
+    sigaction(SIGTSTP, &action, NULL);
+    sigaction(SIGTTIN, &action, NULL);
+    sigaction(SIGTTOU, &action, NULL);
+    sigaction(SIGQUIT, &action, NULL);
+
+    /*Fails harmlessly if the shell already leads a session*/
+    setpgid(0, 0);
+    control->shell_pgid = getpgrp();
+    if (tcsetpgrp(fd, control->shell_pgid) == -1) {
+        return;
+    }
+    tcgetattr(fd, &control->modes);
+    /*A copy of its own: fg < file moves the shell's fd 0*/
+    control->tty_fd = fcntl(fd, F_DUPFD_CLOEXEC, REDIRECT_FDS);
+    if (control->tty_fd == -1) {
+        control->tty_fd = fd;
+    }
+    control->enabled = 1;
+}
+
+/******************************************************
+#   sh_job_pgid
+#   @desc: process group a new job is started in
+#   @param: pointer to shell object
+#   @return: 0 for a group of its own (job control,
+#       background, or a deadline), -1 for the shell's
+#       group
+******************************************************/
+pid_t sh_job_pgid(struct Shell *this_shell)
+{
+    return (this_shell->ground || this_shell->control.enabled || this_shell->timers.arming) ? 0 : -1;
+}
+
+/******************************************************
+#   sh_job_foreground
+#   @desc: gives the terminal to a job's group
+#   @param: pointer to shell object
+#   @param: pgid - process group of the job
+#   @return: void
+******************************************************/
+void sh_job_foreground(struct Shell *this_shell, pid_t pgid)
+{
+    if (this_shell->control.enabled) {
+        tcsetpgrp(this_shell->control.tty_fd, pgid);
+    }
+}
+
+/******************************************************
+#   sh_job_reclaim
+#   @desc: takes the terminal back from a foreground
+#       job, keeping the modes it left if it stopped,
+#       and puts back the shell's modes
+#   @param: pointer to shell object
+#   @param: job - job that stopped, NULL if it ended
+#   @return: void
+******************************************************/
+static void sh_job_reclaim(struct Shell *this_shell, struct Job *job)
+{
+    struct JobControl *control = &this_shell->control;
+
+    if (!control->enabled) {
+        /*CTRL-C reached the shell too; the job has dealt with it*/
+        sh_loop_signals(&this_shell->loop);
+        this_shell->loop.interrupted = 0;
+        return;
+    }
+
+    tcsetpgrp(control->tty_fd, control->shell_pgid);
+    if (job != NULL) {
+        job->has_modes = tcgetattr(control->tty_fd, &job->modes) == 0;
+    }
+    tcsetattr(control->tty_fd, TCSADRAIN, &control->modes);
+}
+
+/******************************************************
+#   sh_job_print
+#   @desc: prints one line of the jobs list
+#   @param: pointer to shell object
+#   @param: slot - job to print
+#   @param: pids - 1 to show the process group
+#   @return: void
+******************************************************/
+static void sh_job_print(struct Shell *this_shell, int slot, int pids)
+{
+    struct Job *job = &this_shell->jobs.jobs[slot];
+    char mark = slot == this_shell->jobs.current ? '+' : ' ';
+    const char *state = job->state == JOB_STOPPED ? "Stopped" : "Running";
+    const char *command = job->command != NULL ? job->command : "";
+    char usage[64] = "";
+    char memory_text[16];
+    long long memory;
+    double cpu;
+
+    /*What the job's cgroup measured, before the command*/
+    if (job->cgroup != NULL && sh_limit_usage(job->cgroup, &memory, &cpu) == 0) {
+        if (memory >= 0) {
+            sh_limit_size(memory, memory_text, sizeof(memory_text));
+        }
+        else {
+            snprintf(memory_text, sizeof(memory_text), "-");
+        }
+        snprintf(usage, sizeof(usage), "mem %-6s cpu %.2fs  ", memory_text, cpu);
+    }
+
+    if (pids) {
+        fprintf(stdout, "[%d]%c %d %-10s %s%s\n", job->id, mark, (int)job->pgid, state, usage, command);
+    }
+    else {
+        fprintf(stdout, "[%d]%c  %-10s %s%s\n", job->id, mark, state, usage, command);
+    }
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_job_started
+#   @desc: records a job that was just started in the
+#       background or just stopped, with the text of the
+#       command being run, the cgroup made for it, the
+#       capture of its output and its deadline
+#   @param: pointer to shell object
+#   @param: pid - pid reported when the job finishes
+#   @param: pgid - process group of the job
+#   @return: slot index, -1 if out of memory
+******************************************************/
+int sh_job_started(struct Shell *this_shell, pid_t pid, pid_t pgid)
+{
+    int slot = sh_job_add(&this_shell->jobs, pid, pgid);
+
+    if (slot != -1 && this_shell->job_ast != NULL) {
+        this_shell->jobs.jobs[slot].command = sh_ast_text(this_shell->job_ast, this_shell->job_node);
+    }
+    if (slot != -1) {
+        this_shell->jobs.jobs[slot].cgroup = sh_limit_take(this_shell);
+        sh_capture_take(this_shell, &this_shell->jobs.jobs[slot]);
+        this_shell->jobs.jobs[slot].timer = sh_deadline_take(this_shell);
+    }
+    return slot;
+}
+
+/******************************************************
+#   sh_job_changed
+#   @desc: notes that a job stopped or continued
+#   @param: pointer to shell object
+#   @param: slot - the job
+#   @param: status - status from wait4
+#   @return: 1 if a notice was printed, 0 otherwise
+******************************************************/
+int sh_job_changed(struct Shell *this_shell, int slot, int status)
+{
+    struct Job *job = &this_shell->jobs.jobs[slot];
+
+    /*Jobs of builtins only matter once they are done*/
+    if (job->on_done != NULL) {
+        return 0;
+    }
+    if (WIFCONTINUED(status)) {
+        job->state = JOB_RUNNING;
+        return 0;
+    }
+    if (job->state == JOB_STOPPED) {
+        return 0;
+    }
+    job->state = JOB_STOPPED;
+    this_shell->jobs.current = slot;
+    sh_job_print(this_shell, slot, 0);
+    return 1;
+}
+
+/******************************************************
+#   sh_job_wait4
+#   @desc: wait4 that keeps draining the background
+#       jobs' captured output while it sleeps, so they
+#       don't stall on a full pipe behind this one, and
+#       keeps the deadlines ticking
+#   @param: pointer to shell object
+#   @param: target - pid or -pgid to wait for
+#   @param: status - receives the wait status
+#   @param: options - wait4 options
+#   @param: usage - receives the child's rusage
+#   @return: as wait4
+******************************************************/
+static pid_t sh_job_wait4(struct Shell *this_shell, pid_t target, int *status, int options,
+        struct rusage *usage)
+{
+    struct EventLoop *loop = &this_shell->loop;
+    pid_t done;
+
+    if ((this_shell->captures.open == 0 && this_shell->timers.count == 0) || loop->signal_fd == -1) {
+        return wait4(target, status, options, usage);
+    }
+    while ((done = wait4(target, status, options | WNOHANG, usage)) == 0) {
+        sh_loop_block(this_shell, -1);
+        /*Without job control a job with a deadline is out of the terminal's reach*/
+        if (loop->interrupted && target < -1 && !this_shell->control.enabled) {
+            loop->interrupted = 0;
+            kill(target, SIGINT);
+        }
+    }
+    return done;
+}
+
+/******************************************************
+#   sh_job_wait
+#   @desc: waits for a foreground job. A job with a
+#       group of its own is waited for as a group until
+#       none of it is left or it stops; processes in the
+#       shell's group are waited for one by one.
+#   @param: pointer to shell object
+#   @param: pgid - group of the job, -1 if it has none
+#   @param: pids - its processes, the last one's status
+#       is the job's
+#   @param: count - number of pids
+#   @return: signal that stopped the job, 0 if it ended
+******************************************************/
+static int sh_job_wait(struct Shell *this_shell, pid_t pgid, const pid_t *pids, int count)
+{
+    struct JobControl *control = &this_shell->control;
+    struct rusage usage;
+    int status;
+    int i;
+
+    if (pgid > 0) {
+        while (1) {
+            pid_t done = sh_job_wait4(this_shell, -pgid, &status, WUNTRACED, &usage);
+
+            if (done == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                /*Nothing left in the group*/
+                return 0;
+            }
+            if (WIFSTOPPED(status)) {
+                /*Touched the terminal before it was handed over*/
+                if ((WSTOPSIG(status) == SIGTTIN || WSTOPSIG(status) == SIGTTOU) && control->enabled
+                        && tcgetpgrp(control->tty_fd) == pgid) {
+                    kill(-pgid, SIGCONT);
+                    continue;
+                }
+                return WSTOPSIG(status);
+            }
+            sh_usage_add(&this_shell->usage, &usage);
+            if (done == pids[count - 1]) {
+                sh_set_status(this_shell, status);
+            }
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        pid_t done;
+
+        while ((done = sh_job_wait4(this_shell, pids[i], &status, 0, &usage)) == -1 && errno == EINTR) {
+        }
+        /*Reaped elsewhere: status still holds an earlier stage's*/
+        if (done != pids[i]) {
+            continue;
+        }
+        if (WIFEXITED(status) || WIFSIGNALED(status)) {
+            sh_usage_add(&this_shell->usage, &usage);
+            if (i == count - 1) {
+                sh_set_status(this_shell, status);
+            }
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_job_stopped
+#   @desc: records how a stopped job left the shell
+#   @param: pointer to shell object
+#   @param: signo - signal that stopped it
+#   @return: void
+******************************************************/
+static void sh_job_stopped(struct Shell *this_shell, int signo)
+{
+    this_shell->status = 128 + signo;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_job_killed
+#   @desc: tells the user a foreground job was ended by a
+#       signal (CTRL-C included), which it can't say
+#       itself
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+static void sh_job_killed(struct Shell *this_shell)
+{
+    fprintf(stdout, "terminated by signal %d\n", this_shell->status);
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_wait_fg
+#   @desc: waits for a job started in the foreground,
+#       takes the terminal back and moves the job into
+#       the job table if it stopped. A job a signal ended
+#       is reported, unless its deadline sent the signal.
+#   @param: pointer to shell object
+#   @param: pgid - group of the job, -1 if it has none
+#   @param: pids - its processes, last one reported
+#   @param: count - number of pids
+#   @return: void
+******************************************************/
+void sh_wait_fg(struct Shell *this_shell, pid_t pgid, const pid_t *pids, int count)
+{
+    int stopped;
+    int slot = -1;
+
+    if (count == 0) {
+        return;
+    }
+    stopped = sh_job_wait(this_shell, pgid, pids, count);
+
+    if (stopped) {
+        slot = sh_job_started(this_shell, pids[count - 1], pgid);
+    }
+    sh_job_reclaim(this_shell, slot != -1 ? &this_shell->jobs.jobs[slot] : NULL);
+
+    if (stopped) {
+        if (slot != -1) {
+            this_shell->jobs.jobs[slot].state = JOB_STOPPED;
+            fprintf(stdout, "\n");
+            sh_job_print(this_shell, slot, 0);
+        }
+        sh_job_stopped(this_shell, stopped);
+    }
+    else if (this_shell->signaled
+            && (this_shell->timers.current == NULL || !this_shell->timers.current->fired)) {
+        sh_job_killed(this_shell);
+    }
+}
+
+/******************************************************
+#   sh_job_spec
+#   @desc: finds the job a %spec names: %n by number,
+#       % %% %+ the current job, %text the job whose
+#       command starts with text
+#   @param: pointer to shell object
+#   @param: spec - job spec, NULL for the current job
+#   @return: slot index, -1 if there is no such job
+******************************************************/
+static int sh_job_spec(struct Shell *this_shell, const char *spec)
+{
+    struct JobTable *table = &this_shell->jobs;
+    char *end;
+    long id;
+    int slot;
+
+    if (spec == NULL || strcmp(spec, "%") == 0 || strcmp(spec, "%%") == 0 || strcmp(spec, "%+") == 0) {
+        /*Builtins' jobs are never current for long; skip them*/
+        for (slot = table->current; slot != -1; slot = table->jobs[slot].next) {
+            if (table->jobs[slot].on_done == NULL) {
+                return slot;
+            }
+        }
+        return -1;
+    }
+    if (spec[0] != '%') {
+        return -1;
+    }
+
+    id = strtol(spec + 1, &end, 10);
+    for (slot = table->live_head; slot != -1; slot = table->jobs[slot].next) {
+        struct Job *job = &table->jobs[slot];
+        if (job->on_done != NULL) {
+            continue;
+        }
+        if (*end == '\0' && end != spec + 1) {
+            if (job->id == id) {
+                return slot;
+            }
+        }
+        else if (job->command != NULL && strncmp(job->command, spec + 1, strlen(spec + 1)) == 0) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/******************************************************
+#   sh_job_usage
+#   @desc: reports a bad argument to a job builtin
+#   @param: pointer to shell object
+#   @param: what - message after the builtin's name
+#   @param: arg - argument it is about
+#   @return: void
+******************************************************/
+static void sh_job_usage(struct Shell *this_shell, const char *what, const char *arg)
+{
+    fprintf(stdout, "%s: %s: %s\n", this_shell->arguments[0], arg != NULL ? arg : "current", what);
+    fflush(stdout);
+    this_shell->status = 1;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_jobs_command
+#   @desc: jobs lists the background and stopped jobs,
+#       jobs -l with their process groups and jobs -p
+#       just the process groups. jobs -o [-n lines]
+#       [%n|pid] shows a job's captured output, running
+#       or finished.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_jobs_command(struct Shell *this_shell)
+{
+    struct JobTable *table = &this_shell->jobs;
+    const char *option = this_shell->args_count > 1 ? this_shell->arguments[1] : "";
+    int slot;
+    int last = -1;
+
+    if (strcmp(option, "-o") == 0) {
+        char **argv = this_shell->arguments + 2;
+        int argc = this_shell->args_count - 2;
+        long lines = 0;
+
+        if (argc >= 2 && strcmp(argv[0], "-n") == 0) {
+            lines = strtol(argv[1], NULL, 10);
+            argv += 2;
+            argc -= 2;
+        }
+        if (lines < 0 || argc > 1) {
+            fprintf(stdout, "jobs: usage: jobs -o [-n lines] [%%n|pid]\n");
+            fflush(stdout);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            return;
+        }
+        if (sh_capture_show(this_shell, argc == 1 ? argv[0] : NULL, lines) == -1) {
+            sh_job_usage(this_shell, "no output captured", argc == 1 ? argv[0] : NULL);
+            return;
+        }
+        this_shell->status = 0;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*Oldest first: walk to the end of the live list, then back*/
+    for (slot = table->live_head; slot != -1; slot = table->jobs[slot].next) {
+        last = slot;
+    }
+    for (slot = last; slot != -1; slot = table->jobs[slot].prev) {
+        if (table->jobs[slot].on_done != NULL) {
+            continue;
+        }
+        if (strcmp(option, "-p") == 0) {
+            fprintf(stdout, "%d\n", (int)table->jobs[slot].pgid);
+            fflush(stdout);
+        }
+        else {
+            sh_job_print(this_shell, slot, strcmp(option, "-l") == 0);
+        }
+    }
+
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_fg_command
+#   @desc: fg [%n] continues a job in the foreground,
+#       giving it the terminal, and waits for it
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_fg_command(struct Shell *this_shell)
+{
+    const char *spec = this_shell->args_count > 1 ? this_shell->arguments[1] : NULL;
+    int slot = sh_job_spec(this_shell, spec);
+    struct Job *job;
+    pid_t pid;
+    pid_t pgid;
+    int stopped;
+
+    if (slot == -1) {
+        sh_job_usage(this_shell, "no such job", spec);
+        return;
+    }
+    job = &this_shell->jobs.jobs[slot];
+    pid = job->pid;
+    pgid = job->pgid;
+
+    fprintf(stdout, "%s\n", job->command != NULL ? job->command : "");
+    fflush(stdout);
+
+    /*Give it the terminal as it was when it stopped*/
+    if (this_shell->control.enabled) {
+        sh_job_foreground(this_shell, pgid);
+        if (job->has_modes) {
+            tcsetattr(this_shell->control.tty_fd, TCSADRAIN, &job->modes);
+        }
+    }
+    job->state = JOB_RUNNING;
+    kill(pgid > 0 ? -pgid : pid, SIGCONT);
+
+    /*Captured output shows while it is in the foreground*/
+    if (job->capture != NULL) {
+        job->capture->echo = 1;
+    }
+
+    sh_usage_begin(&this_shell->usage);
+    stopped = sh_job_wait(this_shell, pgid > 0 ? pgid : -1, &pid, 1);
+    sh_usage_end(&this_shell->usage);
+
+    /*The table may have grown while it ran*/
+    job = &this_shell->jobs.jobs[slot];
+    sh_job_reclaim(this_shell, stopped ? job : NULL);
+    if (job->capture != NULL) {
+        job->capture->echo = 0;
+    }
+
+    if (stopped) {
+        job->state = JOB_STOPPED;
+        this_shell->jobs.current = slot;
+        fprintf(stdout, "\n");
+        sh_job_print(this_shell, slot, 0);
+        sh_job_stopped(this_shell, stopped);
+        return;
+    }
+    if (this_shell->trace.fd != -1) {
+        sh_trace_reaped(&this_shell->trace, pid, this_shell->usage.wait_status, &this_shell->usage.last);
+    }
+    if (!sh_deadline_status(this_shell, job->timer) && this_shell->signaled) {
+        sh_job_killed(this_shell);
+    }
+    sh_job_remove(&this_shell->jobs, slot);
+}
+
+/******************************************************
+#   sh_bg_command
+#   @desc: bg [%n] continues a stopped job in the
+#       background
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_bg_command(struct Shell *this_shell)
+{
+    const char *spec = this_shell->args_count > 1 ? this_shell->arguments[1] : NULL;
+    int slot = sh_job_spec(this_shell, spec);
+    struct Job *job;
+
+    if (slot == -1) {
+        sh_job_usage(this_shell, "no such job", spec);
+        return;
+    }
+    job = &this_shell->jobs.jobs[slot];
+
+    job->state = JOB_RUNNING;
+    kill(job->pgid > 0 ? -job->pgid : job->pid, SIGCONT);
+    fprintf(stdout, "[%d] %s &\n", job->id, job->command != NULL ? job->command : "");
+    fflush(stdout);
+
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_wait_one
+#   @desc: waits for a background job to end and prints
+#       its done notice, as sh_catch_bg would have. CTRL-C
+#       stops the waiting, not the job.
+#   @param: pointer to shell object
+#   @param: slot - the job
+#   @return: 0 when it ended, 1 if it stopped, -1 if
+#       interrupted
+******************************************************/
+static int sh_wait_one(struct Shell *this_shell, int slot)
+{
+    struct EventLoop *loop = &this_shell->loop;
+    struct Job *job = &this_shell->jobs.jobs[slot];
+    pid_t target = job->pgid > 0 ? -job->pgid : job->pid;
+    pid_t pid = job->pid;
+    int options = loop->signal_fd == -1 ? WUNTRACED : WNOHANG | WUNTRACED;
+    struct rusage usage;
+    int status;
+    int job_status = -1;
+
+    while (1) {
+        pid_t done;
+
+        /*Reap whatever of it has finished*/
+        while ((done = wait4(target, &status, options, &usage)) > 0) {
+            if (WIFSTOPPED(status)) {
+                sh_job_changed(this_shell, slot, status);
+                return 1;
+            }
+            if (done == pid) {
+                if (this_shell->trace.fd != -1) {
+                    sh_trace_reaped(&this_shell->trace, pid, status, &usage);
+                }
+                sh_set_status(this_shell, status);
+                job_status = status;
+            }
+        }
+        if (done == -1 && errno == ECHILD) {
+            if (job_status != -1) {
+                sh_bg_done(pid, job_status, this_shell->jobs.jobs[slot].timer);
+            }
+            sh_deadline_status(this_shell, this_shell->jobs.jobs[slot].timer);
+            sh_job_remove(&this_shell->jobs, slot);
+            return 0;
+        }
+        if (done == -1 && errno == EINTR) {
+            continue;
+        }
+
+        /*Sleep until a child changes or CTRL-C*/
+        if (loop->signal_fd != -1) {
+            sh_loop_block(this_shell, -1);
+            if (loop->interrupted) {
+                loop->interrupted = 0;
+                return -1;
+            }
+        }
+    }
+}
+
+/******************************************************
+#   sh_wait_command
+#   @desc: wait [%n|pid ...] waits for the jobs named,
+#       or all background jobs, to end. Its status is
+#       the last one's.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_wait_command(struct Shell *this_shell)
+{
+    struct JobTable *table = &this_shell->jobs;
+    int result;
+    int i;
+
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+
+    /*No arguments: every running job, most recent first*/
+    if (this_shell->args_count == 1) {
+        while (1) {
+            int slot;
+            for (slot = table->live_head; slot != -1; slot = table->jobs[slot].next) {
+                if (table->jobs[slot].on_done == NULL && table->jobs[slot].state == JOB_RUNNING) {
+                    break;
+                }
+            }
+            if (slot == -1) {
+                break;
+            }
+            if (sh_wait_one(this_shell, slot) == -1) {
+                this_shell->status = 128 + SIGINT;
+                this_shell->signaled = 0;
+                return;
+            }
+        }
+        this_shell->status = 0;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    for (i = 1; i < this_shell->args_count; i++) {
+        const char *arg = this_shell->arguments[i];
+        int slot = arg[0] == '%' ? sh_job_spec(this_shell, arg) : sh_job_find(table, atoi(arg));
+
+        if (slot == -1 || table->jobs[slot].on_done != NULL) {
+            sh_job_usage(this_shell, "no such job", arg);
+            this_shell->status = 127;
+            continue;
+        }
+        result = sh_wait_one(this_shell, slot);
+        if (result == -1) {
+            this_shell->status = 128 + SIGINT;
+            this_shell->signaled = 0;
+            return;
+        }
+        if (result == 1) {
+            sh_job_stopped(this_shell, SIGSTOP);
+        }
+    }
+}
+
+/******************************************************
+#   sh_signal_number
+#   @desc: reads a signal given by number or by name,
+#       with or without SIG
+#   @param: name - signal as typed
+#   @return: signal number, -1 if unknown
+******************************************************/
+static int sh_signal_number(const char *name)
+{
+    char *end;
+    long number = strtol(name, &end, 10);
+    int i;
+
+    if (*name != '\0' && *end == '\0') {
+        return (number >= 0 && number < NSIG) ? (int)number : -1;
+    }
+    if (strncmp(name, "SIG", 3) == 0) {
+        name += 3;
+    }
+    for (i = 0; i < SIGNAL_COUNT; i++) {
+        if (strcmp(name, sh_signals[i].name) == 0) {
+            return sh_signals[i].number;
+        }
+    }
+    return -1;
+}
+
+/******************************************************
+#   sh_kill_command
+#   @desc: kill [-SIG | -s SIG] %n|pid ... sends a
+#       signal (TERM by default) to jobs, as whole
+#       process groups, or to processes. Stopped jobs
+#       are woken so they see TERM or HUP. kill -l
+#       lists the signal names.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_kill_command(struct Shell *this_shell)
+{
+    char **args = this_shell->arguments;
+    int signo = SIGTERM;
+    int i = 1;
+
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+
+    if (this_shell->args_count > 1 && strcmp(args[1], "-l") == 0) {
+        for (i = 0; i < SIGNAL_COUNT; i++) {
+            fprintf(stdout, "%2d) SIG%s\n", sh_signals[i].number, sh_signals[i].name);
+        }
+        fflush(stdout);
+        return;
+    }
+
+    if (i < this_shell->args_count && strcmp(args[i], "-s") == 0 && i + 1 < this_shell->args_count) {
+        signo = sh_signal_number(args[i + 1]);
+        i += 2;
+    }
+    else if (i < this_shell->args_count && args[i][0] == '-' && args[i][1] != '\0') {
+        signo = sh_signal_number(args[i] + 1);
+        i++;
+    }
+    if (signo == -1 || i == this_shell->args_count) {
+        fprintf(stdout, "kill: usage: kill [-s sig | -sig] %%job|pid ...\n");
+        fflush(stdout);
+        this_shell->status = 2;
+        return;
+    }
+
+    for (; i < this_shell->args_count; i++) {
+        pid_t target;
+        int slot = -1;
+
+        if (args[i][0] == '%') {
+            slot = sh_job_spec(this_shell, args[i]);
+            if (slot == -1) {
+                sh_job_usage(this_shell, "no such job", args[i]);
+                continue;
+            }
+            target = this_shell->jobs.jobs[slot].pgid > 0 ? -this_shell->jobs.jobs[slot].pgid
+                : this_shell->jobs.jobs[slot].pid;
+        }
+        else {
+            char *end;
+            target = strtol(args[i], &end, 10);
+            if (*end != '\0' || end == args[i]) {
+                sh_job_usage(this_shell, "arguments must be process or job IDs", args[i]);
+                continue;
+            }
+        }
+
+        if (kill(target, signo) == -1) {
+            sh_job_usage(this_shell, strerror(errno), args[i]);
+            continue;
+        }
+        if (slot != -1 && this_shell->jobs.jobs[slot].state == JOB_STOPPED
+                && (signo == SIGTERM || signo == SIGHUP)) {
+            kill(target, SIGCONT);
+        }
+    }
+}
@@ -0,0 +1,278 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_jobs.c
+#   Description: Background job table. Jobs live in a
+#       growable array of slots; freed slots are reused
+#       through a free list, finished children are found
+#       by pid through a hash of slot indices, and live
+#       jobs are chained so walking them skips free slots.
+#       Stopped foreground jobs are kept here too.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_job_bucket
+#   @desc: hash bucket of a pid
+#   @param: table - job table
+#   @param: pid - process id
+#   @return: bucket index
+******************************************************/
+static int sh_job_bucket(struct JobTable *table, pid_t pid)
+{
+    return ((unsigned int)pid * 2654435761u) & (table->capacity - 1);
+}
+
+/******************************************************
+#   sh_jobs_grow
+#   @desc: doubles the slot array and rebuilds the pid
+#       hash. Slot indices stay the same.
+#   @param: table - job table
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_jobs_grow(struct JobTable *table)
+{
+    int new_capacity = table->capacity * 2;
+    struct Job *jobs = realloc(table->jobs, new_capacity * sizeof(struct Job));
+    int *buckets;
+    int i;
+
+    if (jobs == NULL) {
+        return -1;
+    }
+    table->jobs = jobs;
+
+    buckets = realloc(table->buckets, new_capacity * sizeof(int));
+    if (buckets == NULL) {
+        return -1;
+    }
+    table->buckets = buckets;
+
+    /*New slots go on the free list*/
+    for (i = new_capacity - 1; i >= table->capacity; i--) {
+        table->jobs[i].pid = 0;
+        table->jobs[i].next = table->free_head;
+        table->free_head = i;
+    }
+    table->capacity = new_capacity;
+
+    /*Rehash live jobs*/
+    for (i = 0; i < new_capacity; i++) {
+        table->buckets[i] = -1;
+    }
+    for (i = table->live_head; i != -1; i = table->jobs[i].next) {
+        int bucket = sh_job_bucket(table, table->jobs[i].pid);
+        table->jobs[i].hash_next = table->buckets[bucket];
+        table->buckets[bucket] = i;
+    }
+
+    return 0;
+}
+
+/******************************************************
+#   sh_jobs_init
+#   @desc: sets up an empty job table
+#   @param: table - job table
+#   @return: void
+******************************************************/
+void sh_jobs_init(struct JobTable *table)
+{
+    int i;
+
+    table->capacity = JOB_TABLE_SIZE;
+    table->jobs = malloc(table->capacity * sizeof(struct Job));
+    table->buckets = malloc(table->capacity * sizeof(int));
+    table->count = 0;
+    table->live_head = -1;
+    table->free_head = -1;
+    table->current = -1;
+    table->next_id = 0;
+
+    for (i = table->capacity - 1; i >= 0; i--) {
+        table->jobs[i].pid = 0;
+        table->jobs[i].next = table->free_head;
+        table->free_head = i;
+        table->buckets[i] = -1;
+    }
+}
+
+/******************************************************
+#   sh_jobs_free
+#   @desc: releases the job table's memory
+#   @param: table - job table
+#   @return: void
+******************************************************/
+void sh_jobs_free(struct JobTable *table)
+{
+    int slot;
+
+    for (slot = table->live_head; slot != -1; slot = table->jobs[slot].next) {
+        free(table->jobs[slot].command);
+        free(table->jobs[slot].cgroup);
+    }
+    free(table->jobs);
+    free(table->buckets);
+    table->jobs = NULL;
+    table->buckets = NULL;
+    table->count = 0;
+}
+
+/******************************************************
+#   sh_job_add
+#   @desc: records a running job in a free slot and
+#       makes it the current job
+#   @param: table - job table
+#   @param: pid - pid reported when the job finishes
+#   @param: pgid - process group of the job, 0 if it
+#       has none of its own
+#   @return: slot index, -1 if out of memory
+******************************************************/
+int sh_job_add(struct JobTable *table, pid_t pid, pid_t pgid)
+{
+    struct Job *job;
+    int slot;
+    int bucket;
+
+    if (table->free_head == -1 && sh_jobs_grow(table) == -1) {
+        return -1;
+    }
+
+    /*Take a free slot*/
+    slot = table->free_head;
+    job = &table->jobs[slot];
+    table->free_head = job->next;
+
+    job->pid = pid;
+    job->pgid = pgid;
+    job->id = ++table->next_id;
+    job->state = JOB_RUNNING;
+    job->command = NULL;
+    job->cgroup = NULL;
+    job->capture = NULL;
+    job->timer = NULL;
+    job->has_modes = 0;
+    job->on_done = NULL;
+    job->data = NULL;
+
+    /*Link into the live list*/
+    job->prev = -1;
+    job->next = table->live_head;
+    if (table->live_head != -1) {
+        table->jobs[table->live_head].prev = slot;
+    }
+    table->live_head = slot;
+
+    /*Link into the pid hash*/
+    bucket = sh_job_bucket(table, pid);
+    job->hash_next = table->buckets[bucket];
+    table->buckets[bucket] = slot;
+
+    table->count++;
+    table->current = slot;
+    return slot;
+}
+
+/******************************************************
+#   sh_job_find
+#   @desc: looks up a live job by pid
+#   @param: table - job table
+#   @param: pid - process id
+#   @return: slot index, -1 if pid is not a job
+******************************************************/
+int sh_job_find(struct JobTable *table, pid_t pid)
+{
+    int slot;
+
+    for (slot = table->buckets[sh_job_bucket(table, pid)]; slot != -1;
+            slot = table->jobs[slot].hash_next) {
+        if (table->jobs[slot].pid == pid) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/******************************************************
+#   sh_job_remove
+#   @desc: unlinks a finished job and frees its slot
+#   @param: table - job table
+#   @param: slot - slot index of the job
+#   @return: void
+******************************************************/
+void sh_job_remove(struct JobTable *table, int slot)
+{
+    struct Job *job = &table->jobs[slot];
+    int *link = &table->buckets[sh_job_bucket(table, job->pid)];
+
+    /*Unlink from the pid hash*/
+    while (*link != -1) {
+        if (*link == slot) {
+            *link = job->hash_next;
+            break;
+        }
+        link = &table->jobs[*link].hash_next;
+    }
+
+    /*Unlink from the live list*/
+    if (job->prev != -1) {
+        table->jobs[job->prev].next = job->next;
+    }
+    else {
+        table->live_head = job->next;
+    }
+    if (job->next != -1) {
+        table->jobs[job->next].prev = job->prev;
+    }
+
+    /*Back on the free list*/
+    free(job->command);
+    job->command = NULL;
+    sh_limit_remove(job->cgroup);
+    job->cgroup = NULL;
+    sh_timer_cancel(job->timer);
+    job->timer = NULL;
+    /*Its output stays viewable until the space is needed*/
+    if (job->capture != NULL) {
+        job->capture->done = 1;
+        job->capture = NULL;
+    }
+    job->pid = 0;
+    job->next = table->free_head;
+    table->free_head = slot;
+    table->count--;
+
+    /*Most recent job left becomes current; numbers restart when empty*/
+    if (table->current == slot) {
+        table->current = table->live_head;
+    }
+    if (table->count == 0) {
+        table->next_id = 0;
+    }
+}
+
+/******************************************************
+#   sh_job_find_group
+#   @desc: looks up a live job by process group, for
+#       processes of a pipeline other than the one the
+#       job is hashed by
+#   @param: table - job table
+#   @param: pgid - process group
+#   @return: slot index, -1 if no job has that group
+******************************************************/
+int sh_job_find_group(struct JobTable *table, pid_t pgid)
+{
+    int slot;
+
+    if (pgid <= 0) {
+        return -1;
+    }
+    for (slot = table->live_head; slot != -1; slot = table->jobs[slot].next) {
+        if (table->jobs[slot].pgid == pgid) {
+            return slot;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,107 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_launch.c
+#   Description: Process launch layer. Starts commands
+#       with posix_spawn instead of fork() so the cost
+#       of a launch does not grow with the shell's RSS.
+#       Pipes and redirection lists are passed as spawn
+#       file actions.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_launch
+#   @desc: spawns the program at path with stdin
+#       and stdout optionally connected to the given
+#       descriptors, then the redirection list applied.
+#       Children get the default action for the job
+#       control signals the shell ignores, and for SIGINT
+#       unless they run in the background without job
+#       control, where they inherit the ignored SIGINT.
+#   @param: path - location of the program to exec
+#   @param: argv - NULL terminated argument vector
+#   @param: envp - environment of the program
+#   @param: in_fd - descriptor for stdin, -1 to inherit
+#   @param: out_fd - descriptor for stdout, -1 to inherit
+#   @param: redirects - opened redirections, applied after
+#       the pipe descriptors
+#   @param: redirect_count - number of redirections
+#   @param: background - 1 to leave SIGINT ignored
+#   @param: pgid - process group to join, 0 to start a
+#       new group, -1 to stay in the shell's group
+#   @param: tty_fd - terminal a new group takes over
+#       before the program starts, -1 for none
+#   @param: child_PID - receives the pid of the child
+#   @return: 0 on success, errno value on failure
+******************************************************/
+int sh_launch(const char *path, char **argv, char **envp, int in_fd, int out_fd,
+        const struct Redirect *redirects, int redirect_count, int background, pid_t pgid, int tty_fd,
+        pid_t *child_PID)
+{
+    posix_spawn_file_actions_t actions;
+    posix_spawnattr_t attr;
+    sigset_t sig_default;
+    sigset_t sig_mask;
+    short spawn_flags = POSIX_SPAWN_SETSIGMASK;
+    int result;
+
+    posix_spawn_file_actions_init(&actions);
+    posix_spawnattr_init(&attr);
+
+    /*Set up redirection for read*/
+    if (in_fd != -1) {
+        posix_spawn_file_actions_adddup2(&actions, in_fd, 0);
+        posix_spawn_file_actions_addclose(&actions, in_fd);
+    }
+    /*Set up redirection for write*/
+    if (out_fd != -1) {
+        posix_spawn_file_actions_adddup2(&actions, out_fd, 1);
+        posix_spawn_file_actions_addclose(&actions, out_fd);
+    }
+    /*Redirections override the pipes*/
+    sh_redirect_actions(&actions, redirects, redirect_count);
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 35))
+    /*Take the terminal before exec, so the program can't read it too early*/
+    if (tty_fd != -1 && pgid == 0) {
+        posix_spawn_file_actions_addtcsetpgrp_np(&actions, tty_fd);
+    }
+#else
+    (void)tty_fd;
+#endif
+
+    /*Child starts with nothing blocked*/
+    sigemptyset(&sig_mask);
+    posix_spawnattr_setsigmask(&attr, &sig_mask);
+
+    /*CTRL-Z and terminal access stop children; CTRL-C interrupts them*/
+    sigemptyset(&sig_default);
+    sigaddset(&sig_default, SIGTSTP);
+    sigaddset(&sig_default, SIGTTIN);
+    sigaddset(&sig_default, SIGTTOU);
+    sigaddset(&sig_default, SIGQUIT);
+    if (background == 0) {
+        sigaddset(&sig_default, SIGINT);
+    }
+    posix_spawnattr_setsigdefault(&attr, &sig_default);
+    spawn_flags |= POSIX_SPAWN_SETSIGDEF;
+
+    /*Pipeline stages share one process group*/
+    if (pgid != -1) {
+        posix_spawnattr_setpgroup(&attr, pgid);
+        spawn_flags |= POSIX_SPAWN_SETPGROUP;
+    }
+    posix_spawnattr_setflags(&attr, spawn_flags);
+
+    result = posix_spawn(child_PID, path, &actions, &attr, argv, envp);
+
+    posix_spawnattr_destroy(&attr);
+    posix_spawn_file_actions_destroy(&actions);
+
+    return result;
+}
@@ -0,0 +1,632 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_limit.c
+#   Description: Resource limits for launched commands.
+#       The limit builtin keeps session defaults and runs
+#       a command with extra limits. They are in place
+#       before the program runs: a program is started
+#       through the shell itself as a small exec helper
+#       that sets the rlimits and joins the cgroup, then
+#       execs it. With
+#       $SIMPLE_SHELL_CGROUP naming a delegated cgroup v2
+#       directory, each job also gets a cgroup of its own
+#       there, with memory.max and cpu.max, and jobs shows
+#       the memory and CPU the cgroup measured.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include "simple_shell.h"
+
+
+/*Option, rlimit (-1 for a cgroup file) and name of each limit*/
+static const struct
+{
+    char option;
+    int resource;
+    int size; /*1 = value is bytes, takes K/M/G*/
+    const char *name;
+} sh_limit_kinds[LIMIT_COUNT] = {
+    { 't', RLIMIT_CPU,    0, "cpu seconds" },
+    { 'v', RLIMIT_AS,     1, "address space" },
+    { 'n', RLIMIT_NOFILE, 0, "open files" },
+    { 'u', RLIMIT_NPROC,  0, "processes" },
+    { 'm', -1,            1, "memory.max" },
+    { 'c', -1,            0, "cpu.max %" },
+};
+
+/******************************************************
+#   sh_limits_init
+#   @desc: no limits and no cgroup
+#   @param: limits - limits of the shell
+#   @return: void
+******************************************************/
+void sh_limits_init(struct Limits *limits)
+{
+    int i;
+
+    for (i = 0; i < LIMIT_COUNT; i++) {
+        limits->value[i] = LIMIT_UNSET;
+    }
+    limits->group = NULL;
+    limits->procs_fd = -1;
+    limits->made = 0;
+    limits->nested = 0;
+    limits->warned = 0;
+}
+
+/******************************************************
+#   sh_limits_free
+#   @desc: releases a cgroup still being started
+#   @param: limits - limits of the shell
+#   @return: void
+******************************************************/
+void sh_limits_free(struct Limits *limits)
+{
+    if (limits->procs_fd != -1) {
+        close(limits->procs_fd);
+    }
+    free(limits->group);
+    limits->group = NULL;
+    limits->procs_fd = -1;
+}
+
+/******************************************************
+#   sh_limit_write
+#   @desc: writes a value into a cgroup file
+#   @param: dir - cgroup directory
+#   @param: file - name of the file in it
+#   @param: text - value to write
+#   @return: 0 on success, -1 with errno set
+******************************************************/
+static int sh_limit_write(const char *dir, const char *file, const char *text)
+{
+    char path[PATH_MAX];
+    ssize_t written;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    fd = open(path, O_WRONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    written = write(fd, text, strlen(text));
+    if (written == -1) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    close(fd);
+    return 0;
+}
+
+/******************************************************
+#   sh_limit_read
+#   @desc: reads a cgroup file
+#   @param: dir - cgroup directory
+#   @param: file - name of the file in it
+#   @param: buf - receives the text, NUL terminated
+#   @param: len - size of buf
+#   @return: bytes read, -1 on failure
+******************************************************/
+static ssize_t sh_limit_read(const char *dir, const char *file, char *buf, size_t len)
+{
+    char path[PATH_MAX];
+    ssize_t got;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/%s", dir, file);
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    got = read(fd, buf, len - 1);
+    close(fd);
+    if (got >= 0) {
+        buf[got] = '\0';
+    }
+    return got;
+}
+
+/******************************************************
+#   sh_limit_warn
+#   @desc: prints why a limit could not be set
+#   @param: what - limit or file concerned
+#   @param: error - errno value
+#   @return: void
+******************************************************/
+static void sh_limit_warn(const char *what, int error)
+{
+    fprintf(stdout, "limit: %s: %s\n", what, strerror(error));
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_limit_size
+#   @desc: formats a byte count the way limit reads
+#       them back
+#   @param: bytes - count to format
+#   @param: buf - receives the text
+#   @param: len - size of buf
+#   @return: void
+******************************************************/
+void sh_limit_size(long long bytes, char *buf, size_t len)
+{
+    static const char units[] = "KMGT";
+    double value = (double)bytes;
+    int unit = -1;
+
+    while (value >= 1024 && unit < 3) {
+        value /= 1024;
+        unit++;
+    }
+    if (unit == -1) {
+        snprintf(buf, len, "%lld", bytes);
+    }
+    else {
+        snprintf(buf, len, "%.1f%c", value, units[unit]);
+    }
+}
+
+/******************************************************
+#   sh_limit_parse
+#   @desc: reads the value of a limit option. Sizes take
+#       a K, M, G or T suffix; "unlimited" clears it.
+#   @param: text - value as typed
+#   @param: kind - LIMIT_* index
+#   @param: value - receives the value
+#   @return: 0 on success, -1 if text is not a value
+******************************************************/
+static int sh_limit_parse(const char *text, int kind, long long *value)
+{
+    const char *units = "KMGT";
+    const char *unit;
+    char *end;
+    long long number;
+
+    if (strcmp(text, "unlimited") == 0 || strcmp(text, "max") == 0) {
+        *value = LIMIT_UNSET;
+        return 0;
+    }
+
+    errno = 0;
+    number = strtoll(text, &end, 10);
+    if (end == text || number < 0 || errno != 0) {
+        return -1;
+    }
+    if (*end != '\0') {
+        unit = sh_limit_kinds[kind].size ? strchr(units, *end) : NULL;
+        if (unit == NULL || end[1] != '\0') {
+            return -1;
+        }
+        number <<= 10 * (unit - units + 1);
+    }
+    if (kind == LIMIT_CPU_MAX && number == 0) {
+        return -1;
+    }
+
+    *value = number;
+    return 0;
+}
+
+/******************************************************
+#   sh_limit_begin
+#   @desc: makes the cgroup for a job about to start,
+#       when $SIMPLE_SHELL_CGROUP is set, with the
+#       memory.max and cpu.max limits written into it.
+#       Its processes join it before they run anything,
+#       through the exec helper or sh_limit_attach.
+#   @param: pointer to shell object
+#   @return: 1 if a cgroup was made, 0 otherwise
+******************************************************/
+int sh_limit_begin(struct Shell *this_shell)
+{
+    struct Limits *limits = &this_shell->limits;
+    const char *root;
+    char path[PATH_MAX];
+    char procs[PATH_MAX];
+    char text[64];
+
+    if (limits->nested || limits->group != NULL) {
+        return 0;
+    }
+    root = sh_env_get(&this_shell->env, "SIMPLE_SHELL_CGROUP");
+    if (root == NULL || root[0] == '\0') {
+        return 0;
+    }
+
+    /*Hand memory and cpu down to the job cgroups; fails harmlessly if already done*/
+    if (limits->made == 0) {
+        sh_limit_write(root, "cgroup.subtree_control", "+memory +cpu");
+    }
+    limits->made++;
+
+    snprintf(path, sizeof(path), "%s/sh%d-%u", root, (int)this_shell->shell_pid, limits->made);
+    if (mkdir(path, 0755) == -1 && errno != EEXIST) {
+        sh_limit_warn(path, errno);
+        return 0;
+    }
+
+    if (limits->value[LIMIT_MEMORY] != LIMIT_UNSET) {
+        snprintf(text, sizeof(text), "%lld", limits->value[LIMIT_MEMORY]);
+        if (sh_limit_write(path, "memory.max", text) == -1 && !(limits->warned & (1 << LIMIT_MEMORY))) {
+            sh_limit_warn("memory.max", errno);
+            limits->warned |= 1 << LIMIT_MEMORY;
+        }
+    }
+    if (limits->value[LIMIT_CPU_MAX] != LIMIT_UNSET) {
+        snprintf(text, sizeof(text), "%lld %d",
+                limits->value[LIMIT_CPU_MAX] * LIMIT_CPU_PERIOD / 100, LIMIT_CPU_PERIOD);
+        if (sh_limit_write(path, "cpu.max", text) == -1 && !(limits->warned & (1 << LIMIT_CPU_MAX))) {
+            sh_limit_warn("cpu.max", errno);
+            limits->warned |= 1 << LIMIT_CPU_MAX;
+        }
+    }
+
+    if (snprintf(procs, sizeof(procs), "%s/cgroup.procs", path) >= (int)sizeof(procs)) {
+        sh_limit_warn(path, ENAMETOOLONG);
+        rmdir(path);
+        return 0;
+    }
+    limits->procs_fd = open(procs, O_WRONLY | O_CLOEXEC);
+    if (limits->procs_fd == -1) {
+        sh_limit_warn(procs, errno);
+        rmdir(path);
+        return 0;
+    }
+    limits->group = strdup(path);
+    return 1;
+}
+
+/******************************************************
+#   sh_limit_set
+#   @desc: puts one rlimit on the calling process
+#   @param: kind - LIMIT_* index of an rlimit
+#   @param: value - the limit
+#   @return: void
+******************************************************/
+static void sh_limit_set(int kind, long long value)
+{
+    int resource = sh_limit_kinds[kind].resource;
+    struct rlimit hard;
+    struct rlimit limit;
+
+    /*The CPU soft limit sends SIGXCPU a second before the hard one kills*/
+    limit.rlim_cur = (rlim_t)value;
+    limit.rlim_max = limit.rlim_cur + (resource == RLIMIT_CPU);
+    if (getrlimit(resource, &hard) == 0 && hard.rlim_max != RLIM_INFINITY
+            && limit.rlim_max > hard.rlim_max) {
+        limit.rlim_max = hard.rlim_max;
+    }
+    if (limit.rlim_cur > limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+    }
+
+    if (setrlimit(resource, &limit) == -1) {
+        sh_limit_warn(sh_limit_kinds[kind].name, errno);
+    }
+}
+
+/******************************************************
+#   sh_limit_attach
+#   @desc: puts the limits on the calling process and
+#       moves it into the job's cgroup. Called in a
+#       forked child before it runs anything, so all it
+#       starts inherits them.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_limit_attach(struct Shell *this_shell)
+{
+    struct Limits *limits = &this_shell->limits;
+    int i;
+
+    for (i = 0; i < LIMIT_COUNT; i++) {
+        if (limits->value[i] != LIMIT_UNSET && sh_limit_kinds[i].resource != -1) {
+            sh_limit_set(i, limits->value[i]);
+        }
+    }
+
+    /*"0" is whoever writes it*/
+    if (limits->procs_fd != -1 && write(limits->procs_fd, "0", 1) == -1) {
+        sh_limit_warn(limits->group, errno);
+    }
+}
+
+/******************************************************
+#   sh_limit_exec_argv
+#   @desc: when the program about to be launched must get
+#       rlimits or join a cgroup, builds the argument
+#       vector that starts the shell as the exec helper
+#       for it instead: LIMIT_EXEC_ARG, the rlimits as
+#       option=value pairs, the cgroup, the program's
+#       path and its own argv
+#   @param: pointer to shell object
+#   @param: path - location of the program
+#   @param: argv - its argument vector
+#   @return: malloc'd vector to launch LIMIT_EXEC_PATH
+#       with, NULL if there is nothing to apply
+******************************************************/
+char** sh_limit_exec_argv(struct Shell *this_shell, const char *path, char **argv)
+{
+    struct Limits *limits = &this_shell->limits;
+    char spec[LIMIT_SPEC];
+    size_t spec_len = 0;
+    char **vector;
+    int argc = 0;
+    int i;
+
+    for (i = 0; i < LIMIT_COUNT; i++) {
+        if (limits->value[i] != LIMIT_UNSET && sh_limit_kinds[i].resource != -1) {
+            spec_len += snprintf(spec + spec_len, sizeof(spec) - spec_len, "%s%c=%lld",
+                    spec_len ? "," : "", sh_limit_kinds[i].option, limits->value[i]);
+        }
+    }
+    if (spec_len == 0 && limits->procs_fd == -1) {
+        return NULL;
+    }
+
+    while (argv[argc] != NULL) {
+        argc++;
+    }
+    /*Vector and the rlimits in one block*/
+    vector = malloc((argc + 6) * sizeof(char*) + spec_len + 1);
+    if (vector == NULL) {
+        return NULL;
+    }
+    memcpy(vector + argc + 6, spec, spec_len + 1);
+
+    vector[0] = argv[0];
+    vector[1] = LIMIT_EXEC_ARG;
+    vector[2] = (char*)(vector + argc + 6);
+    vector[3] = limits->procs_fd != -1 ? limits->group : "";
+    vector[4] = (char*)path;
+    memcpy(vector + 5, argv, (argc + 1) * sizeof(char*));
+    return vector;
+}
+
+/******************************************************
+#   sh_limit_exec
+#   @desc: the exec helper. The shell started with
+#       LIMIT_EXEC_ARG sets the rlimits it was given on
+#       itself, joins the cgroup, then execs the program
+#       in its place, so the program never runs without
+#       them. Does not return.
+#   @param: argc - argument count
+#   @param: argv - vector made by sh_limit_exec_argv
+#   @return: n/a
+******************************************************/
+void sh_limit_exec(int argc, char **argv)
+{
+    char procs[PATH_MAX];
+    const char *spec;
+    int fd;
+
+    if (argc < 6) {
+        _exit(1);
+    }
+
+    for (spec = argv[2]; *spec != '\0'; ) {
+        char *end;
+        long long value;
+        int kind;
+
+        for (kind = 0; kind < LIMIT_COUNT && sh_limit_kinds[kind].option != spec[0]; kind++) {
+        }
+        value = strtoll(spec + 2, &end, 10);
+        if (kind < LIMIT_COUNT && spec[1] == '=' && end != spec + 2) {
+            sh_limit_set(kind, value);
+        }
+        spec = *end == ',' ? end + 1 : end + strlen(end);
+    }
+
+    if (argv[3][0] != '\0') {
+        snprintf(procs, sizeof(procs), "%s/cgroup.procs", argv[3]);
+        fd = open(procs, O_WRONLY | O_CLOEXEC);
+        if (fd == -1 || write(fd, "0", 1) == -1) {
+            sh_limit_warn(argv[3], errno);
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    execv(argv[4], argv + 5);
+    fprintf(stdout, "%s: no such file or directory\n", argv[5]);
+    fflush(stdout);
+    _exit(1);
+}
+
+/******************************************************
+#   sh_limit_take
+#   @desc: hands the cgroup being started to a job that
+#       stays in the job table
+#   @param: pointer to shell object
+#   @return: cgroup directory, NULL if none
+******************************************************/
+char* sh_limit_take(struct Shell *this_shell)
+{
+    struct Limits *limits = &this_shell->limits;
+    char *group = limits->group;
+
+    if (limits->procs_fd != -1) {
+        close(limits->procs_fd);
+    }
+    limits->group = NULL;
+    limits->procs_fd = -1;
+    return group;
+}
+
+/******************************************************
+#   sh_limit_child
+#   @desc: in a subshell that has attached itself, the
+#       limits and cgroup are inherited by everything it
+#       starts, so it must not set or make them again
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_limit_child(struct Shell *this_shell)
+{
+    struct Limits *limits = &this_shell->limits;
+    int i;
+
+    for (i = 0; i < LIMIT_COUNT; i++) {
+        limits->value[i] = LIMIT_UNSET;
+    }
+    limits->nested = limits->group != NULL;
+    sh_limits_free(limits);
+}
+
+/******************************************************
+#   sh_limit_remove
+#   @desc: removes a job's cgroup once its processes are
+#       gone and frees the name. A cgroup something is
+#       still running in stays behind.
+#   @param: group - cgroup directory, may be NULL
+#   @return: void
+******************************************************/
+void sh_limit_remove(char *group)
+{
+    if (group != NULL) {
+        rmdir(group);
+        free(group);
+    }
+}
+
+/******************************************************
+#   sh_limit_end
+#   @desc: removes the cgroup of a job that finished in
+#       the foreground
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_limit_end(struct Shell *this_shell)
+{
+    sh_limit_remove(sh_limit_take(this_shell));
+}
+
+/******************************************************
+#   sh_limit_usage
+#   @desc: memory and CPU a job's cgroup has measured.
+#       cpu.stat is always there; memory.current only
+#       with the memory controller enabled.
+#   @param: group - cgroup directory
+#   @param: memory - receives memory.current in bytes,
+#       -1 if not measured
+#   @param: cpu - receives CPU seconds used
+#   @return: 0 on success, -1 if the cgroup can't be read
+******************************************************/
+int sh_limit_usage(const char *group, long long *memory, double *cpu)
+{
+    char buf[512];
+    const char *usage;
+
+    if (sh_limit_read(group, "cpu.stat", buf, sizeof(buf)) <= 0) {
+        return -1;
+    }
+    usage = strstr(buf, "usage_usec ");
+    *cpu = usage != NULL ? strtoll(usage + 11, NULL, 10) / 1e6 : 0;
+
+    *memory = -1;
+    if (sh_limit_read(group, "memory.current", buf, sizeof(buf)) > 0) {
+        *memory = strtoll(buf, NULL, 10);
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_limit_print
+#   @desc: lists the session's limits
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+static void sh_limit_print(struct Shell *this_shell)
+{
+    const char *root = sh_env_get(&this_shell->env, "SIMPLE_SHELL_CGROUP");
+    char text[32];
+    int i;
+
+    for (i = 0; i < LIMIT_COUNT; i++) {
+        long long value = this_shell->limits.value[i];
+
+        if (value == LIMIT_UNSET) {
+            snprintf(text, sizeof(text), "unlimited");
+        }
+        else if (sh_limit_kinds[i].size) {
+            sh_limit_size(value, text, sizeof(text));
+        }
+        else {
+            snprintf(text, sizeof(text), "%lld", value);
+        }
+        fprintf(stdout, "%-14s -%c  %s\n", sh_limit_kinds[i].name, sh_limit_kinds[i].option, text);
+    }
+    fprintf(stdout, "%-14s     %s\n", "cgroup root", (root != NULL && root[0] != '\0') ? root : "none");
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_limit_command
+#   @desc: limit [-t secs] [-v size] [-n files] [-u procs]
+#       [-m size] [-c percent] [command]. Runs command
+#       with these limits on top of the session's, or
+#       without a command makes them the session's. On
+#       its own lists them.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_limit_command(struct Shell *this_shell)
+{
+    struct Limits *limits = &this_shell->limits;
+    long long saved[LIMIT_COUNT];
+    char **argv = this_shell->arguments;
+    const char *root;
+    int i = 1;
+    int kind;
+
+    memcpy(saved, limits->value, sizeof(saved));
+
+    while (i < this_shell->args_count && argv[i][0] == '-') {
+        for (kind = 0; kind < LIMIT_COUNT; kind++) {
+            if (argv[i][1] == sh_limit_kinds[kind].option && argv[i][2] == '\0') {
+                break;
+            }
+        }
+        if (kind == LIMIT_COUNT || i + 1 >= this_shell->args_count
+                || sh_limit_parse(argv[i + 1], kind, &limits->value[kind]) == -1) {
+            memcpy(limits->value, saved, sizeof(saved));
+            fprintf(stdout, "limit: usage: limit [-t secs] [-v size] [-n files] [-u procs] "
+                    "[-m size] [-c percent] [command]\n");
+            fflush(stdout);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            return;
+        }
+        i += 2;
+    }
+
+    root = sh_env_get(&this_shell->env, "SIMPLE_SHELL_CGROUP");
+    if ((limits->value[LIMIT_MEMORY] != LIMIT_UNSET || limits->value[LIMIT_CPU_MAX] != LIMIT_UNSET)
+            && (root == NULL || root[0] == '\0') && !limits->nested) {
+        fprintf(stdout, "limit: -m and -c need a cgroup: set SIMPLE_SHELL_CGROUP\n");
+        fflush(stdout);
+    }
+
+    /*No command: the values become the session's*/
+    if (i == this_shell->args_count) {
+        if (i == 1) {
+            sh_limit_print(this_shell);
+        }
+        this_shell->status = 0;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*Run the rest of the line with them; & and redirections were already taken*/
+    this_shell->arguments += i;
+    this_shell->args_count -= i;
+    sh_identify_command(this_shell);
+
+    memcpy(limits->value, saved, sizeof(saved));
+}
@@ -0,0 +1,273 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_loop.c
+#   Description: Event loop for the REPL. One epoll set
+#       watches the input, a signalfd carrying SIGCHLD
+#       and SIGINT, and any other descriptor registered
+#       with sh_loop_watch (job output, timerfds). The
+#       shell sleeps in epoll_wait between events instead
+#       of blocking in read or polling for children.
+#
+******************************************************/
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_loop_on_input
+#   @desc: input descriptor is readable: buffer more,
+#       or pass the keys to the line editor
+#   @param: pointer to shell object
+#   @param: fd - input descriptor
+#   @param: data - unused
+#   @return: void
+******************************************************/
+static void sh_loop_on_input(struct Shell *this_shell, int fd, void *data)
+{
+    (void)fd;
+    (void)data;
+    if (this_shell->editor.active) {
+        sh_edit_read(this_shell);
+    }
+    else {
+        sh_input_fill(&this_shell->input);
+    }
+}
+
+/******************************************************
+#   sh_loop_on_signal
+#   @desc: signalfd is readable: record the signals
+#   @param: pointer to shell object
+#   @param: fd - signalfd
+#   @param: data - unused
+#   @return: void
+******************************************************/
+static void sh_loop_on_signal(struct Shell *this_shell, int fd, void *data)
+{
+    (void)fd;
+    (void)data;
+    sh_loop_signals(&this_shell->loop);
+}
+
+/******************************************************
+#   sh_loop_init
+#   @desc: blocks SIGCHLD and SIGINT so they arrive on a
+#       signalfd (for good: jobs get SIGINT through their
+#       own process group, see sh_jobctl.c), creates the
+#       epoll set and watches the input. Regular files and -c strings can't be
+#       watched; they are always ready to read.
+#   @param: pointer to shell object
+#   @return: 0 on success, -1 on failure
+******************************************************/
+int sh_loop_init(struct Shell *this_shell)
+{
+    struct EventLoop *loop = &this_shell->loop;
+
+    loop->child_pending = 0;
+    loop->interrupted = 0;
+    loop->input_watch = NULL;
+    loop->signal_fd = -1;
+
+    loop->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll_fd == -1) {
+        return -1;
+    }
+
+    /*Children are reaped from the loop*/
+    sigemptyset(&loop->signals);
+    sigaddset(&loop->signals, SIGCHLD);
+    sigaddset(&loop->signals, SIGINT);
+    sigprocmask(SIG_BLOCK, &loop->signals, NULL);
+
+    loop->signal_fd = signalfd(-1, &loop->signals, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (loop->signal_fd == -1
+            || sh_loop_watch(this_shell, loop->signal_fd, sh_loop_on_signal, NULL) == NULL) {
+        /*Fall back to ordinary signal delivery*/
+        sigprocmask(SIG_UNBLOCK, &loop->signals, NULL);
+        if (loop->signal_fd != -1) {
+            close(loop->signal_fd);
+            loop->signal_fd = -1;
+        }
+        return -1;
+    }
+
+    if (this_shell->input.fd != -1) {
+        loop->input_watch = sh_loop_watch(this_shell, this_shell->input.fd, sh_loop_on_input, NULL);
+    }
+
+    return 0;
+}
+
+/******************************************************
+#   sh_loop_free
+#   @desc: closes the loop's descriptors
+#   @param: loop - event loop
+#   @return: void
+******************************************************/
+void sh_loop_free(struct EventLoop *loop)
+{
+    if (loop->signal_fd != -1) {
+        close(loop->signal_fd);
+    }
+    if (loop->epoll_fd != -1) {
+        close(loop->epoll_fd);
+    }
+    loop->signal_fd = -1;
+    loop->epoll_fd = -1;
+}
+
+/******************************************************
+#   sh_loop_watch
+#   @desc: calls handler from sh_loop_wait whenever fd
+#       is readable or hung up
+#   @param: pointer to shell object
+#   @param: fd - descriptor to watch
+#   @param: handler - function to call
+#   @param: data - passed through to handler
+#   @return: watch handle, NULL if fd can't be watched
+******************************************************/
+struct EventWatch* sh_loop_watch(struct Shell *this_shell, int fd, EventHandler handler, void *data)
+{
+    struct EventWatch *watch = malloc(sizeof(struct EventWatch));
+    struct epoll_event event;
+
+    if (watch == NULL) {
+        return NULL;
+    }
+    watch->fd = fd;
+    watch->handler = handler;
+    watch->data = data;
+
+    event.events = EPOLLIN;
+    event.data.ptr = watch;
+    if (epoll_ctl(this_shell->loop.epoll_fd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        free(watch);
+        return NULL;
+    }
+
+    return watch;
+}
+
+/******************************************************
+#   sh_loop_unwatch
+#   @desc: stops watching a descriptor. Must be called
+#       before the descriptor is closed.
+#   @param: pointer to shell object
+#   @param: watch - handle from sh_loop_watch
+#   @return: void
+******************************************************/
+void sh_loop_unwatch(struct Shell *this_shell, struct EventWatch *watch)
+{
+    if (watch == NULL) {
+        return;
+    }
+    epoll_ctl(this_shell->loop.epoll_fd, EPOLL_CTL_DEL, watch->fd, NULL);
+    free(watch);
+}
+
+/******************************************************
+#   sh_loop_signals
+#   @desc: drains the signalfd without blocking and sets
+#       child_pending / interrupted for what arrived
+#   @param: loop - event loop
+#   @return: void
+******************************************************/
+void sh_loop_signals(struct EventLoop *loop)
+{
+    struct signalfd_siginfo info[16];
+    ssize_t got;
+    int i;
+
+    /*No signalfd: assume a child may have finished*/
+    if (loop->signal_fd == -1) {
+        loop->child_pending = 1;
+        return;
+    }
+
+    while ((got = read(loop->signal_fd, info, sizeof(info))) > 0) {
+        for (i = 0; i < got / (ssize_t)sizeof(info[0]); i++) {
+            if (info[i].ssi_signo == SIGCHLD) {
+                loop->child_pending = 1;
+            }
+            else if (info[i].ssi_signo == SIGINT) {
+                loop->interrupted = 1;
+            }
+        }
+    }
+}
+
+/******************************************************
+#   sh_loop_wait
+#   @desc: sleeps until at least one watched descriptor
+#       is ready (or timeout) and runs its handlers
+#   @param: pointer to shell object
+#   @param: timeout_ms - -1 waits forever
+#   @return: number of events handled, -1 on error
+******************************************************/
+int sh_loop_wait(struct Shell *this_shell, int timeout_ms)
+{
+    struct epoll_event events[LOOP_MAX_EVENTS];
+    int ready;
+    int i;
+
+    ready = epoll_wait(this_shell->loop.epoll_fd, events, LOOP_MAX_EVENTS, timeout_ms);
+    if (ready == -1) {
+        return errno == EINTR ? 0 : -1;
+    }
+
+    for (i = 0; i < ready; i++) {
+        struct EventWatch *watch = events[i].data.ptr;
+        watch->handler(this_shell, watch->fd, watch->data);
+    }
+
+    return ready;
+}
+
+/******************************************************
+#   sh_loop_block
+#   @desc: sleeps until a signal arrives on the signalfd,
+#       for waits on jobs. Captured output and timers
+#       are served meanwhile; the input is left alone,
+#       it may belong to the job. Needs the signalfd.
+#   @param: pointer to shell object
+#   @param: timeout_ms - longest sleep, -1 for no limit
+#   @return: void
+******************************************************/
+void sh_loop_block(struct Shell *this_shell, int timeout_ms)
+{
+    struct pollfd ready[3];
+    int count = 1;
+    int capture = -1;
+    int timer = -1;
+
+    ready[0].fd = this_shell->loop.signal_fd;
+    ready[0].events = POLLIN;
+    if (this_shell->captures.open > 0) {
+        capture = count;
+        ready[count].fd = this_shell->captures.epoll_fd;
+        ready[count++].events = POLLIN;
+    }
+    if (this_shell->timers.count > 0) {
+        timer = count;
+        ready[count].fd = this_shell->timers.fd;
+        ready[count++].events = POLLIN;
+    }
+
+    if (poll(ready, count, timeout_ms) <= 0) {
+        return;
+    }
+    if (capture != -1 && ready[capture].revents != 0) {
+        sh_capture_ready(this_shell);
+    }
+    if (timer != -1 && ready[timer].revents != 0) {
+        sh_timers_ready(this_shell);
+    }
+    if (ready[0].revents != 0) {
+        sh_loop_signals(&this_shell->loop);
+    }
+}
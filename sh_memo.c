@@ -0,0 +1,518 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_memo.c
+#   Description: memo prefix. Remembers the stdout and
+#       exit value of a command in an on-disk store so
+#       running it again answers from the store without
+#       starting anything. A run is keyed by a hash of
+#       the directory, the words of the command, chosen
+#       variables and the size and mtime of the program
+#       and of every file named on the line. Outputs are
+#       stored content-addressed, under the hash of what
+#       they hold, so commands with the same output share
+#       one copy:
+#           $SIMPLE_SHELL_CACHE/memo/keys/<key>
+#           $SIMPLE_SHELL_CACHE/memo/objects/<hash>
+#       ~/.cache/simple_shell is used when it is unset.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include <sys/sendfile.h>
+
+#include "simple_shell.h"
+
+/*128-bit FNV-1a*/
+typedef unsigned __int128 MemoHash;
+
+
+/******************************************************
+#   sh_memo_start
+#   @desc: FNV-1a 128 offset basis
+#   @param: n/a
+#   @return: empty hash
+******************************************************/
+static MemoHash sh_memo_start()
+{
+    return ((MemoHash)0x6c62272e07bb0142ull << 64) | 0x62b821756295c58dull;
+}
+
+/******************************************************
+#   sh_memo_feed
+#   @desc: adds bytes to a hash. The prime is 2^88 +
+#       0x13b, so multiplying is a shift and a small
+#       product.
+#   @param: hash - hash so far
+#   @param: data - bytes
+#   @param: len - number of bytes
+#   @return: void
+******************************************************/
+static void sh_memo_feed(MemoHash *hash, const void *data, size_t len)
+{
+    const unsigned char *bytes = data;
+    MemoHash value = *hash;
+    size_t i;
+
+    for (i = 0; i < len; i++) {
+        value ^= bytes[i];
+        value = (value << 88) + value * 0x13b;
+    }
+    *hash = value;
+}
+
+/******************************************************
+#   sh_memo_text
+#   @desc: adds a string and its terminator, so "ab" "c"
+#       and "a" "bc" hash differently
+#   @param: hash - hash so far
+#   @param: text - string
+#   @return: void
+******************************************************/
+static void sh_memo_text(MemoHash *hash, const char *text)
+{
+    sh_memo_feed(hash, text, strlen(text) + 1);
+}
+
+/******************************************************
+#   sh_memo_file
+#   @desc: adds what identifies a version of a file: its
+#       path, inode, size and mtime. Names that are not
+#       files add nothing.
+#   @param: hash - hash so far
+#   @param: path - file or directory name
+#   @return: void
+******************************************************/
+static void sh_memo_file(MemoHash *hash, const char *path)
+{
+    struct stat info;
+    long long fields[5];
+
+    if (stat(path, &info) == -1) {
+        return;
+    }
+    fields[0] = info.st_ino;
+    fields[1] = info.st_size;
+    fields[2] = info.st_mtim.tv_sec;
+    fields[3] = info.st_mtim.tv_nsec;
+    fields[4] = info.st_mode;
+    sh_memo_text(hash, path);
+    sh_memo_feed(hash, fields, sizeof(fields));
+}
+
+/******************************************************
+#   sh_memo_hex
+#   @desc: writes a hash as 32 hex digits
+#   @param: hash - hash
+#   @param: out - receives MEMO_HEX bytes
+#   @return: void
+******************************************************/
+static void sh_memo_hex(MemoHash hash, char *out)
+{
+    snprintf(out, MEMO_HEX, "%016llx%016llx", (unsigned long long)(hash >> 64),
+            (unsigned long long)hash);
+}
+
+/******************************************************
+#   sh_memo_path
+#   @desc: names a directory of the store or a file in it
+#   @param: out - receives the path, PATH_MAX bytes
+#   @param: dir - the store
+#   @param: sub - keys or objects
+#   @param: name - file in it, NULL for sub itself
+#   @return: 0 on success, -1 if it does not fit
+******************************************************/
+static int sh_memo_path(char *out, const char *dir, const char *sub, const char *name)
+{
+    int len;
+
+    if (name == NULL) {
+        len = snprintf(out, PATH_MAX, "%s/%s", dir, sub);
+    }
+    else {
+        len = snprintf(out, PATH_MAX, "%s/%s/%s", dir, sub, name);
+    }
+    return (len < 0 || len >= PATH_MAX) ? -1 : 0;
+}
+
+/******************************************************
+#   sh_memo_dir
+#   @desc: finds the store and makes its directories
+#   @param: pointer to shell object
+#   @param: out - receives the store's directory
+#   @param: out_cap - size of out
+#   @return: 0 on success, -1 if there is none
+******************************************************/
+static int sh_memo_dir(struct Shell *this_shell, char *out, size_t out_cap)
+{
+    const char *base = sh_env_get(&this_shell->env, "SIMPLE_SHELL_CACHE");
+    const char *home = sh_env_get(&this_shell->env, "HOME");
+    char path[PATH_MAX];
+    char *slash;
+    int len;
+
+    if (base != NULL && *base != '\0') {
+        len = snprintf(out, out_cap, "%s/memo", base);
+    }
+    else if (home != NULL && *home != '\0') {
+        len = snprintf(out, out_cap, "%s/.cache/simple_shell/memo", home);
+    }
+    else {
+        return -1;
+    }
+    if (len < 0 || (size_t)len + sizeof("/objects/") + MEMO_HEX + 16 >= out_cap) {
+        return -1;
+    }
+
+    /*Every directory on the way, then the two inside*/
+    if (snprintf(path, sizeof(path), "%s/", out) >= (int)sizeof(path)) {
+        return -1;
+    }
+    for (slash = strchr(path + 1, '/'); slash != NULL; slash = strchr(slash + 1, '/')) {
+        *slash = '\0';
+        mkdir(path, 0755);
+        *slash = '/';
+    }
+    if (sh_memo_path(path, out, "keys", NULL) == -1) {
+        return -1;
+    }
+    mkdir(path, 0755);
+    if (sh_memo_path(path, out, "objects", NULL) == -1
+            || (mkdir(path, 0755) == -1 && errno != EEXIST)) {
+        return -1;
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_memo_cacheable
+#   @desc: a command whose stdout goes somewhere else
+#       than the shell's, or that writes a file with |>,
+#       cannot be answered from its output. Neither can
+#       a here-document inside a pipeline, whose text is
+#       not on the line.
+#   @param: pointer to shell object
+#   @return: 1 if it can be memoized, else 0
+******************************************************/
+static int sh_memo_cacheable(struct Shell *this_shell)
+{
+    int i;
+
+    if (this_shell->ground) {
+        return 0;
+    }
+    for (i = 0; i < this_shell->args_count; i++) {
+        const char *word = this_shell->arguments[i];
+        if (word == sh_op_out || word == sh_op_append || word == sh_op_out_to_err || word == sh_op_relay
+                || word == sh_op_heredoc || word == sh_op_heredoc_tab) {
+            return 0;
+        }
+    }
+    for (i = 0; i < this_shell->redirect_count; i++) {
+        const struct Redirect *redirect = &this_shell->redirects[i];
+        if (redirect->fd == 1 && redirect->kind != REDIR_READ) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/******************************************************
+#   sh_memo_key
+#   @desc: hashes what the command's output may depend
+#       on: the directory, its words, the variables
+#       named, the programs it runs and every file named
+#       on the line or in its redirections
+#   @param: pointer to shell object
+#   @param: names - variables, NULL terminated
+#   @param: files - extra files, NULL terminated
+#   @param: out - receives the key in hex
+#   @return: void
+******************************************************/
+static void sh_memo_key(struct Shell *this_shell, const char **names, const char **files, char *out)
+{
+    MemoHash hash = sh_memo_start();
+    char cwd[PATH_MAX];
+    int program = 1;
+    int i;
+
+    sh_memo_text(&hash, "memo 1");
+    if (getcwd(cwd, sizeof(cwd)) != NULL) {
+        sh_memo_text(&hash, cwd);
+    }
+
+    for (; *names != NULL; names++) {
+        const char *value = sh_env_get(&this_shell->env, *names);
+        sh_memo_text(&hash, *names);
+        sh_memo_text(&hash, value != NULL ? value : "");
+        sh_memo_feed(&hash, value != NULL ? "=" : "-", 1);
+    }
+    for (; *files != NULL; files++) {
+        sh_memo_file(&hash, *files);
+    }
+
+    for (i = 0; i < this_shell->args_count; i++) {
+        const char *word = this_shell->arguments[i];
+
+        sh_memo_text(&hash, word);
+        if (sh_is_operator(word)) {
+            program = (word == sh_op_pipe);
+            continue;
+        }
+        /*First word of a stage: the program that runs*/
+        if (program) {
+            const char *path = sh_hash_lookup(&this_shell->path_cache, word);
+            if (path != NULL) {
+                sh_memo_file(&hash, path);
+            }
+            program = 0;
+            continue;
+        }
+        sh_memo_file(&hash, word);
+    }
+
+    for (i = 0; i < this_shell->redirect_count; i++) {
+        const struct Redirect *redirect = &this_shell->redirects[i];
+        sh_memo_feed(&hash, &redirect->fd, sizeof(redirect->fd));
+        sh_memo_feed(&hash, &redirect->kind, sizeof(redirect->kind));
+        if (redirect->kind == REDIR_HEREDOC) {
+            sh_memo_feed(&hash, redirect->body, redirect->body_len);
+        }
+        else if (redirect->word != NULL) {
+            sh_memo_text(&hash, redirect->word);
+            if (redirect->kind == REDIR_READ) {
+                sh_memo_file(&hash, redirect->word);
+            }
+        }
+    }
+
+    sh_memo_hex(hash, out);
+}
+
+/******************************************************
+#   sh_memo_copy
+#   @desc: writes a whole file to the shell's stdout
+#   @param: fd - file
+#   @return: void
+******************************************************/
+static void sh_memo_copy(int fd)
+{
+    char buf[65536];
+    off_t offset = 0;
+    ssize_t got;
+
+    fflush(stdout);
+    while ((got = sendfile(STDOUT_FILENO, fd, &offset, 1 << 20)) > 0) {
+    }
+    if (got == 0) {
+        return;
+    }
+
+    /*sendfile can't write to some outputs, such as files opened to append*/
+    while ((got = pread(fd, buf, sizeof(buf), offset)) > 0) {
+        ssize_t done = 0;
+        while (done < got) {
+            ssize_t put = write(STDOUT_FILENO, buf + done, got - done);
+            if (put <= 0) {
+                return;
+            }
+            done += put;
+        }
+        offset += got;
+    }
+}
+
+/******************************************************
+#   sh_memo_replay
+#   @desc: answers a command from the store
+#   @param: pointer to shell object
+#   @param: dir - the store
+#   @param: key - key of the command
+#   @return: 0 if it was there, -1 if not
+******************************************************/
+static int sh_memo_replay(struct Shell *this_shell, const char *dir, const char *key)
+{
+    char path[PATH_MAX];
+    char object[MEMO_HEX];
+    int status;
+    FILE *entry;
+    int fd;
+
+    if (sh_memo_path(path, dir, "keys", key) == -1) {
+        return -1;
+    }
+    entry = fopen(path, "re");
+    if (entry == NULL) {
+        return -1;
+    }
+    if (fscanf(entry, "%d %32s", &status, object) != 2 || strlen(object) != MEMO_HEX - 1) {
+        fclose(entry);
+        return -1;
+    }
+    fclose(entry);
+
+    if (sh_memo_path(path, dir, "objects", object) == -1) {
+        return -1;
+    }
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return -1;
+    }
+    sh_memo_copy(fd);
+    close(fd);
+
+    this_shell->status = status;
+    this_shell->signaled = 0;
+    return 0;
+}
+
+/******************************************************
+#   sh_memo_store
+#   @desc: files the output under the hash of its bytes
+#       and points the key at it. Both are put in place
+#       whole, by link and rename, so a shell reading
+#       the store at the same time never sees half.
+#   @param: dir - the store
+#   @param: key - key of the command
+#   @param: fd - output, an unnamed file in objects/
+#   @param: status - its exit value
+#   @return: void
+******************************************************/
+static void sh_memo_store(const char *dir, const char *key, int fd, int status)
+{
+    MemoHash hash = sh_memo_start();
+    char buf[65536];
+    char object[MEMO_HEX];
+    char path[PATH_MAX];
+    char tmp[PATH_MAX];
+    char fd_path[64];
+    off_t offset = 0;
+    ssize_t got;
+    FILE *entry;
+
+    while ((got = pread(fd, buf, sizeof(buf), offset)) > 0) {
+        sh_memo_feed(&hash, buf, got);
+        offset += got;
+    }
+    if (got == -1) {
+        return;
+    }
+    sh_memo_hex(hash, object);
+
+    /*Already there when another command printed the same*/
+    if (sh_memo_path(path, dir, "objects", object) == -1) {
+        return;
+    }
+    snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+    if (linkat(AT_FDCWD, fd_path, AT_FDCWD, path, AT_SYMLINK_FOLLOW) == -1 && errno != EEXIST) {
+        return;
+    }
+
+    if (sh_memo_path(path, dir, "keys", key) == -1
+            || snprintf(tmp, sizeof(tmp), "%s.%d", path, (int)getpid()) >= (int)sizeof(tmp)) {
+        return;
+    }
+    entry = fopen(tmp, "we");
+    if (entry == NULL) {
+        return;
+    }
+    fprintf(entry, "%d %s\n", status, object);
+    if (fclose(entry) != 0 || rename(tmp, path) == -1) {
+        unlink(tmp);
+    }
+}
+
+/******************************************************
+#   sh_memo_command
+#   @desc: memo [-e name] [-f file] command. Prints the
+#       stored output and sets the stored exit value if
+#       the command ran before with the same key, else
+#       runs it with its stdout in a file and stores
+#       that. -e adds a variable to the key (PATH is
+#       always in it), -f a file the command reads that
+#       is not named on the line. Runs that end by a
+#       signal or with a status over 127 are not kept.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_memo_command(struct Shell *this_shell)
+{
+    char **argv = this_shell->arguments;
+    int argc = this_shell->args_count;
+    const char *names[MEMO_LIST + 2] = { "PATH", NULL };
+    const char *files[MEMO_LIST + 1] = { NULL };
+    int name_count = 1;
+    int file_count = 0;
+    char dir[PATH_MAX];
+    char objects[PATH_MAX];
+    char key[MEMO_HEX];
+    int next_id;
+    int saved;
+    int fd;
+    int i = 1;
+
+    while (i < argc - 1 && argv[i][0] == '-') {
+        if (strcmp(argv[i], "-e") == 0 && name_count < MEMO_LIST + 1) {
+            names[name_count++] = argv[i + 1];
+            names[name_count] = NULL;
+        }
+        else if (strcmp(argv[i], "-f") == 0 && file_count < MEMO_LIST) {
+            files[file_count++] = argv[i + 1];
+            files[file_count] = NULL;
+        }
+        else {
+            break;
+        }
+        i += 2;
+    }
+    if (i >= argc || argv[i][0] == '-') {
+        fprintf(stdout, "memo: usage: memo [-e name] [-f file] command\n");
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*Drop the options; & and redirections were already taken*/
+    this_shell->arguments += i;
+    this_shell->args_count -= i;
+
+    /*Can't be answered from the store: just run it*/
+    if (!sh_memo_cacheable(this_shell) || sh_memo_dir(this_shell, dir, sizeof(dir)) == -1) {
+        sh_identify_command(this_shell);
+        return;
+    }
+
+    sh_memo_key(this_shell, names, files, key);
+    if (sh_memo_replay(this_shell, dir, key) == 0) {
+        return;
+    }
+
+    /*Unnamed until it is complete*/
+    fd = sh_memo_path(objects, dir, "objects", NULL) == -1
+        ? -1 : open(objects, O_TMPFILE | O_RDWR | O_CLOEXEC, 0644);
+    fflush(stdout);
+    saved = fd == -1 ? -1 : fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, REDIRECT_FDS);
+    if (saved == -1) {
+        if (fd != -1) {
+            close(fd);
+        }
+        sh_identify_command(this_shell);
+        return;
+    }
+
+    next_id = this_shell->jobs.next_id;
+    dup2(fd, STDOUT_FILENO);
+    sh_identify_command(this_shell);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    /*A stopped job goes on writing to it*/
+    if (!this_shell->signaled && this_shell->status < 128 && this_shell->timed_out == 0
+            && this_shell->jobs.next_id == next_id) {
+        sh_memo_store(dir, key, fd, this_shell->status);
+    }
+    sh_memo_copy(fd);
+    close(fd);
+}
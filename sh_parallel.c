@@ -0,0 +1,583 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_parallel.c
+#   Description: parallel builtin. Runs one command per
+#       argument with at most N children in flight,
+#       starting the next as each finishes. Children are
+#       tracked in the background job table and reaped by
+#       sh_catch_bg; each one's stdout and stderr are
+#       collected from pipes through the event loop and
+#       printed in one piece when it finishes, so lines
+#       never interleave. CTRL-C stops further launches.
+#
+#       parallel [-j N] cmd [args] ::: arg...
+#       parallel [-j N] cmd [args] :::: file
+#       parallel [-j N] cmd [args] < file   (args on stdin)
+#
+******************************************************/
+#define _GNU_SOURCE
+#include "simple_shell.h"
+
+
+/*Output of a child collected from one pipe*/
+struct ParallelOutput
+{
+    int fd; /*read end of the pipe, -1 at EOF*/
+    struct EventWatch *watch; /*loop watch on fd*/
+    char *text; /*collected bytes*/
+    size_t len; /*bytes in text*/
+    size_t cap; /*size of text*/
+};
+
+/*One child of the parallel builtin*/
+struct ParallelJob
+{
+    pid_t pid; /*child, 0 if slot is free*/
+    int exited; /*1 once reaped*/
+    int status; /*status from waitpid*/
+    struct ParallelOutput output[2]; /*its stdout and stderr*/
+    char *block; /*argv and its strings, one allocation*/
+};
+
+
+/******************************************************
+#   sh_parallel_on_output
+#   @desc: loop handler: appends what the child wrote to
+#       its buffer and closes the pipe at EOF
+#   @param: pointer to shell object
+#   @param: fd - output pipe
+#   @param: data - the ParallelOutput
+#   @return: void
+******************************************************/
+static void sh_parallel_on_output(struct Shell *this_shell, int fd, void *data)
+{
+    struct ParallelOutput *output = data;
+    ssize_t got;
+
+    if (output->cap - output->len < PARALLEL_READ) {
+        size_t cap = output->cap ? output->cap * 2 : PARALLEL_READ * 2;
+        char *bigger = realloc(output->text, cap);
+        if (bigger == NULL) {
+            return;
+        }
+        output->text = bigger;
+        output->cap = cap;
+    }
+
+    got = read(fd, output->text + output->len, output->cap - output->len);
+    if (got > 0) {
+        output->len += got;
+        return;
+    }
+    if (got == -1 && (errno == EINTR || errno == EAGAIN)) {
+        return;
+    }
+
+    /*EOF: child and everything it started are done writing*/
+    sh_loop_unwatch(this_shell, output->watch);
+    output->watch = NULL;
+    close(fd);
+    output->fd = -1;
+}
+
+/******************************************************
+#   sh_parallel_pipe
+#   @desc: makes the pipe one of a child's outputs goes
+#       to, watched by the event loop
+#   @param: pointer to shell object
+#   @param: output - output to collect
+#   @return: write end for the child, -1 if none
+******************************************************/
+static int sh_parallel_pipe(struct Shell *this_shell, struct ParallelOutput *output)
+{
+    int pipe_fds[2];
+
+    output->len = 0;
+    output->fd = -1;
+    output->watch = NULL;
+
+    if (pipe2(pipe_fds, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    output->watch = sh_loop_watch(this_shell, pipe_fds[0], sh_parallel_on_output, output);
+    if (output->watch == NULL) {
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        return -1;
+    }
+    output->fd = pipe_fds[0];
+    return pipe_fds[1];
+}
+
+/******************************************************
+#   sh_parallel_unpipe
+#   @desc: stops collecting an output early
+#   @param: pointer to shell object
+#   @param: output - output being collected
+#   @return: void
+******************************************************/
+static void sh_parallel_unpipe(struct Shell *this_shell, struct ParallelOutput *output)
+{
+    if (output->fd != -1) {
+        sh_loop_unwatch(this_shell, output->watch);
+        close(output->fd);
+        output->watch = NULL;
+        output->fd = -1;
+    }
+}
+
+/******************************************************
+#   sh_parallel_on_done
+#   @desc: job table handler: records the child's status
+#       instead of printing a background notice
+#   @param: pointer to shell object
+#   @param: pid - finished child
+#   @param: status - status from waitpid
+#   @param: data - the ParallelJob
+#   @return: void
+******************************************************/
+static void sh_parallel_on_done(struct Shell *this_shell, pid_t pid, int status, void *data)
+{
+    struct ParallelJob *job = data;
+
+    (void)this_shell;
+    (void)pid;
+    job->exited = 1;
+    job->status = status;
+}
+
+/******************************************************
+#   sh_parallel_argv
+#   @desc: builds the argv for one input by replacing {}
+#       in each template word, or appending the input
+#       when no word has {}. Strings and vector share
+#       one malloc'd block stored in job->block.
+#   @param: job - job receiving the block
+#   @param: template - command words
+#   @param: template_count - number of words
+#   @param: input - argument for this job
+#   @return: argv, NULL if out of memory
+******************************************************/
+static char** sh_parallel_argv(struct ParallelJob *job, char **template, int template_count, const char *input)
+{
+    size_t input_len = strlen(input);
+    size_t text = 0;
+    int has_slot = 0;
+    int argc;
+    char **argv;
+    char *out;
+    int i;
+
+    /*Size every word after substitution*/
+    for (i = 0; i < template_count; i++) {
+        const char *word = template[i];
+        const char *hit;
+        text += strlen(word) + 1;
+        for (hit = strstr(word, "{}"); hit != NULL; hit = strstr(hit + 2, "{}")) {
+            text += input_len;
+            has_slot = 1;
+        }
+    }
+    argc = has_slot ? template_count : template_count + 1;
+    if (!has_slot) {
+        text += input_len + 1;
+    }
+
+    job->block = malloc((argc + 1) * sizeof(char*) + text);
+    if (job->block == NULL) {
+        return NULL;
+    }
+    argv = (char**)job->block;
+    out = job->block + (argc + 1) * sizeof(char*);
+
+    for (i = 0; i < template_count; i++) {
+        const char *word = template[i];
+        argv[i] = out;
+        while (*word != '\0') {
+            if (word[0] == '{' && word[1] == '}') {
+                memcpy(out, input, input_len);
+                out += input_len;
+                word += 2;
+            }
+            else {
+                *out++ = *word++;
+            }
+        }
+        *out++ = '\0';
+    }
+    if (!has_slot) {
+        argv[i] = out;
+        memcpy(out, input, input_len + 1);
+    }
+    argv[argc] = NULL;
+
+    return argv;
+}
+
+/******************************************************
+#   sh_parallel_start
+#   @desc: launches the command for one input with its
+#       stdout and stderr on pipes watched by the event
+#       loop and registers it in the job table
+#   @param: pointer to shell object
+#   @param: job - free job slot
+#   @param: template - command words
+#   @param: template_count - number of words
+#   @param: input - argument for this job
+#   @return: 0 on success, -1 if the launch failed
+******************************************************/
+static int sh_parallel_start(struct Shell *this_shell, struct ParallelJob *job,
+        char **template, int template_count, const char *input)
+{
+    char **argv = sh_parallel_argv(job, template, template_count, input);
+    struct Redirect err;
+    int out_fd;
+    int status;
+    int slot;
+
+    if (argv == NULL) {
+        return -1;
+    }
+
+    job->exited = 0;
+    job->status = 0;
+
+    /*Collect output through the loop if we can*/
+    out_fd = sh_parallel_pipe(this_shell, &job->output[0]);
+    err.op = sh_op_err;
+    err.fd = 2;
+    err.kind = REDIR_WRITE;
+    err.word = NULL;
+    err.body = NULL;
+    err.body_len = 0;
+    err.source = sh_parallel_pipe(this_shell, &job->output[1]);
+
+    job->pid = sh_execute_command(this_shell, argv, -1, out_fd, &err, err.source != -1, -1);
+    if (out_fd != -1) {
+        close(out_fd);
+    }
+    if (err.source != -1) {
+        close(err.source);
+    }
+
+    /*Reaped by sh_catch_bg like any background job*/
+    slot = job->pid > 0 ? sh_job_add(&this_shell->jobs, job->pid, 0) : -1;
+    if (slot == -1) {
+        /*Nothing would reap it: don't leave it running*/
+        if (job->pid > 0) {
+            kill(job->pid, SIGKILL);
+            while (waitpid(job->pid, &status, 0) == -1 && errno == EINTR) {
+            }
+        }
+        job->pid = 0;
+        sh_parallel_unpipe(this_shell, &job->output[0]);
+        sh_parallel_unpipe(this_shell, &job->output[1]);
+        free(job->block);
+        job->block = NULL;
+        return -1;
+    }
+    this_shell->jobs.jobs[slot].on_done = sh_parallel_on_done;
+    this_shell->jobs.jobs[slot].data = job;
+
+    return 0;
+}
+
+/******************************************************
+#   sh_parallel_finish
+#   @desc: prints a finished job's stdout and stderr,
+#       each in one piece, and frees its slot
+#   @param: job - finished job
+#   @return: 1 if the job failed, 0 otherwise
+******************************************************/
+static int sh_parallel_finish(struct ParallelJob *job)
+{
+    int failed = !WIFEXITED(job->status) || WEXITSTATUS(job->status) != 0;
+
+    if (job->output[0].len > 0) {
+        fwrite(job->output[0].text, 1, job->output[0].len, stdout);
+        fflush(stdout);
+    }
+    if (job->output[1].len > 0) {
+        fwrite(job->output[1].text, 1, job->output[1].len, stderr);
+        fflush(stderr);
+    }
+
+    free(job->block);
+    job->block = NULL;
+    job->pid = 0;
+
+    return failed;
+}
+
+/******************************************************
+#   sh_parallel_read_inputs
+#   @desc: reads one input per line from fd into a
+#       malloc'd buffer and splits it in place
+#   @param: fd - descriptor to read
+#   @param: buf - receives the buffer to free
+#   @param: count - receives number of inputs
+#   @return: malloc'd array of inputs, NULL on failure
+******************************************************/
+static char** sh_parallel_read_inputs(int fd, char **buf, int *count)
+{
+    size_t len = 0;
+    size_t cap = PARALLEL_READ;
+    char *text = malloc(cap);
+    char **inputs;
+    ssize_t got;
+    int lines = 0;
+    size_t i;
+
+    *buf = NULL;
+    *count = 0;
+    if (text == NULL) {
+        return NULL;
+    }
+
+    while (1) {
+        if (cap - len < PARALLEL_READ) {
+            char *bigger = realloc(text, cap * 2);
+            if (bigger == NULL) {
+                free(text);
+                return NULL;
+            }
+            text = bigger;
+            cap *= 2;
+        }
+        got = read(fd, text + len, cap - len - 1);
+        if (got == -1 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        len += got;
+    }
+    text[len] = '\0';
+
+    for (i = 0; i < len; i++) {
+        if (text[i] == '\n') {
+            lines++;
+        }
+    }
+    inputs = malloc((lines + 1) * sizeof(char*));
+    if (inputs == NULL) {
+        free(text);
+        return NULL;
+    }
+
+    /*Split at newlines, skipping empty lines*/
+    lines = 0;
+    for (i = 0; i < len; ) {
+        size_t start = i;
+        while (i < len && text[i] != '\n') {
+            i++;
+        }
+        text[i++] = '\0';
+        if (text[start] != '\0') {
+            inputs[lines++] = text + start;
+        }
+    }
+
+    *buf = text;
+    *count = lines;
+    return inputs;
+}
+
+/******************************************************
+#   sh_parallel_stdin
+#   @desc: inputs come from stdin when the command
+#       redirected it, or when the shell was handed a
+#       pipe or file it isn't reading its own commands
+#       from; never from a terminal or the rest of a script
+#   @param: pointer to shell object
+#   @return: 1 if inputs can be read from stdin, else 0
+******************************************************/
+static int sh_parallel_stdin(struct Shell *this_shell)
+{
+    int i;
+
+    for (i = 0; i < this_shell->redirect_count; i++) {
+        if (this_shell->redirects[i].fd == 0) {
+            return 1;
+        }
+    }
+    return this_shell->input.fd != 0 && !isatty(0);
+}
+
+/******************************************************
+#   sh_parallel_usage
+#   @desc: reports a bad command line
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+static void sh_parallel_usage(struct Shell *this_shell)
+{
+    fprintf(stdout, "parallel: usage: parallel [-j N] command [args] ::: inputs\n");
+    fflush(stdout);
+    this_shell->status = 1;
+    this_shell->signaled = 0;
+}
+
+/******************************************************
+#   sh_parallel_command
+#   @desc: parallel builtin. Keeps up to N commands
+#       running, prints each one's output when it ends
+#       and sets the status to the number of failed
+#       jobs (101 means more than 100 failed).
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_parallel_command(struct Shell *this_shell)
+{
+    char **args = this_shell->arguments;
+    int argc = this_shell->args_count;
+    long max_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+    char **template;
+    int template_count = 0;
+    char **inputs = NULL;
+    int input_count = 0;
+    char *input_buf = NULL;
+    char **input_list = NULL;
+    struct ParallelJob *jobs;
+    int next_input = 0;
+    int running = 0;
+    int failed = 0;
+    int interrupted = 0;
+    int i = 1;
+    int j;
+
+    if (max_jobs < 1) {
+        max_jobs = 1;
+    }
+    /*-j N or -jN*/
+    if (i < argc && strncmp(args[i], "-j", 2) == 0) {
+        const char *value = args[i][2] != '\0' ? args[i] + 2 : (i + 1 < argc ? args[++i] : "");
+        char *end;
+        max_jobs = strtol(value, &end, 10);
+        if (*end != '\0' || end == value || max_jobs < 1) {
+            sh_parallel_usage(this_shell);
+            return;
+        }
+        i++;
+    }
+
+    /*Command words run up to ::: or ::::*/
+    template = &args[i];
+    while (i < argc && strcmp(args[i], ":::") != 0 && strcmp(args[i], "::::") != 0) {
+        template_count++;
+        i++;
+    }
+
+    if (i < argc && strcmp(args[i], ":::") == 0) {
+        inputs = &args[i + 1];
+        input_count = argc - i - 1;
+    }
+    else {
+        int fd = 0;
+        /*:::: file, or stdin when it was redirected*/
+        if (i < argc) {
+            if (i + 1 >= argc) {
+                fd = -1;
+            }
+            else if (strcmp(args[i + 1], "-") != 0) {
+                fd = open(args[i + 1], O_RDONLY | O_CLOEXEC);
+            }
+        }
+        else if (!sh_parallel_stdin(this_shell)) {
+            fd = -1;
+        }
+        if (fd == -1) {
+            fprintf(stdout, "parallel: no inputs (use ::: args or :::: file)\n");
+            fflush(stdout);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            return;
+        }
+        input_list = sh_parallel_read_inputs(fd, &input_buf, &input_count);
+        inputs = input_list;
+        if (fd != 0) {
+            close(fd);
+        }
+    }
+
+    if (template_count == 0) {
+        free(input_list);
+        free(input_buf);
+        sh_parallel_usage(this_shell);
+        return;
+    }
+
+    if (max_jobs > input_count && input_count > 0) {
+        max_jobs = input_count;
+    }
+    jobs = calloc(max_jobs, sizeof(struct ParallelJob));
+    if (jobs == NULL) {
+        free(input_list);
+        free(input_buf);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*Children are foreground work: CTRL-C reaches them*/
+    this_shell->ground = 0;
+
+    while (next_input < input_count || running > 0) {
+
+        /*CTRL-C: let the running ones end, start no more*/
+        if (this_shell->loop.interrupted) {
+            this_shell->loop.interrupted = 0;
+            interrupted = 1;
+            failed += input_count - next_input;
+            next_input = input_count;
+        }
+
+        /*Fill every free slot*/
+        for (j = 0; j < max_jobs && next_input < input_count; j++) {
+            if (jobs[j].pid != 0) {
+                continue;
+            }
+            if (sh_parallel_start(this_shell, &jobs[j], template, template_count, inputs[next_input++]) == 0) {
+                running++;
+            }
+            else {
+                failed++;
+            }
+        }
+
+        if (running == 0) {
+            break;
+        }
+
+        /*Sleep until output, a finished child or a signal*/
+        sh_loop_wait(this_shell, this_shell->loop.signal_fd == -1 ? 100 : -1);
+        sh_catch_bg(this_shell);
+
+        for (j = 0; j < max_jobs; j++) {
+            if (jobs[j].pid != 0 && jobs[j].exited && jobs[j].output[0].fd == -1 && jobs[j].output[1].fd == -1) {
+                failed += sh_parallel_finish(&jobs[j]);
+                running--;
+            }
+        }
+    }
+
+    for (j = 0; j < max_jobs; j++) {
+        free(jobs[j].output[0].text);
+        free(jobs[j].output[1].text);
+    }
+    free(jobs);
+    free(input_list);
+    free(input_buf);
+
+    /*Stop the rest of the line as CTRL-C would*/
+    if (interrupted) {
+        this_shell->status = SIGINT;
+        this_shell->signaled = 1;
+        return;
+    }
+    this_shell->status = failed > 100 ? 101 : failed;
+    this_shell->signaled = 0;
+}
@@ -0,0 +1,528 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_parse.c
+#   Description: Command line tokenizer. Splits a line
+#       into words on any run of blanks, handling single
+#       quotes, double quotes, backslash escapes,
+#       comments, $parameter expansion and control
+#       operators. Lines are compiled: parameters are
+#       left as markers to expand when the command runs
+#       and words are flagged for expansion and globbing.
+#       Words and the argument vector are carved out of
+#       the shell's per-command arena, so a parse does no
+#       heap allocation once the arena has grown to fit
+#       the longest line seen.
+#
+******************************************************/
+#include "simple_shell.h"
+
+/*Control operators. Unquoted operators are emitted as
+  words pointing at these strings, so callers compare
+  pointers and quoted text like "|" never matches.*/
+const char sh_op_pipe[] = "|";
+const char sh_op_relay[] = "|>";
+const char sh_op_in[] = "<";
+const char sh_op_out[] = ">";
+const char sh_op_append[] = ">>";
+const char sh_op_err[] = "2>";
+const char sh_op_err_append[] = "2>>";
+const char sh_op_err_to_out[] = "2>&1";
+const char sh_op_out_to_err[] = ">&2";
+const char sh_op_herestring[] = "<<<";
+const char sh_op_heredoc[] = "<<";
+const char sh_op_heredoc_tab[] = "<<-";
+const char sh_op_and[] = "&&";
+const char sh_op_or[] = "||";
+const char sh_op_background[] = "&";
+const char sh_op_semicolon[] = ";";
+const char sh_op_open[] = "(";
+const char sh_op_close[] = ")";
+
+/*Longest match first*/
+static const char *const sh_operators[] = {
+    sh_op_or, sh_op_relay, sh_op_pipe,
+    sh_op_and, sh_op_background, sh_op_semicolon, sh_op_open, sh_op_close,
+    sh_op_herestring, sh_op_heredoc_tab, sh_op_heredoc, sh_op_in,
+    sh_op_err_to_out, sh_op_err_append, sh_op_err,
+    sh_op_out_to_err, sh_op_append, sh_op_out,
+    NULL
+};
+
+/*Characters an operator can start with*/
+static const char sh_op_chars[] = "|&;()<>2";
+
+
+/******************************************************
+#   sh_is_operator
+#   @desc: tells whether a parsed word is a control
+#       operator rather than ordinary text
+#   @param: word - word from sh_tokenize
+#   @return: 1 if word is an operator, 0 otherwise
+******************************************************/
+int sh_is_operator(const char *word)
+{
+    return sh_operator_index(word) != -1;
+}
+
+/******************************************************
+#   sh_operator_index
+#   @desc: numbers an operator, so compiled lines can be
+#       stored without pointers
+#   @param: word - word from sh_tokenize
+#   @return: index for sh_operator_word, -1 if word is
+#       not an operator
+******************************************************/
+int sh_operator_index(const char *word)
+{
+    int i;
+
+    for (i = 0; sh_operators[i] != NULL; i++) {
+        if (word == sh_operators[i]) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/******************************************************
+#   sh_operator_word
+#   @desc: operator numbered by sh_operator_index
+#   @param: index - operator number
+#   @return: operator word, NULL if index is out of range
+******************************************************/
+const char* sh_operator_word(int index)
+{
+    int count = (int)(sizeof(sh_operators) / sizeof(sh_operators[0])) - 1;
+
+    return (index >= 0 && index < count) ? sh_operators[index] : NULL;
+}
+
+/******************************************************
+#   sh_match_operator
+#   @desc: finds the operator starting at cur. Operators
+#       that start with a descriptor number (2>) only
+#       count at the start of a word, so file2>x is the
+#       word file2 and then >.
+#   @param: cur - position in the line
+#   @param: end - end of the line
+#   @param: word_start - 1 if cur begins a new word
+#   @return: operator string, NULL if none starts here
+******************************************************/
+static const char* sh_match_operator(const char *cur, const char *end, int word_start)
+{
+    int i;
+
+    /*Quick reject for ordinary characters*/
+    if (*cur == '\0' || strchr(sh_op_chars, *cur) == NULL) {
+        return NULL;
+    }
+    if (!word_start && *cur >= '0' && *cur <= '9') {
+        return NULL;
+    }
+
+    for (i = 0; sh_operators[i] != NULL; i++) {
+        size_t op_len = strlen(sh_operators[i]);
+        if ((size_t)(end - cur) >= op_len && memcmp(cur, sh_operators[i], op_len) == 0) {
+            return sh_operators[i];
+        }
+    }
+    return NULL;
+}
+
+/******************************************************
+#   sh_is_blank
+#   @desc: word separators
+#   @param: c - character
+#   @return: 1 if c separates words, 0 otherwise
+******************************************************/
+static int sh_is_blank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+/******************************************************
+#   sh_param_name
+#   @desc: reads the parameter name after a '$': NAME,
+#       {NAME}, or one of ? $ !
+#   @param: cur - character after the '$'
+#   @param: end - end of the line
+#   @param: name - receives the start of the name
+#   @param: name_len - receives the length of the name
+#   @return: characters used after the '$', 0 if the
+#       '$' is an ordinary character
+******************************************************/
+static size_t sh_param_name(const char *cur, const char *end, const char **name, size_t *name_len)
+{
+    const char *start = cur;
+    int braced = 0;
+
+    if (cur < end && *cur == '{') {
+        braced = 1;
+        cur++;
+    }
+    *name = cur;
+
+    if (cur < end && (*cur == '?' || *cur == '$' || *cur == '!')) {
+        cur++;
+    }
+    else {
+        while (cur < end && ((*cur >= 'a' && *cur <= 'z') || (*cur >= 'A' && *cur <= 'Z')
+                    || *cur == '_' || (cur > *name && *cur >= '0' && *cur <= '9'))) {
+            cur++;
+        }
+    }
+    *name_len = cur - *name;
+    if (*name_len == 0) {
+        return 0;
+    }
+
+    if (braced) {
+        if (cur == end || *cur != '}') {
+            return 0;
+        }
+        cur++;
+    }
+    return cur - start;
+}
+
+/*Characters escaped in a word that is globbed, when they came
+  from quotes, and the markers of $parameters in a compiled word*/
+static const char sh_escaped_chars[] = "*?[]\\" "\001\002\003";
+
+/******************************************************
+#   sh_put_literal
+#   @desc: writes a character that must match itself.
+#       While compiling, pattern characters and marker
+#       bytes get a backslash so the glob and expansion
+#       treat them literally; the backslashes are taken
+#       out again if the word turns out to need neither.
+#   @param: out - where the word is being written
+#   @param: c - character
+#   @param: compiling - 1 if words may be patterns
+#   @param: escaped - set to 1 when a backslash is added
+#   @return: new end of the word
+******************************************************/
+static char* sh_put_literal(char *out, char c, int compiling, int *escaped)
+{
+    if (compiling && c != '\0' && strchr(sh_escaped_chars, c) != NULL) {
+        *out++ = '\\';
+        *escaped = 1;
+    }
+    *out++ = c;
+    return out;
+}
+
+/******************************************************
+#   sh_put_param
+#   @desc: writes a $parameter reference into a compiled
+#       word as a marker byte, the name and PARAM_END.
+#       A '$' not followed by a name is copied as is.
+#   @param: cur - in: character after the '$', out: past
+#       the name
+#   @param: end - end of the line
+#   @param: out - where the word is being written
+#   @param: in_quotes - 1 inside double quotes
+#   @param: params - set to 1 when a reference is written
+#   @return: new end of the word
+******************************************************/
+static char* sh_put_param(const char **cur, const char *end, char *out, int in_quotes, int *params)
+{
+    const char *name;
+    size_t name_len;
+    size_t used = sh_param_name(*cur, end, &name, &name_len);
+
+    if (used == 0) {
+        *out++ = '$';
+        return out;
+    }
+    *cur += used;
+
+    *out++ = in_quotes ? PARAM_QUOTED : PARAM_UNQUOTED;
+    memcpy(out, name, name_len);
+    out += name_len;
+    *out++ = PARAM_END;
+    *params = 1;
+    return out;
+}
+
+/******************************************************
+#   sh_unescape
+#   @desc: removes the backslashes sh_tokenize put before
+#       literal pattern characters, in place
+#   @param: word - word to clean
+#   @return: void
+******************************************************/
+void sh_unescape(char *word)
+{
+    char *out = word;
+
+    for (; *word != '\0'; word++) {
+        if (*word == '\\' && word[1] != '\0') {
+            word++;
+        }
+        *out++ = *word;
+    }
+    *out = '\0';
+}
+
+/******************************************************
+#   sh_expand_word
+#   @desc: expands the $parameters of a compiled word.
+#       Values outside double quotes can hold a pattern,
+#       as in other shells. A word that is a pattern
+#       keeps its literal pattern characters escaped for
+#       sh_glob_expand; any other word comes out as
+#       plain text.
+#   @param: pointer to shell object
+#   @param: word - word flagged WORD_PARAM by sh_tokenize
+#   @param: glob - in: 1 if the word has unquoted * ? [,
+#       out: 1 if the expanded word is a pattern
+#   @return: expanded word in the arena, NULL if out of
+#       memory
+******************************************************/
+char* sh_expand_word(struct Shell *this_shell, const char *word, int *glob)
+{
+    char number[24];
+    const char *cur;
+    const char *value;
+    const char *name;
+    char *result;
+    char *out;
+    size_t size = strlen(word) + 1;
+    int escaped = 0;
+
+    /*Values may double in size when escaped*/
+    for (cur = word; *cur != '\0'; cur++) {
+        if (*cur == '\\' && cur[1] != '\0') {
+            cur++;
+        }
+        else if (*cur == PARAM_UNQUOTED || *cur == PARAM_QUOTED) {
+            name = cur + 1;
+            cur = strchr(name, PARAM_END);
+            value = sh_env_param(this_shell, name, cur - name, number);
+            size += value ? 2 * strlen(value) : 0;
+        }
+    }
+
+    result = sh_arena_alloc(&this_shell->arena, size);
+    if (result == NULL) {
+        return NULL;
+    }
+
+    out = result;
+    for (cur = word; *cur != '\0'; cur++) {
+        int in_quotes = (*cur == PARAM_QUOTED);
+
+        if (*cur == '\\' && cur[1] != '\0') {
+            /*Already escaped while compiling*/
+            *out++ = *cur++;
+            *out++ = *cur;
+            escaped = 1;
+        }
+        else if (*cur == PARAM_UNQUOTED || *cur == PARAM_QUOTED) {
+            name = cur + 1;
+            cur = strchr(name, PARAM_END);
+            value = sh_env_param(this_shell, name, cur - name, number);
+            for (; value != NULL && *value != '\0'; value++) {
+                if (!in_quotes && (*value == '*' || *value == '?' || *value == '[')) {
+                    *glob = 1;
+                    *out++ = *value;
+                }
+                else {
+                    out = sh_put_literal(out, *value, 1, &escaped);
+                }
+            }
+        }
+        else {
+            *out++ = *cur;
+        }
+    }
+    *out = '\0';
+
+    /*Not a pattern after all*/
+    if (!*glob && escaped) {
+        sh_unescape(result);
+    }
+    return result;
+}
+
+/******************************************************
+#   sh_tokenize
+#   @desc: splits line into words. Every word uses at
+#       least one input char and ends at a separator, so
+#       the text needs at most len + 1 bytes (twice that
+#       while compiling, for escapes and parameter
+#       markers) and the vector at most len + 1 slots;
+#       both are reserved up front in the arena in one
+#       go. When flags are asked for, the words are
+#       compiled for sh_expand_word and sh_glob_expand:
+#       $NAME, ${NAME}, $?, $$ and $! outside single
+#       quotes become markers expanded when the command
+#       runs, literal pattern characters are escaped, and
+#       each word gets its WORD_* flags.
+#   @param: arena - per-command arena
+#   @param: line - input line (need not be terminated)
+#   @param: len - number of bytes in line
+#   @param: argv_out - receives NULL terminated vector
+#   @param: argc_out - receives number of words
+#   @param: flags_out - receives the WORD_* flags of each
+#       word, NULL to leave '$' and patterns alone
+#   @return: PARSE_OK, PARSE_UNTERMINATED or PARSE_NOMEM
+******************************************************/
+int sh_tokenize(struct Arena *arena, const char *line, size_t len, char ***argv_out, int *argc_out,
+        unsigned char **flags_out)
+{
+    const char *cur = line;
+    const char *end = line + len;
+    char **argv;
+    unsigned char *flags = NULL;
+    char *out;
+    const char *op;
+    int argc = 0;
+    int compiling = (flags_out != NULL);
+    int quoted;
+    int glob;
+    int params;
+    int escaped;
+    size_t size = len + 1;
+
+    *argv_out = NULL;
+    *argc_out = 0;
+
+    if (compiling) {
+        size *= 2;
+        flags = sh_arena_alloc(arena, len + 2);
+        if (flags == NULL) {
+            return PARSE_NOMEM;
+        }
+        memset(flags, 0, len + 2);
+        *flags_out = NULL;
+    }
+
+    argv = sh_arena_alloc(arena, (len + 2) * sizeof(char*));
+    out = sh_arena_alloc(arena, size);
+    if (argv == NULL || out == NULL) {
+        return PARSE_NOMEM;
+    }
+
+    while (cur < end) {
+
+        /*Strip whitespace*/
+        while (cur < end && sh_is_blank(*cur)) {
+            cur++;
+        }
+        if (cur == end) {
+            break;
+        }
+
+        /*Comment runs to the end of the line*/
+        if (*cur == '#') {
+            break;
+        }
+
+        /*Operators are words of their own*/
+        op = sh_match_operator(cur, end, 1);
+        if (op != NULL) {
+            argv[argc++] = (char*)op;
+            cur += strlen(op);
+            continue;
+        }
+
+        /*Save the argument*/
+        argv[argc++] = out;
+        quoted = 0;
+        glob = 0;
+        params = 0;
+        escaped = 0;
+
+        /*Copy the word, dropping quotes and escapes*/
+        while (cur < end && !sh_is_blank(*cur) && sh_match_operator(cur, end, 0) == NULL) {
+            char c = *cur++;
+
+            if (c == '$' && compiling) {
+                out = sh_put_param(&cur, end, out, 0, &params);
+            }
+            else if (c == '\\') {
+                if (cur == end) {
+                    break;
+                }
+                /*Backslash newline joins lines*/
+                if (*cur != '\n') {
+                    quoted = 1;
+                    out = sh_put_literal(out, *cur, compiling, &escaped);
+                }
+                cur++;
+            }
+            else if (c == '\'') {
+                quoted = 1;
+                while (cur < end && *cur != '\'') {
+                    out = sh_put_literal(out, *cur++, compiling, &escaped);
+                }
+                if (cur == end) {
+                    return PARSE_UNTERMINATED;
+                }
+                cur++;
+            }
+            else if (c == '"') {
+                quoted = 1;
+                while (cur < end && *cur != '"') {
+                    /*Only these are special inside double quotes*/
+                    if (*cur == '$' && compiling) {
+                        cur++;
+                        out = sh_put_param(&cur, end, out, 1, &params);
+                    }
+                    else if (*cur == '\\' && cur + 1 < end
+                            && (cur[1] == '"' || cur[1] == '\\' || cur[1] == '$'
+                                || cur[1] == '`' || cur[1] == '\n')) {
+                        if (cur[1] != '\n') {
+                            out = sh_put_literal(out, cur[1], compiling, &escaped);
+                        }
+                        cur += 2;
+                    }
+                    else {
+                        out = sh_put_literal(out, *cur++, compiling, &escaped);
+                    }
+                }
+                if (cur == end) {
+                    return PARSE_UNTERMINATED;
+                }
+                cur++;
+            }
+            else {
+                if (c == '*' || c == '?' || c == '[') {
+                    glob = compiling;
+                }
+                /*Only marker bytes need escaping here*/
+                out = sh_put_literal(out, c, compiling && c >= PARAM_UNQUOTED && c <= PARAM_END, &escaped);
+            }
+        }
+
+        /*Backslash newline on its own leaves no word*/
+        if (out == argv[argc - 1] && !quoted) {
+            argc--;
+            continue;
+        }
+        *out++ = '\0';
+
+        if (!compiling) {
+            continue;
+        }
+        flags[argc - 1] = (glob ? WORD_GLOB : 0) | (params ? WORD_PARAM : 0) | (quoted ? WORD_QUOTED : 0);
+
+        /*Nothing left to do when it runs*/
+        if (!glob && !params && escaped) {
+            sh_unescape(argv[argc - 1]);
+        }
+    }
+
+    argv[argc] = NULL;
+    *argv_out = argv;
+    *argc_out = argc;
+    if (compiling) {
+        *flags_out = flags;
+    }
+
+    return PARSE_OK;
+}
@@ -0,0 +1,395 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_pipeline.c
+#   Description: Pipelines. Runs a | b | c with every
+#       stage started at once in a single process group
+#       and waits for them as one job. A |> file stage
+#       is a relay that copies the stream into file and
+#       passes it on using tee(2)/splice(2), so the data
+#       never passes through a userspace buffer.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_has_pipeline
+#   @desc: tells whether the command contains | or |>
+#   @param: pointer to shell object
+#   @return: 1 if the command is a pipeline, 0 otherwise
+******************************************************/
+int sh_has_pipeline(struct Shell *this_shell)
+{
+    int i;
+
+    for (i = 0; i < this_shell->args_count; i++) {
+        char *word = this_shell->arguments[i];
+        if (word == sh_op_pipe || word == sh_op_relay) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_split_pipeline
+#   @desc: cuts the argument list into stages at each
+#       operator. Stage vectors point into the shell's
+#       arguments, which get NULLs where operators were,
+#       and each stage's redirections are taken out.
+#   @param: pointer to shell object
+#   @param: stages - receives arena array of stages
+#   @param: stage_count - receives number of stages
+#   @return: 0 on success, -1 on a syntax error
+******************************************************/
+static int sh_split_pipeline(struct Shell *this_shell, struct PipeStage **stages, int *stage_count)
+{
+    char **args = this_shell->arguments;
+    int argc = this_shell->args_count;
+    struct PipeStage *list;
+    int count = 0;
+    int start = 0;
+    int stage_argc;
+    int i;
+
+    /*Never more stages than words*/
+    list = sh_arena_alloc(&this_shell->arena, (argc + 1) * sizeof(struct PipeStage));
+    if (list == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i <= argc; i++) {
+        char *word = args[i];
+
+        if (word != NULL && word != sh_op_pipe && word != sh_op_relay) {
+            continue;
+        }
+
+        /*Every command stage needs a command*/
+        if (i == start) {
+            return -1;
+        }
+        args[i] = NULL;
+        stage_argc = i - start;
+        list[count].argv = &args[start];
+        list[count].relay_file = NULL;
+        if (sh_redirect_extract(this_shell, list[count].argv, &stage_argc,
+                    &list[count].redirects, &list[count].redirect_count) == -1
+                || stage_argc == 0) {
+            return -1;
+        }
+        count++;
+
+        if (word == sh_op_relay) {
+            /*|> takes a file name*/
+            if (i + 1 >= argc || sh_is_operator(args[i + 1])) {
+                return -1;
+            }
+            list[count].argv = NULL;
+            list[count].relay_file = args[i + 1];
+            list[count].redirects = NULL;
+            list[count].redirect_count = 0;
+            count++;
+            i++;
+
+            /*Relay ends the pipeline or is followed by |*/
+            if (i + 1 == argc) {
+                break;
+            }
+            if (args[i + 1] != sh_op_pipe) {
+                return -1;
+            }
+            i++;
+            args[i] = NULL;
+        }
+
+        if (word != NULL) {
+            start = i + 1;
+            /*Pipe with nothing after it*/
+            if (start >= argc) {
+                return -1;
+            }
+        }
+    }
+
+    *stages = list;
+    *stage_count = count;
+    return 0;
+}
+
+/******************************************************
+#   sh_relay_copy
+#   @desc: moves len bytes from in_fd to out_fd through
+#       a buffer, for descriptors splice can't handle
+#   @param: in_fd - source
+#   @param: out_fd - destination, -1 to discard
+#   @param: len - bytes to move, 0 means until EOF
+#   @return: 0 on success, -1 on error
+******************************************************/
+static int sh_relay_copy(int in_fd, int out_fd, size_t len)
+{
+    char buf[8192];
+    int until_eof = (len == 0);
+
+    while (until_eof || len > 0) {
+        size_t want = (!until_eof && len < sizeof(buf)) ? len : sizeof(buf);
+        ssize_t got = read(in_fd, buf, want);
+        ssize_t done = 0;
+
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            return got == 0 ? 0 : -1;
+        }
+        while (out_fd != -1 && done < got) {
+            ssize_t put = write(out_fd, buf + done, got - done);
+            if (put <= 0) {
+                return -1;
+            }
+            done += put;
+        }
+        if (!until_eof) {
+            len -= got;
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_relay
+#   @desc: duplicates the stream from in_fd into out_fd
+#       with tee(), then moves the same bytes into the
+#       file with splice(). Falls back to a copy loop
+#       when a descriptor doesn't support it.
+#   @param: in_fd - read end of a pipe
+#   @param: out_fd - next stage (pipe) or stdout
+#   @param: file_fd - file being teed into
+#   @return: void
+******************************************************/
+static void sh_relay(int in_fd, int out_fd, int file_fd)
+{
+    int can_tee = 1;
+
+    while (1) {
+        ssize_t teed;
+        ssize_t left;
+
+        if (can_tee) {
+            teed = tee(in_fd, out_fd, RELAY_CHUNK, 0);
+            if (teed == 0) {
+                return;
+            }
+            if (teed < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                /*out_fd is not a pipe*/
+                can_tee = 0;
+                continue;
+            }
+
+            /*Consume the teed bytes into the file*/
+            left = teed;
+            while (left > 0) {
+                ssize_t moved = splice(in_fd, NULL, file_fd, NULL, left, SPLICE_F_MOVE);
+                if (moved <= 0) {
+                    if (moved < 0 && errno == EINTR) {
+                        continue;
+                    }
+                    if (sh_relay_copy(in_fd, file_fd, left) == -1) {
+                        return;
+                    }
+                    break;
+                }
+                left -= moved;
+            }
+        }
+        else {
+            /*Without tee both copies need the bytes in hand*/
+            char buf[8192];
+            ssize_t got = read(in_fd, buf, sizeof(buf));
+            if (got <= 0) {
+                if (got < 0 && errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            if (write(out_fd, buf, got) != got || write(file_fd, buf, got) != got) {
+                return;
+            }
+        }
+    }
+}
+
+/******************************************************
+#   sh_start_relay
+#   @desc: forks a helper that runs sh_relay for a |>
+#       stage inside the pipeline's process group, with
+#       the job's limits and cgroup
+#   @param: pointer to shell object
+#   @param: in_fd - read end of the previous stage's pipe
+#   @param: out_fd - next stage's pipe, -1 for stdout
+#   @param: file - file to tee into
+#   @param: pgid - pipeline group, 0 to start one, -1
+#       to stay in the shell's group
+#   @return: pid of the helper, -1 on failure
+******************************************************/
+static pid_t sh_start_relay(struct Shell *this_shell, int in_fd, int out_fd, const char *file, pid_t pgid)
+{
+    int file_fd = open(file, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0664);
+    pid_t relay_PID;
+
+    if (file_fd == -1) {
+        fprintf(stdout, "simple_shell: cannot open %s for output\n", file);
+        fflush(stdout);
+        return -1;
+    }
+
+    fflush(stdout);
+    relay_PID = fork();
+
+    if (relay_PID == 0) {
+        /*In relay helper*/
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        signal(SIGINT, SIG_DFL);
+        signal(SIGTSTP, SIG_DFL);
+        signal(SIGTTIN, SIG_DFL);
+        signal(SIGTTOU, SIG_DFL);
+        if (pgid != -1) {
+            setpgid(0, pgid);
+        }
+        sh_limit_attach(this_shell);
+        sh_relay(in_fd, out_fd == -1 ? 1 : out_fd, file_fd);
+        _exit(0);
+    }
+
+    /*Set the group from both sides to avoid a race*/
+    if (relay_PID > 0 && pgid != -1) {
+        setpgid(relay_PID, pgid == 0 ? relay_PID : pgid);
+    }
+    close(file_fd);
+
+    return relay_PID;
+}
+
+/******************************************************
+#   sh_pipeline_process
+#   @desc: connects the stages with pipes, starts them
+#       all in one process group (the shell's, without
+#       job control in the foreground) and waits for the
+#       job (foreground) or reports its pid (background)
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_pipeline_process(struct Shell *this_shell)
+{
+    struct PipeStage *stages;
+    int stage_count;
+    int prev_read = -1;
+    pid_t pgid = sh_job_pgid(this_shell);
+    pid_t last_PID = -1;
+    pid_t *pids;
+    int started = 0;
+    int capturing = 0;
+    int i;
+
+    if (sh_split_pipeline(this_shell, &stages, &stage_count) == -1) {
+        fprintf(stdout, "simple_shell: syntax error in pipeline\n");
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    pids = sh_arena_alloc(&this_shell->arena, stage_count * sizeof(pid_t));
+    if (pids == NULL) {
+        fprintf(stdout, "simple_shell: out of memory\n");
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*A background job's output can go to a ring buffer*/
+    if (this_shell->ground == 1) {
+        capturing = sh_capture_begin(this_shell);
+    }
+
+    for (i = 0; i < stage_count; i++) {
+        int pipe_fds[2] = { -1, -1 };
+        pid_t child_PID;
+
+        /*Every stage but the last writes into a pipe*/
+        if (i < stage_count - 1 && pipe2(pipe_fds, O_CLOEXEC) == -1) {
+            fprintf(stdout, "simple_shell: pipe failed\n");
+            fflush(stdout);
+            break;
+        }
+
+        if (stages[i].argv != NULL) {
+            child_PID = -1;
+            if (sh_redirect_open(stages[i].redirects, stages[i].redirect_count) == 0) {
+                child_PID = sh_execute_command(this_shell, stages[i].argv, prev_read, pipe_fds[1],
+                        stages[i].redirects, stages[i].redirect_count, pgid);
+                sh_redirect_close(stages[i].redirects, stages[i].redirect_count);
+            }
+        }
+        else {
+            child_PID = sh_start_relay(this_shell, prev_read, pipe_fds[1], stages[i].relay_file, pgid);
+        }
+
+        if (child_PID > 0) {
+            if (pgid == 0) {
+                pgid = child_PID;
+            }
+            pids[started++] = child_PID;
+        }
+        if (i == stage_count - 1) {
+            last_PID = child_PID;
+        }
+
+        /*Parent keeps only the read end for the next stage*/
+        if (prev_read != -1) {
+            close(prev_read);
+        }
+        if (pipe_fds[1] != -1) {
+            close(pipe_fds[1]);
+        }
+        prev_read = pipe_fds[0];
+    }
+
+    if (prev_read != -1) {
+        close(prev_read);
+    }
+    if (capturing) {
+        sh_capture_end(this_shell, last_PID > 0);
+    }
+
+    if (started == 0) {
+        return;
+    }
+
+    if (this_shell->ground == 1) {
+        /*Track the last stage like a single bg command*/
+        if (last_PID > 0) {
+            printf("background pid is %d\n", last_PID);
+            this_shell->last_bg = last_PID;
+            fflush(stdout);
+            sh_job_started(this_shell, last_PID, pgid);
+        }
+    }
+    else {
+        sh_wait_fg(this_shell, pgid, pids, started);
+        /*Status is the last stage's, which didn't start*/
+        if (last_PID <= 0) {
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+        }
+    }
+}
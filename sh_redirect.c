@@ -0,0 +1,428 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_redirect.c
+#   Description: Redirection lists. Redirection words
+#       anywhere in a command are pulled out of its argv
+#       into a list, the files are opened by the shell,
+#       and the list is applied in one pass: as spawn
+#       file actions for programs, or by swapping the
+#       shell's own descriptors around an in-process
+#       builtin. Here-docs and here-strings are handed
+#       over in a memfd (or a pipe), never a temp file.
+#
+******************************************************/
+#define _GNU_SOURCE
+#include <sys/mman.h>
+
+#include "simple_shell.h"
+
+
+/*What each redirection operator does*/
+struct RedirectOp
+{
+    const char *op; /*operator word from the tokenizer*/
+    int fd; /*descriptor it redirects*/
+    int kind; /*REDIR_* */
+    int dup_fd; /*source for REDIR_DUP*/
+};
+
+static const struct RedirectOp sh_redirect_ops[] = {
+    { sh_op_in,          0, REDIR_READ,    -1 },
+    { sh_op_out,         1, REDIR_WRITE,   -1 },
+    { sh_op_append,      1, REDIR_APPEND,  -1 },
+    { sh_op_err,         2, REDIR_WRITE,   -1 },
+    { sh_op_err_append,  2, REDIR_APPEND,  -1 },
+    { sh_op_err_to_out,  2, REDIR_DUP,      1 },
+    { sh_op_out_to_err,  1, REDIR_DUP,      2 },
+    { sh_op_herestring,  0, REDIR_STRING,  -1 },
+    { sh_op_heredoc,     0, REDIR_HEREDOC, -1 },
+    { sh_op_heredoc_tab, 0, REDIR_HEREDOC, -1 },
+    { NULL, 0, 0, 0 }
+};
+
+
+/******************************************************
+#   sh_redirect_find
+#   @desc: looks up a word in the redirection operators
+#   @param: word - word from sh_tokenize
+#   @return: operator entry, NULL if word isn't one
+******************************************************/
+static const struct RedirectOp* sh_redirect_find(const char *word)
+{
+    int i;
+
+    for (i = 0; sh_redirect_ops[i].op != NULL; i++) {
+        if (word == sh_redirect_ops[i].op) {
+            return &sh_redirect_ops[i];
+        }
+    }
+    return NULL;
+}
+
+/******************************************************
+#   sh_redirect_words
+#   @desc: tells how many words a redirection uses
+#   @param: word - word from sh_tokenize
+#   @return: 2 for an operator and its file, string or
+#       delimiter, 1 for a duplication, 0 if word is not
+#       a redirection
+******************************************************/
+int sh_redirect_words(const char *word)
+{
+    const struct RedirectOp *op = sh_redirect_find(word);
+
+    if (op == NULL) {
+        return 0;
+    }
+    return op->kind == REDIR_DUP ? 1 : 2;
+}
+
+/******************************************************
+#   sh_redirect_heredoc
+#   @desc: reads here-doc lines from the shell's input up
+#       to the delimiter and keeps them in an arena. Done
+#       once when the line is compiled.
+#   @param: pointer to shell object
+#   @param: arena - where the body is kept
+#   @param: delim - delimiter line
+#   @param: strip_tabs - 1 for <<-, drops leading tabs
+#   @param: body - receives the text
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+int sh_redirect_heredoc(struct Shell *this_shell, struct Arena *arena, const char *delim, int strip_tabs,
+        char **body)
+{
+    size_t delim_len = strlen(delim);
+    char *text = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+
+    while (sh_get_line(this_shell, "> ") == 1) {
+        const char *line = this_shell->user_input;
+        size_t line_len = this_shell->input_len;
+
+        /*Line comes with its newline, except at end of input*/
+        if (line_len > 0 && line[line_len - 1] == '\n') {
+            line_len--;
+        }
+        if (strip_tabs) {
+            while (line_len > 0 && *line == '\t') {
+                line++;
+                line_len--;
+            }
+        }
+        if (line_len == delim_len && memcmp(line, delim, delim_len) == 0) {
+            break;
+        }
+
+        if (len + line_len + 1 > cap) {
+            char *grown;
+            cap = (len + line_len + 1) * 2;
+            grown = realloc(text, cap);
+            if (grown == NULL) {
+                free(text);
+                return -1;
+            }
+            text = grown;
+        }
+        memcpy(text + len, line, line_len);
+        len += line_len;
+        text[len++] = '\n';
+    }
+
+    /*Body lives as long as the compiled line*/
+    *body = sh_arena_alloc(arena, len + 1);
+    if (*body == NULL) {
+        free(text);
+        return -1;
+    }
+    if (len > 0) {
+        memcpy(*body, text, len);
+    }
+    (*body)[len] = '\0';
+    free(text);
+
+    return 0;
+}
+
+/******************************************************
+#   sh_redirect_extract
+#   @desc: removes redirection operators and their words
+#       from argv and returns them as a list, in order.
+#       The word after a here-doc operator is its body,
+#       read when the line was compiled.
+#   @param: pointer to shell object
+#   @param: argv - NULL terminated words, compacted
+#   @param: argc - number of words, updated
+#   @param: list - receives arena array of redirections
+#   @param: count - receives number of redirections
+#   @return: 0 on success, -1 on a syntax error
+******************************************************/
+int sh_redirect_extract(struct Shell *this_shell, char **argv, int *argc, struct Redirect **list, int *count)
+{
+    const struct RedirectOp *op;
+    struct Redirect *redirects = NULL;
+    int found = 0;
+    int kept = 0;
+    int i;
+
+    *list = NULL;
+    *count = 0;
+
+    for (i = 0; i < *argc; i++) {
+        op = sh_redirect_find(argv[i]);
+
+        if (op == NULL) {
+            argv[kept++] = argv[i];
+            continue;
+        }
+
+        /*At most one redirection per remaining word*/
+        if (redirects == NULL) {
+            redirects = sh_arena_alloc(&this_shell->arena, (*argc - i) * sizeof(struct Redirect));
+            if (redirects == NULL) {
+                return -1;
+            }
+        }
+
+        redirects[found].op = op->op;
+        redirects[found].fd = op->fd;
+        redirects[found].kind = op->kind;
+        redirects[found].source = op->dup_fd;
+        redirects[found].word = NULL;
+        redirects[found].body = NULL;
+        redirects[found].body_len = 0;
+
+        if (op->kind != REDIR_DUP) {
+            /*Needs a file name, string or delimiter*/
+            if (i + 1 >= *argc || sh_is_operator(argv[i + 1])) {
+                return -1;
+            }
+            redirects[found].word = argv[++i];
+        }
+
+        if (op->kind == REDIR_HEREDOC) {
+            redirects[found].body = redirects[found].word;
+            redirects[found].body_len = strlen(redirects[found].word);
+        }
+        found++;
+    }
+
+    argv[kept] = NULL;
+    *argc = kept;
+    *list = redirects;
+    *count = found;
+    return 0;
+}
+
+/******************************************************
+#   sh_redirect_text
+#   @desc: makes a descriptor whose contents are text,
+#       for here-docs and here-strings. A memfd holds any
+#       size; without memfd a pipe is sized to fit.
+#   @param: text - contents
+#   @param: len - length of text
+#   @return: readable descriptor at offset 0, -1 on error
+******************************************************/
+static int sh_redirect_text(const char *text, size_t len)
+{
+    int fd = memfd_create("simple_shell-heredoc", MFD_CLOEXEC);
+    int pipe_fds[2];
+    size_t done = 0;
+
+    if (fd != -1) {
+        while (done < len) {
+            ssize_t put = write(fd, text + done, len - done);
+            if (put <= 0) {
+                close(fd);
+                return -1;
+            }
+            done += put;
+        }
+        lseek(fd, 0, SEEK_SET);
+        return fd;
+    }
+
+    /*Everything must fit in the pipe before the reader starts*/
+    if (pipe2(pipe_fds, O_CLOEXEC) == -1) {
+        return -1;
+    }
+    if (len > PIPE_BUF) {
+        fcntl(pipe_fds[1], F_SETPIPE_SZ, (int)len);
+    }
+    fcntl(pipe_fds[1], F_SETFL, O_NONBLOCK);
+    while (done < len) {
+        ssize_t put = write(pipe_fds[1], text + done, len - done);
+        if (put <= 0) {
+            break;
+        }
+        done += put;
+    }
+    close(pipe_fds[1]);
+    return pipe_fds[0];
+}
+
+/******************************************************
+#   sh_redirect_open
+#   @desc: opens every file, here-doc and here-string in
+#       the list. Descriptors are moved above the ones
+#       being redirected so applying the list in order
+#       never overwrites a source still to be used.
+#   @param: list - redirections
+#   @param: count - number of redirections
+#   @return: 0 on success, -1 after printing the error
+******************************************************/
+int sh_redirect_open(struct Redirect *list, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        struct Redirect *redirect = &list[i];
+        int fd = -1;
+        char *text;
+
+        switch (redirect->kind) {
+            case REDIR_READ:
+                fd = open(redirect->word, O_RDONLY | O_CLOEXEC);
+                break;
+            case REDIR_WRITE:
+                fd = open(redirect->word, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0664);
+                break;
+            case REDIR_APPEND:
+                fd = open(redirect->word, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0664);
+                break;
+            case REDIR_STRING:
+                /*Here-string gets a trailing newline*/
+                text = malloc(strlen(redirect->word) + 2);
+                if (text != NULL) {
+                    sprintf(text, "%s\n", redirect->word);
+                    fd = sh_redirect_text(text, strlen(text));
+                    free(text);
+                }
+                break;
+            case REDIR_HEREDOC:
+                fd = sh_redirect_text(redirect->body, redirect->body_len);
+                break;
+            default:
+                /*Duplications have nothing to open*/
+                continue;
+        }
+
+        if (fd != -1 && fd < REDIRECT_FDS) {
+            int moved = fcntl(fd, F_DUPFD_CLOEXEC, REDIRECT_FDS);
+            close(fd);
+            fd = moved;
+        }
+
+        if (fd == -1) {
+            fprintf(stdout, "simple_shell: cannot open %s for %s\n",
+                    redirect->kind == REDIR_HEREDOC ? "here-document" : redirect->word,
+                    redirect->fd == 0 ? "input" : "output");
+            fflush(stdout);
+            /*Undo the ones already opened*/
+            sh_redirect_close(list, i);
+            return -1;
+        }
+        redirect->source = fd;
+    }
+
+    return 0;
+}
+
+/******************************************************
+#   sh_redirect_close
+#   @desc: closes the descriptors sh_redirect_open made
+#   @param: list - redirections
+#   @param: count - number of redirections
+#   @return: void
+******************************************************/
+void sh_redirect_close(struct Redirect *list, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        if (list[i].kind != REDIR_DUP && list[i].source != -1) {
+            close(list[i].source);
+            list[i].source = -1;
+        }
+    }
+}
+
+/******************************************************
+#   sh_redirect_actions
+#   @desc: adds the list to spawn file actions. The
+#       child applies it in order after exec setup.
+#   @param: actions - spawn file actions
+#   @param: list - opened redirections
+#   @param: count - number of redirections
+#   @return: void
+******************************************************/
+void sh_redirect_actions(posix_spawn_file_actions_t *actions, const struct Redirect *list, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        posix_spawn_file_actions_adddup2(actions, list[i].source, list[i].fd);
+    }
+}
+
+/******************************************************
+#   sh_redirect_push
+#   @desc: applies the list to the shell itself for an
+#       in-process builtin, saving what it replaces
+#   @param: list - opened redirections
+#   @param: count - number of redirections
+#   @param: saved - REDIRECT_FDS slots, filled for pop
+#   @return: void
+******************************************************/
+void sh_redirect_push(const struct Redirect *list, int count, int *saved)
+{
+    int i;
+
+    for (i = 0; i < REDIRECT_FDS; i++) {
+        saved[i] = -1;
+    }
+
+    /*Anything buffered belongs to the old stdout*/
+    fflush(stdout);
+
+    for (i = 0; i < count; i++) {
+        int fd = list[i].fd;
+
+        if (saved[fd] == -1) {
+            saved[fd] = fcntl(fd, F_DUPFD_CLOEXEC, REDIRECT_FDS);
+            /*fd was closed: close it again on pop*/
+            if (saved[fd] == -1) {
+                saved[fd] = -2;
+            }
+        }
+        dup2(list[i].source, fd);
+    }
+}
+
+/******************************************************
+#   sh_redirect_pop
+#   @desc: puts back the descriptors sh_redirect_push
+#       replaced
+#   @param: saved - slots filled by sh_redirect_push
+#   @return: void
+******************************************************/
+void sh_redirect_pop(int *saved)
+{
+    int fd;
+
+    fflush(stdout);
+
+    for (fd = 0; fd < REDIRECT_FDS; fd++) {
+        if (saved[fd] >= 0) {
+            dup2(saved[fd], fd);
+            close(saved[fd]);
+        }
+        else if (saved[fd] == -2) {
+            close(fd);
+        }
+        saved[fd] = -1;
+    }
+}
@@ -0,0 +1,150 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_retry.c
+#   Description: retry prefix. Runs the rest of the
+#       line through the usual launch and wait path and
+#       runs it again, after a growing pause, for as long
+#       as the status it leaves is a failure. CTRL-C ends
+#       the retrying.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_retry_sleep
+#   @desc: pauses between attempts. Background jobs are
+#       still reaped and their output drained meanwhile.
+#   @param: pointer to shell object
+#   @param: seconds - length of the pause
+#   @return: 0 when it has passed, -1 if interrupted
+******************************************************/
+static int sh_retry_sleep(struct Shell *this_shell, double seconds)
+{
+    struct EventLoop *loop = &this_shell->loop;
+    double end = sh_usage_now() + seconds;
+    double left;
+
+    if (loop->signal_fd == -1) {
+        struct timespec pause;
+        pause.tv_sec = (time_t)seconds;
+        pause.tv_nsec = (long)((seconds - pause.tv_sec) * 1e9);
+        return nanosleep(&pause, NULL) == 0 ? 0 : -1;
+    }
+
+    while ((left = end - sh_usage_now()) > 0) {
+        sh_loop_block(this_shell, (int)(left * 1000) + 1);
+        if (loop->interrupted) {
+            loop->interrupted = 0;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_retry_command
+#   @desc: retry [-n tries] [--backoff exp|fixed]
+#       [-d delay] [-m max] command. Runs command up to
+#       tries times (3) until it exits 0, pausing delay
+#       (1s) after the first failure and, with exp
+#       backoff, twice as long after each one after
+#       that, up to max (60s). Its status is the last
+#       attempt's. A command that is interrupted, stops
+#       or goes to the background is not run again.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_retry_command(struct Shell *this_shell)
+{
+    char **argv = this_shell->arguments;
+    int argc = this_shell->args_count;
+    long tries = RETRY_TRIES;
+    double delay = RETRY_DELAY;
+    double most = RETRY_MAX_DELAY;
+    int exponential = 1;
+    double pause;
+    long attempt;
+    int i = 1;
+
+    while (i < argc - 1 && argv[i][0] == '-') {
+        char *end;
+        if (strcmp(argv[i], "-n") == 0) {
+            tries = strtol(argv[i + 1], &end, 10);
+            if (*end != '\0' || tries < 1) {
+                break;
+            }
+        }
+        else if (strcmp(argv[i], "--backoff") == 0) {
+            if (strcmp(argv[i + 1], "exp") == 0) {
+                exponential = 1;
+            }
+            else if (strcmp(argv[i + 1], "fixed") == 0) {
+                exponential = 0;
+            }
+            else {
+                break;
+            }
+        }
+        else if (strcmp(argv[i], "-d") == 0) {
+            if (sh_duration_parse(argv[i + 1], &delay) == -1) {
+                break;
+            }
+        }
+        else if (strcmp(argv[i], "-m") == 0) {
+            if (sh_duration_parse(argv[i + 1], &most) == -1) {
+                break;
+            }
+        }
+        else {
+            break;
+        }
+        i += 2;
+    }
+    if (i >= argc || argv[i][0] == '-') {
+        fprintf(stdout, "retry: usage: retry [-n tries] [--backoff exp|fixed] [-d delay] [-m max] command\n");
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    pause = delay > most ? most : delay;
+    for (attempt = 1; ; attempt++) {
+        int next_id = this_shell->jobs.next_id;
+
+        /*Drop the options; & and redirections were already taken*/
+        this_shell->arguments = argv + i;
+        this_shell->args_count = argc - i;
+        sh_identify_command(this_shell);
+
+        if (this_shell->status == 0 && !this_shell->signaled) {
+            break;
+        }
+        /*Sent to the background or stopped: nothing to decide on*/
+        if (this_shell->ground || this_shell->jobs.next_id != next_id) {
+            break;
+        }
+        if ((this_shell->signaled && this_shell->status == SIGINT) || this_shell->loop.interrupted) {
+            break;
+        }
+        if (attempt >= tries) {
+            break;
+        }
+
+        fprintf(stdout, "retry: attempt %ld of %ld failed (%s %d), next in %gs\n", attempt, tries,
+                this_shell->signaled ? "signal" : "exit value", this_shell->status, pause);
+        fflush(stdout);
+        if (sh_retry_sleep(this_shell, pause) == -1) {
+            break;
+        }
+        if (exponential) {
+            pause = pause * 2 > most ? most : pause * 2;
+        }
+    }
+
+    this_shell->arguments = argv;
+    this_shell->args_count = argc;
+}
@@ -0,0 +1,663 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_source.c
+#   Description: The source builtin and its script cache.
+#       A script is compiled line by line into the same
+#       node arrays typed lines use and kept, keyed by
+#       the file's identity, mtime and size, so sourcing
+#       it again runs the compiled lines straight away.
+#       With $SIMPLE_SHELL_CACHE set to a directory the
+#       compiled form is also written there as one flat
+#       file (offsets instead of pointers) that a new
+#       shell maps and runs without tokenizing.
+#
+******************************************************/
+#include <sys/mman.h>
+
+#include "simple_shell.h"
+
+#define SCRIPT_FILE_MAGIC "SHAST001"
+#define SCRIPT_FILE_OPERATOR 0x80000000u /*word is operator number, not offset*/
+
+/*Start of a script cache file*/
+struct ScriptFileHeader
+{
+    char magic[8];
+    int64_t size; /*script size it was compiled from*/
+    int64_t mtime_sec; /*script mtime it was compiled from*/
+    int64_t mtime_nsec;
+    uint32_t path_len; /*script path that follows, padded to 8*/
+    uint32_t line_count;
+    uint32_t node_count;
+    uint32_t word_count;
+    uint32_t pool_len; /*bytes of word text at the end*/
+    uint32_t reserved;
+};
+
+/*One compiled line in a cache file*/
+struct ScriptFileLine
+{
+    int32_t root;
+    int32_t error;
+    int32_t near;
+    uint32_t first_node;
+    uint32_t node_count;
+    uint32_t first_word;
+    uint32_t word_count;
+};
+
+/*After the header and path: lines, nodes, word offsets,
+  word flags (padded to 4) and the text of the words*/
+
+
+/******************************************************
+#   sh_source_align
+#   @desc: rounds a file offset up
+#   @param: n - offset
+#   @param: to - power of two
+#   @return: rounded offset
+******************************************************/
+static size_t sh_source_align(size_t n, size_t to)
+{
+    return (n + to - 1) & ~(to - 1);
+}
+
+/******************************************************
+#   sh_source_clear
+#   @desc: frees a compiled script and empties its slot
+#   @param: script - script to free
+#   @return: void
+******************************************************/
+static void sh_source_clear(struct Script *script)
+{
+    free(script->path);
+    free(script->lines);
+    sh_arena_free(&script->arena);
+    if (script->map != NULL) {
+        munmap(script->map, script->map_len);
+    }
+    memset(script, 0, sizeof(*script));
+}
+
+/******************************************************
+#   sh_scripts_init
+#   @desc: empties the script cache
+#   @param: cache - script cache
+#   @return: void
+******************************************************/
+void sh_scripts_init(struct ScriptCache *cache)
+{
+    memset(cache, 0, sizeof(*cache));
+}
+
+/******************************************************
+#   sh_scripts_free
+#   @desc: frees every compiled script
+#   @param: cache - script cache
+#   @return: void
+******************************************************/
+void sh_scripts_free(struct ScriptCache *cache)
+{
+    int i;
+
+    for (i = 0; i < SCRIPT_CACHE_SIZE; i++) {
+        if (cache->scripts[i].path != NULL) {
+            sh_source_clear(&cache->scripts[i]);
+        }
+    }
+}
+
+/******************************************************
+#   sh_source_add_line
+#   @desc: makes room for one more line
+#   @param: script - script being filled
+#   @param: cap - size of script->lines, updated
+#   @return: the new line, NULL if out of memory
+******************************************************/
+static struct Ast* sh_source_add_line(struct Script *script, int *cap)
+{
+    if (script->line_count == *cap) {
+        int new_cap = *cap ? *cap * 2 : 64;
+        struct Ast *grown = realloc(script->lines, new_cap * sizeof(struct Ast));
+        if (grown == NULL) {
+            return NULL;
+        }
+        script->lines = grown;
+        *cap = new_cap;
+    }
+    return &script->lines[script->line_count++];
+}
+
+/******************************************************
+#   sh_source_compile
+#   @desc: compiles every line of a script. The script
+#       takes the place of the shell's input meanwhile,
+#       so here-doc bodies come from the script.
+#   @param: pointer to shell object
+#   @param: script - receives the lines
+#   @param: fd - open script, closed here
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_source_compile(struct Shell *this_shell, struct Script *script, int fd)
+{
+    struct InputReader saved_input = this_shell->input;
+    struct EventWatch *saved_watch = this_shell->loop.input_watch;
+    char *saved_line = this_shell->user_input;
+    size_t saved_len = this_shell->input_len;
+    int cap = 0;
+    int result = 0;
+
+    if (sh_input_open(&this_shell->input, fd) == -1) {
+        close(fd);
+        this_shell->input = saved_input;
+        return -1;
+    }
+    this_shell->input.interactive = 0;
+    this_shell->loop.input_watch = NULL;
+
+    while (sh_get_line(this_shell, "") == 1) {
+        struct Ast *line = sh_source_add_line(script, &cap);
+        if (line == NULL
+                || sh_ast_compile(this_shell, &script->arena, this_shell->user_input, this_shell->input_len,
+                    line) == PARSE_NOMEM) {
+            result = -1;
+            break;
+        }
+    }
+
+    sh_input_close(&this_shell->input);
+    this_shell->input = saved_input;
+    this_shell->loop.input_watch = saved_watch;
+    this_shell->user_input = saved_line;
+    this_shell->input_len = saved_len;
+
+    return result;
+}
+
+/******************************************************
+#   sh_source_file_name
+#   @desc: names the cache file of a script after an
+#       FNV-1a hash of its full path
+#   @param: dir - cache directory
+#   @param: real - full path of the script
+#   @param: out - receives the name
+#   @param: out_cap - size of out
+#   @return: 0 on success, -1 if the name is too long
+******************************************************/
+static int sh_source_file_name(const char *dir, const char *real, char *out, size_t out_cap)
+{
+    uint64_t hash = 14695981039346656037ull;
+    int len;
+
+    for (; *real != '\0'; real++) {
+        hash ^= (unsigned char)*real;
+        hash *= 1099511628211ull;
+    }
+    len = snprintf(out, out_cap, "%s/%016llx.ast", dir, (unsigned long long)hash);
+    return (len < 0 || (size_t)len >= out_cap) ? -1 : 0;
+}
+
+/******************************************************
+#   sh_source_save
+#   @desc: writes the compiled lines to the cache file,
+#       through a temporary file renamed into place so
+#       a reader never sees half of it
+#   @param: script - compiled script
+#   @param: file - cache file name
+#   @param: real - full path of the script
+#   @return: void
+******************************************************/
+static void sh_source_save(const struct Script *script, const char *file, const char *real)
+{
+    struct ScriptFileHeader header;
+    struct ScriptFileLine *lines;
+    struct AstNode *nodes;
+    uint32_t *words;
+    unsigned char *flags;
+    char *pool;
+    char *buf;
+    char tmp[PATH_MAX];
+    size_t path_len = strlen(real) + 1;
+    size_t node_count = 0;
+    size_t word_count = 0;
+    size_t pool_len = 0;
+    size_t total;
+    size_t done = 0;
+    int fd;
+    int i;
+    int j;
+
+    for (i = 0; i < script->line_count; i++) {
+        const struct Ast *ast = &script->lines[i];
+        node_count += ast->node_count;
+        word_count += ast->word_count;
+        for (j = 0; j < ast->word_count; j++) {
+            if (!sh_is_operator(ast->words[j])) {
+                pool_len += strlen(ast->words[j]) + 1;
+            }
+        }
+    }
+
+    total = sizeof(header) + sh_source_align(path_len, 8)
+        + script->line_count * sizeof(struct ScriptFileLine) + node_count * sizeof(struct AstNode)
+        + word_count * sizeof(uint32_t) + sh_source_align(word_count, 4) + pool_len;
+    if (pool_len >= SCRIPT_FILE_OPERATOR) {
+        return;
+    }
+    buf = calloc(1, total);
+    if (buf == NULL) {
+        return;
+    }
+
+    memcpy(header.magic, SCRIPT_FILE_MAGIC, sizeof(header.magic));
+    header.size = script->size;
+    header.mtime_sec = script->mtime.tv_sec;
+    header.mtime_nsec = script->mtime.tv_nsec;
+    header.path_len = sh_source_align(path_len, 8);
+    header.line_count = script->line_count;
+    header.node_count = node_count;
+    header.word_count = word_count;
+    header.pool_len = pool_len;
+    header.reserved = 0;
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + sizeof(header), real, path_len);
+
+    lines = (struct ScriptFileLine*)(buf + sizeof(header) + header.path_len);
+    nodes = (struct AstNode*)(lines + script->line_count);
+    words = (uint32_t*)(nodes + node_count);
+    flags = (unsigned char*)(words + word_count);
+    pool = (char*)flags + sh_source_align(word_count, 4);
+
+    node_count = 0;
+    word_count = 0;
+    pool_len = 0;
+    for (i = 0; i < script->line_count; i++) {
+        const struct Ast *ast = &script->lines[i];
+
+        lines[i].root = ast->root;
+        lines[i].error = ast->error;
+        lines[i].near = ast->near;
+        lines[i].first_node = node_count;
+        lines[i].node_count = ast->node_count;
+        lines[i].first_word = word_count;
+        lines[i].word_count = ast->word_count;
+
+        if (ast->node_count > 0) {
+            memcpy(nodes + node_count, ast->nodes, ast->node_count * sizeof(struct AstNode));
+        }
+        node_count += ast->node_count;
+
+        for (j = 0; j < ast->word_count; j++, word_count++) {
+            int op = sh_operator_index(ast->words[j]);
+            flags[word_count] = ast->flags[j];
+            if (op != -1) {
+                words[word_count] = SCRIPT_FILE_OPERATOR | op;
+                continue;
+            }
+            words[word_count] = pool_len;
+            strcpy(pool + pool_len, ast->words[j]);
+            pool_len += strlen(ast->words[j]) + 1;
+        }
+    }
+
+    /*No room for the suffix: go without a cache file*/
+    if (snprintf(tmp, sizeof(tmp), "%s.%d", file, (int)getpid()) >= (int)sizeof(tmp)) {
+        free(buf);
+        return;
+    }
+    fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd != -1) {
+        while (done < total) {
+            ssize_t put = write(fd, buf + done, total - done);
+            if (put <= 0) {
+                break;
+            }
+            done += put;
+        }
+        close(fd);
+        if (done != total || rename(tmp, file) == -1) {
+            unlink(tmp);
+        }
+    }
+    free(buf);
+}
+
+/******************************************************
+#   sh_source_load
+#   @desc: maps a cache file and points the script's
+#       lines into it. Nodes, flags and word text are
+#       used from the mapping as they are; only the word
+#       pointers are rebuilt. The file is checked to be
+#       for this script and to be consistent.
+#   @param: script - receives the lines
+#   @param: file - cache file name
+#   @param: real - full path of the script
+#   @return: 0 on success, -1 if there is no usable file
+******************************************************/
+static int sh_source_load(struct Script *script, const char *file, const char *real)
+{
+    struct ScriptFileHeader header;
+    const struct ScriptFileLine *lines;
+    struct AstNode *nodes;
+    const uint32_t *words;
+    unsigned char *flags;
+    const char *pool;
+    char **pointers;
+    struct stat info;
+    size_t path_len = strlen(real) + 1;
+    size_t total;
+    char *map;
+    int fd = open(file, O_RDONLY | O_CLOEXEC);
+    uint32_t i;
+    uint32_t j;
+
+    if (fd == -1) {
+        return -1;
+    }
+    if (fstat(fd, &info) == -1 || (size_t)info.st_size < sizeof(header)) {
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    script->map = map;
+    script->map_len = info.st_size;
+
+    /*Must be for this version of this script*/
+    memcpy(&header, map, sizeof(header));
+    if (memcmp(header.magic, SCRIPT_FILE_MAGIC, sizeof(header.magic)) != 0
+            || header.size != (int64_t)script->size || header.mtime_sec != (int64_t)script->mtime.tv_sec
+            || header.mtime_nsec != (int64_t)script->mtime.tv_nsec
+            || header.path_len != sh_source_align(path_len, 8) || header.line_count > INT_MAX
+            || (size_t)info.st_size < sizeof(header) + header.path_len
+            || memcmp(map + sizeof(header), real, path_len) != 0) {
+        return -1;
+    }
+    total = sizeof(header) + header.path_len
+        + (size_t)header.line_count * sizeof(struct ScriptFileLine)
+        + (size_t)header.node_count * sizeof(struct AstNode)
+        + (size_t)header.word_count * sizeof(uint32_t) + sh_source_align(header.word_count, 4)
+        + header.pool_len;
+    if (total != (size_t)info.st_size || (header.pool_len > 0 && map[total - 1] != '\0')) {
+        return -1;
+    }
+
+    lines = (const struct ScriptFileLine*)(map + sizeof(header) + header.path_len);
+    nodes = (struct AstNode*)(lines + header.line_count);
+    words = (const uint32_t*)(nodes + header.node_count);
+    flags = (unsigned char*)(words + header.word_count);
+    pool = (const char*)flags + sh_source_align(header.word_count, 4);
+
+    script->lines = malloc((header.line_count + 1) * sizeof(struct Ast));
+    pointers = sh_arena_alloc(&script->arena, (header.word_count + 1) * sizeof(char*));
+    if (script->lines == NULL || pointers == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < header.word_count; i++) {
+        if (words[i] & SCRIPT_FILE_OPERATOR) {
+            pointers[i] = (char*)sh_operator_word(words[i] & ~SCRIPT_FILE_OPERATOR);
+        }
+        else {
+            pointers[i] = words[i] < header.pool_len ? (char*)pool + words[i] : NULL;
+        }
+        if (pointers[i] == NULL) {
+            return -1;
+        }
+    }
+
+    for (i = 0; i < header.line_count; i++) {
+        struct Ast *ast = &script->lines[i];
+        const struct ScriptFileLine *line = &lines[i];
+
+        if (line->first_node > header.node_count || line->node_count > header.node_count - line->first_node
+                || line->first_word > header.word_count
+                || line->word_count > header.word_count - line->first_word
+                || line->root < -1 || line->root >= (int32_t)line->node_count
+                || line->near < -1 || line->near >= (int32_t)line->word_count) {
+            return -1;
+        }
+        ast->nodes = nodes + line->first_node;
+        ast->node_count = line->node_count;
+        ast->words = pointers + line->first_word;
+        ast->flags = flags + line->first_word;
+        ast->word_count = line->word_count;
+        ast->root = line->root;
+        ast->error = line->error;
+        ast->near = line->near;
+
+        /*Indices stay inside the line*/
+        for (j = 0; j < line->node_count; j++) {
+            const struct AstNode *node = &ast->nodes[j];
+            if (node->left < -1 || node->left >= ast->node_count || node->right < -1
+                    || node->right >= ast->node_count || node->first < 0 || node->count < 0
+                    || node->first > ast->word_count || node->count > ast->word_count - node->first) {
+                return -1;
+            }
+        }
+        script->line_count++;
+    }
+
+    return 0;
+}
+
+/******************************************************
+#   sh_source_slot
+#   @desc: finds the compiled form of a script that is
+#       still current, or picks the slot to compile it
+#       into: an empty one or the least recently used
+#       one not running
+#   @param: cache - script cache
+#   @param: info - stat of the script
+#   @param: found - set to 1 if the slot is current
+#   @return: slot, NULL if every slot is running
+******************************************************/
+static struct Script* sh_source_slot(struct ScriptCache *cache, const struct stat *info, int *found)
+{
+    struct Script *victim = NULL;
+    int i;
+
+    *found = 0;
+    cache->tick++;
+
+    for (i = 0; i < SCRIPT_CACHE_SIZE; i++) {
+        struct Script *script = &cache->scripts[i];
+
+        if (script->path != NULL && script->dev == info->st_dev && script->ino == info->st_ino
+                && script->size == info->st_size && script->mtime.tv_sec == info->st_mtim.tv_sec
+                && script->mtime.tv_nsec == info->st_mtim.tv_nsec) {
+            script->used = cache->tick;
+            *found = 1;
+            return script;
+        }
+        if (script->running > 0 || (victim != NULL && victim->path == NULL)) {
+            continue;
+        }
+        if (victim == NULL || script->path == NULL || script->used < victim->used) {
+            victim = script;
+        }
+    }
+
+    if (victim != NULL && victim->path != NULL) {
+        sh_source_clear(victim);
+    }
+    return victim;
+}
+
+/******************************************************
+#   sh_source_prepare
+#   @desc: fills a slot with the compiled script: from
+#       the cache file when it is current, otherwise by
+#       compiling it (and writing the cache file)
+#   @param: pointer to shell object
+#   @param: script - empty slot
+#   @param: fd - open script, closed here
+#   @param: info - stat of the script
+#   @return: 0 on success, -1 if out of memory
+******************************************************/
+static int sh_source_prepare(struct Shell *this_shell, struct Script *script, int fd, const struct stat *info)
+{
+    const char *dir = sh_env_get(&this_shell->env, "SIMPLE_SHELL_CACHE");
+    char real[PATH_MAX];
+    char file[PATH_MAX];
+    char fd_path[64];
+    int cached = 0;
+
+    script->dev = info->st_dev;
+    script->ino = info->st_ino;
+    script->size = info->st_size;
+    script->mtime = info->st_mtim;
+    sh_arena_init(&script->arena, ARENA_BLOCK_SIZE);
+
+    /*Cache files are named after the full path*/
+    snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+    if (dir != NULL && *dir != '\0' && (realpath(fd_path, real) != NULL)
+            && sh_source_file_name(dir, real, file, sizeof(file)) == 0) {
+        cached = 1;
+        if (sh_source_load(script, file, real) == 0) {
+            close(fd);
+            script->path = strdup(real);
+            return script->path == NULL ? -1 : 0;
+        }
+        /*Start again from nothing*/
+        free(script->lines);
+        script->lines = NULL;
+        script->line_count = 0;
+        if (script->map != NULL) {
+            munmap(script->map, script->map_len);
+            script->map = NULL;
+        }
+        sh_arena_reset(&script->arena);
+    }
+
+    if (sh_source_compile(this_shell, script, fd) == -1) {
+        return -1;
+    }
+    if (cached) {
+        sh_source_save(script, file, real);
+    }
+    script->path = strdup(cached ? real : "");
+    return script->path == NULL ? -1 : 0;
+}
+
+/******************************************************
+#   sh_source_run
+#   @desc: runs the compiled lines in turn. What their
+#       commands take from the arena is released after
+#       each line.
+#   @param: pointer to shell object
+#   @param: script - compiled script
+#   @return: void
+******************************************************/
+static void sh_source_run(struct Shell *this_shell, struct Script *script)
+{
+    struct ArenaMark mark;
+    int i;
+
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+    sh_arena_mark(&this_shell->arena, &mark);
+
+    for (i = 0; i < script->line_count; i++) {
+        const struct Ast *ast = &script->lines[i];
+
+        sh_catch_bg(this_shell);
+        if (ast->error != PARSE_OK) {
+            sh_ast_error(ast);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            continue;
+        }
+        sh_ast_run(this_shell, ast, ast->root);
+        sh_arena_release(&this_shell->arena, &mark);
+
+        /*CTRL-C stops the script*/
+        if (this_shell->signaled && this_shell->status == SIGINT) {
+            break;
+        }
+    }
+}
+
+/******************************************************
+#   sh_source_command
+#   @desc: source FILE (or . FILE) runs the commands in
+#       FILE in this shell, from the script cache when
+#       FILE hasn't changed since it was compiled
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_source_command(struct Shell *this_shell)
+{
+    struct ScriptCache *cache = &this_shell->scripts;
+    struct Script spare;
+    struct Script *script;
+    struct stat info;
+    const char *name;
+    int found;
+    int fd;
+
+    if (this_shell->args_count < 2) {
+        fprintf(stdout, "%s: usage: %s file\n", this_shell->arguments[0], this_shell->arguments[0]);
+        fflush(stdout);
+        this_shell->status = 2;
+        this_shell->signaled = 0;
+        return;
+    }
+    name = this_shell->arguments[1];
+
+    if (cache->depth >= SOURCE_MAX_DEPTH) {
+        fprintf(stdout, "source: %s: sourced too deeply\n", name);
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    fd = open(name, O_RDONLY | O_CLOEXEC);
+    if (fd == -1 || fstat(fd, &info) == -1 || !S_ISREG(info.st_mode)) {
+        if (fd != -1) {
+            close(fd);
+        }
+        fprintf(stdout, "source: cannot open %s\n", name);
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    script = sh_source_slot(cache, &info, &found);
+    if (found) {
+        close(fd);
+    }
+    else {
+        /*Every slot is running: compile just for this run*/
+        if (script == NULL) {
+            memset(&spare, 0, sizeof(spare));
+            script = &spare;
+        }
+        if (sh_source_prepare(this_shell, script, fd, &info) == -1) {
+            fprintf(stdout, "simple_shell: out of memory\n");
+            fflush(stdout);
+            sh_source_clear(script);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            return;
+        }
+        script->used = cache->tick;
+    }
+
+    script->running++;
+    cache->depth++;
+    sh_source_run(this_shell, script);
+    cache->depth--;
+    script->running--;
+
+    if (script == &spare) {
+        sh_source_clear(script);
+    }
+}
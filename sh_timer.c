@@ -0,0 +1,525 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_timer.c
+#   Description: Deadlines for jobs. timeout N cmd, or a
+#       session default, gives each job started a timer
+#       that sends SIGTERM to its process group when it
+#       expires and SIGKILL after a grace period. Timers
+#       live in a hierarchical timer wheel ticked by a
+#       timerfd, so a tick costs the same however many
+#       jobs have deadlines: it moves at most one slot
+#       per level and fires only what is due.
+#
+******************************************************/
+#include <sys/timerfd.h>
+
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_timers_init
+#   @desc: sets up an empty wheel, no default deadline
+#   @param: wheel - timer wheel
+#   @return: void
+******************************************************/
+void sh_timers_init(struct TimerWheel *wheel)
+{
+    memset(wheel->slots, 0, sizeof(wheel->slots));
+    wheel->now = 0;
+    wheel->count = 0;
+    wheel->fd = -1;
+    wheel->watch = NULL;
+    wheel->nested = 0;
+    wheel->deadline = 0;
+    wheel->grace = TIMEOUT_GRACE;
+    wheel->arming = 0;
+    wheel->current = NULL;
+}
+
+/******************************************************
+#   sh_timers_free
+#   @desc: frees the pending timers and the timerfd
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_timers_free(struct Shell *this_shell)
+{
+    struct TimerWheel *wheel = &this_shell->timers;
+    int level;
+    int slot;
+
+    for (level = 0; level < TIMER_LEVELS; level++) {
+        for (slot = 0; slot < TIMER_SLOTS; slot++) {
+            struct Timer *timer = wheel->slots[level][slot];
+            while (timer != NULL) {
+                struct Timer *next = timer->next;
+                free(timer);
+                timer = next;
+            }
+        }
+    }
+    if (wheel->fd != -1) {
+        sh_loop_unwatch(this_shell, wheel->watch);
+        close(wheel->fd);
+    }
+    sh_timers_init(wheel);
+}
+
+/******************************************************
+#   sh_timers_child
+#   @desc: in a forked subshell the parent's deadlines
+#       are the parent's to enforce. The subshell keeps
+#       the default for its own commands, with a timerfd
+#       of its own that is polled while it waits.
+#   @param: wheel - timer wheel
+#   @return: void
+******************************************************/
+void sh_timers_child(struct TimerWheel *wheel)
+{
+    double deadline = wheel->deadline;
+    double grace = wheel->grace;
+
+    if (wheel->fd != -1) {
+        close(wheel->fd);
+    }
+    sh_timers_init(wheel);
+    wheel->nested = 1;
+    wheel->deadline = deadline;
+    wheel->grace = grace;
+}
+
+/******************************************************
+#   sh_timers_ticking
+#   @desc: starts or stops the timerfd's periodic tick
+#   @param: wheel - timer wheel
+#   @param: on - 1 to tick every TIMER_TICK_MS
+#   @return: void
+******************************************************/
+static void sh_timers_ticking(struct TimerWheel *wheel, int on)
+{
+    struct itimerspec spec;
+    uint64_t stale;
+
+    memset(&spec, 0, sizeof(spec));
+    if (on) {
+        /*Ticks from before it was stopped don't count*/
+        while (read(wheel->fd, &stale, sizeof(stale)) > 0) {
+        }
+        spec.it_interval.tv_nsec = TIMER_TICK_MS * 1000000L;
+        spec.it_value = spec.it_interval;
+    }
+    timerfd_settime(wheel->fd, 0, &spec, NULL);
+}
+
+/******************************************************
+#   sh_timer_ticks
+#   @desc: converts seconds to ticks, at least one
+#   @param: seconds - time from now
+#   @return: ticks
+******************************************************/
+static unsigned long sh_timer_ticks(double seconds)
+{
+    double ticks = seconds * 1000 / TIMER_TICK_MS;
+
+    return ticks < 1 ? 1 : (unsigned long)(ticks + 0.999);
+}
+
+/******************************************************
+#   sh_timer_insert
+#   @desc: puts a timer in the slot for its expiry: the
+#       lowest level whose span covers the time left,
+#       indexed by that level's digit of the expiry
+#   @param: wheel - timer wheel
+#   @param: timer - timer with expires set
+#   @return: void
+******************************************************/
+static void sh_timer_insert(struct TimerWheel *wheel, struct Timer *timer)
+{
+    unsigned long span = 1UL << (TIMER_BITS * TIMER_LEVELS);
+    unsigned long delta;
+    struct Timer **link;
+    int level = 0;
+
+    /*Overdue fires on this tick; too far is clamped to the wheel's span*/
+    if ((long)(timer->expires - wheel->now) < 0) {
+        timer->expires = wheel->now;
+    }
+    delta = timer->expires - wheel->now;
+    if (delta >= span) {
+        timer->expires = wheel->now + span - 1;
+        delta = span - 1;
+    }
+    while (level < TIMER_LEVELS - 1 && delta >= 1UL << (TIMER_BITS * (level + 1))) {
+        level++;
+    }
+
+    link = &wheel->slots[level][(timer->expires >> (TIMER_BITS * level)) & (TIMER_SLOTS - 1)];
+    timer->next = *link;
+    if (timer->next != NULL) {
+        timer->next->link = &timer->next;
+    }
+    *link = timer;
+    timer->link = link;
+    timer->wheel = wheel;
+    wheel->count++;
+}
+
+/******************************************************
+#   sh_timer_unlink
+#   @desc: takes a timer out of its slot
+#   @param: timer - timer in the wheel
+#   @return: void
+******************************************************/
+static void sh_timer_unlink(struct Timer *timer)
+{
+    *timer->link = timer->next;
+    if (timer->next != NULL) {
+        timer->next->link = timer->link;
+    }
+    timer->link = NULL;
+    timer->wheel->count--;
+}
+
+/******************************************************
+#   sh_timer_cancel
+#   @desc: drops a job's deadline
+#   @param: timer - the deadline, may be NULL
+#   @return: void
+******************************************************/
+void sh_timer_cancel(struct Timer *timer)
+{
+    if (timer == NULL) {
+        return;
+    }
+    if (timer->link != NULL) {
+        sh_timer_unlink(timer);
+        if (timer->wheel->count == 0) {
+            sh_timers_ticking(timer->wheel, 0);
+        }
+    }
+    free(timer);
+}
+
+/******************************************************
+#   sh_timer_fire
+#   @desc: a deadline ran out: SIGTERM the job and come
+#       back after the grace period with SIGKILL
+#   @param: wheel - timer wheel
+#   @param: timer - timer taken out of the wheel
+#   @return: void
+******************************************************/
+static void sh_timer_fire(struct TimerWheel *wheel, struct Timer *timer)
+{
+    if (timer->fired == 0) {
+        kill(timer->target, SIGTERM);
+        /*A stopped job only sees it once continued*/
+        kill(timer->target, SIGCONT);
+        timer->fired = 1;
+        timer->expires = wheel->now + sh_timer_ticks(timer->grace);
+        sh_timer_insert(wheel, timer);
+    }
+    else {
+        kill(timer->target, SIGKILL);
+        timer->fired = 2;
+    }
+}
+
+/******************************************************
+#   sh_timers_tick
+#   @desc: advances the wheel one tick. Where a lower
+#       level wraps, the next level's slot for the new
+#       time is spread over the levels below; then the
+#       level 0 slot for the new time fires.
+#   @param: wheel - timer wheel
+#   @return: void
+******************************************************/
+static void sh_timers_tick(struct TimerWheel *wheel)
+{
+    struct Timer *timer;
+    int level;
+
+    wheel->now++;
+
+    for (level = 1; level < TIMER_LEVELS; level++) {
+        if ((wheel->now & ((1UL << (TIMER_BITS * level)) - 1)) != 0) {
+            break;
+        }
+        timer = wheel->slots[level][(wheel->now >> (TIMER_BITS * level)) & (TIMER_SLOTS - 1)];
+        while (timer != NULL) {
+            struct Timer *next = timer->next;
+            sh_timer_unlink(timer);
+            sh_timer_insert(wheel, timer);
+            timer = next;
+        }
+    }
+
+    timer = wheel->slots[0][wheel->now & (TIMER_SLOTS - 1)];
+    while (timer != NULL) {
+        struct Timer *next = timer->next;
+        sh_timer_unlink(timer);
+        sh_timer_fire(wheel, timer);
+        timer = next;
+    }
+}
+
+/******************************************************
+#   sh_timers_ready
+#   @desc: the timerfd is readable: runs the ticks that
+#       passed, stopping the tick once nothing is left
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_timers_ready(struct Shell *this_shell)
+{
+    struct TimerWheel *wheel = &this_shell->timers;
+    uint64_t ticks;
+
+    if (read(wheel->fd, &ticks, sizeof(ticks)) != sizeof(ticks)) {
+        return;
+    }
+    while (ticks-- > 0 && wheel->count > 0) {
+        sh_timers_tick(wheel);
+    }
+    if (wheel->count == 0) {
+        sh_timers_ticking(wheel, 0);
+    }
+}
+
+/******************************************************
+#   sh_timers_on_tick
+#   @desc: event loop handler of the timerfd
+#   @param: pointer to shell object
+#   @param: fd - the timerfd
+#   @param: data - unused
+#   @return: void
+******************************************************/
+static void sh_timers_on_tick(struct Shell *this_shell, int fd, void *data)
+{
+    (void)fd;
+    (void)data;
+    sh_timers_ready(this_shell);
+}
+
+/******************************************************
+#   sh_deadline_begin
+#   @desc: a job is about to start: if a deadline is in
+#       effect it gets one, and a process group of its
+#       own for the signals to go to
+#   @param: pointer to shell object
+#   @return: 1 if the caller must sh_deadline_end, else 0
+******************************************************/
+int sh_deadline_begin(struct Shell *this_shell)
+{
+    struct TimerWheel *wheel = &this_shell->timers;
+
+    if (wheel->deadline <= 0 || wheel->arming) {
+        return 0;
+    }
+    wheel->arming = 1;
+    return 1;
+}
+
+/******************************************************
+#   sh_deadline_arm
+#   @desc: starts the deadline of the job being started,
+#       once its first process is running
+#   @param: pointer to shell object
+#   @param: target - its pid, or -pgid for its group
+#   @return: void
+******************************************************/
+void sh_deadline_arm(struct Shell *this_shell, pid_t target)
+{
+    struct TimerWheel *wheel = &this_shell->timers;
+    struct Timer *timer;
+
+    /*0 and -1 would signal the shell too*/
+    if (!wheel->arming || wheel->current != NULL || target == 0 || target == -1) {
+        return;
+    }
+
+    if (wheel->fd == -1) {
+        wheel->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (wheel->fd == -1) {
+            return;
+        }
+        if (!wheel->nested) {
+            wheel->watch = sh_loop_watch(this_shell, wheel->fd, sh_timers_on_tick, NULL);
+        }
+    }
+
+    timer = malloc(sizeof(struct Timer));
+    if (timer == NULL) {
+        return;
+    }
+    timer->target = target;
+    timer->fired = 0;
+    timer->seconds = wheel->deadline;
+    timer->grace = wheel->grace;
+    timer->expires = wheel->now + sh_timer_ticks(wheel->deadline);
+
+    if (wheel->count == 0) {
+        sh_timers_ticking(wheel, 1);
+    }
+    sh_timer_insert(wheel, timer);
+    wheel->current = timer;
+}
+
+/******************************************************
+#   sh_deadline_take
+#   @desc: hands the deadline of the job being started
+#       to a job that stays in the job table
+#   @param: pointer to shell object
+#   @return: the deadline, NULL if none
+******************************************************/
+struct Timer* sh_deadline_take(struct Shell *this_shell)
+{
+    struct Timer *timer = this_shell->timers.current;
+
+    this_shell->timers.current = NULL;
+    return timer;
+}
+
+/******************************************************
+#   sh_deadline_status
+#   @desc: a job that ran out of time ends with status
+#       TIMEOUT_STATUS, however the signal ended it
+#   @param: pointer to shell object
+#   @param: timer - the job's deadline, may be NULL
+#   @return: 1 if it had run out, else 0
+******************************************************/
+int sh_deadline_status(struct Shell *this_shell, const struct Timer *timer)
+{
+    if (timer == NULL || !timer->fired) {
+        return 0;
+    }
+    this_shell->status = TIMEOUT_STATUS;
+    this_shell->signaled = 0;
+    this_shell->timed_out = timer->seconds;
+    return 1;
+}
+
+/******************************************************
+#   sh_deadline_end
+#   @desc: the job has finished in the foreground: drops
+#       its deadline and, if it ran out, makes that the
+#       status
+#   @param: pointer to shell object
+#   @return: 1 if it had run out, else 0
+******************************************************/
+int sh_deadline_end(struct Shell *this_shell)
+{
+    struct TimerWheel *wheel = &this_shell->timers;
+    struct Timer *timer = wheel->current;
+    int expired = sh_deadline_status(this_shell, timer);
+
+    wheel->arming = 0;
+    wheel->current = NULL;
+    sh_timer_cancel(timer);
+    return expired;
+}
+
+/******************************************************
+#   sh_duration_parse
+#   @desc: reads a duration: seconds, or a number with
+#       s, m, h or d; "off" is 0
+#   @param: text - duration as typed
+#   @param: seconds - receives it
+#   @return: 0 on success, -1 if text is not a duration
+******************************************************/
+int sh_duration_parse(const char *text, double *seconds)
+{
+    char *end;
+    double value;
+
+    if (strcmp(text, "off") == 0) {
+        *seconds = 0;
+        return 0;
+    }
+    value = strtod(text, &end);
+    if (end == text || value < 0) {
+        return -1;
+    }
+    switch (*end) {
+        case '\0': case 's': break;
+        case 'm': value *= 60; break;
+        case 'h': value *= 3600; break;
+        case 'd': value *= 86400; break;
+        default: return -1;
+    }
+    if (*end != '\0' && end[1] != '\0') {
+        return -1;
+    }
+    *seconds = value;
+    return 0;
+}
+
+/******************************************************
+#   sh_timeout_command
+#   @desc: timeout [-k grace] duration [command]. Runs
+#       command with a deadline, or without a command
+#       makes it the deadline of every job started from
+#       then on (0 or off for none). On its own shows
+#       the default.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_timeout_command(struct Shell *this_shell)
+{
+    struct TimerWheel *wheel = &this_shell->timers;
+    char **argv = this_shell->arguments;
+    double saved_deadline = wheel->deadline;
+    double saved_grace = wheel->grace;
+    double grace = wheel->grace;
+    double seconds;
+    int i = 1;
+
+    if (this_shell->args_count == 1) {
+        if (wheel->deadline > 0) {
+            fprintf(stdout, "timeout %gs, kill after %gs more\n", wheel->deadline, wheel->grace);
+        }
+        else {
+            fprintf(stdout, "timeout off\n");
+        }
+        fflush(stdout);
+        this_shell->status = 0;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    if (strcmp(argv[1], "-k") == 0) {
+        if (this_shell->args_count < 3 || sh_duration_parse(argv[2], &grace) == -1) {
+            i = this_shell->args_count;
+        }
+        else {
+            i = 3;
+        }
+    }
+    if (i >= this_shell->args_count || sh_duration_parse(argv[i], &seconds) == -1) {
+        fprintf(stdout, "timeout: usage: timeout [-k grace] duration [command]\n");
+        fflush(stdout);
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
+    i++;
+
+    wheel->deadline = seconds;
+    wheel->grace = grace;
+
+    /*No command: it becomes the session's*/
+    if (i == this_shell->args_count) {
+        this_shell->status = 0;
+        this_shell->signaled = 0;
+        return;
+    }
+
+    /*Run the rest of the line with it; & and redirections were already taken*/
+    this_shell->arguments += i;
+    this_shell->args_count -= i;
+    sh_identify_command(this_shell);
+
+    wheel->deadline = saved_deadline;
+    wheel->grace = saved_grace;
+}
@@ -0,0 +1,430 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_trace.c
+#   Description: Execution trace (--trace FILE). Writes
+#       one event per command as JSON lines, or as Chrome
+#       trace_event JSON that loads in Perfetto. Events
+#       are formatted into a large buffer that is written
+#       only when full or at exit, so tracing adds no
+#       syscalls to launching a command.
+#
+******************************************************/
+#include <stdarg.h>
+
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_trace_now
+#   @desc: microseconds since the trace was opened
+#   @param: trace - trace writer
+#   @return: microseconds on the monotonic clock
+******************************************************/
+static long long sh_trace_now(struct Trace *trace)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000LL + ts.tv_nsec / 1000 - trace->origin;
+}
+
+/******************************************************
+#   sh_trace_flush
+#   @desc: writes out the buffered events
+#   @param: trace - trace writer
+#   @return: void
+******************************************************/
+static void sh_trace_flush(struct Trace *trace)
+{
+    size_t done = 0;
+
+    while (done < trace->len) {
+        ssize_t put = write(trace->fd, trace->buf + done, trace->len - done);
+        if (put <= 0) {
+            if (put < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        done += put;
+    }
+    trace->len = 0;
+}
+
+/******************************************************
+#   sh_trace_put
+#   @desc: appends bytes to the buffer, flushing first if
+#       they don't fit
+#   @param: trace - trace writer
+#   @param: text - bytes to add
+#   @param: len - number of bytes
+#   @return: void
+******************************************************/
+static void sh_trace_put(struct Trace *trace, const char *text, size_t len)
+{
+    if (trace->len + len > trace->cap) {
+        sh_trace_flush(trace);
+    }
+
+    /*Bigger than the whole buffer: write it through*/
+    if (len > trace->cap) {
+        ssize_t put;
+        while (len > 0 && ((put = write(trace->fd, text, len)) > 0 || errno == EINTR)) {
+            if (put > 0) {
+                text += put;
+                len -= put;
+            }
+        }
+        return;
+    }
+
+    memcpy(trace->buf + trace->len, text, len);
+    trace->len += len;
+}
+
+/******************************************************
+#   sh_trace_printf
+#   @desc: formats a short piece of an event
+#   @param: trace - trace writer
+#   @param: format - printf format
+#   @return: void
+******************************************************/
+static void sh_trace_printf(struct Trace *trace, const char *format, ...)
+{
+    char piece[512];
+    va_list ap;
+    int len;
+
+    va_start(ap, format);
+    len = vsnprintf(piece, sizeof(piece), format, ap);
+    va_end(ap);
+
+    if (len >= (int)sizeof(piece)) {
+        len = sizeof(piece) - 1;
+    }
+    if (len > 0) {
+        sh_trace_put(trace, piece, len);
+    }
+}
+
+/******************************************************
+#   sh_trace_string
+#   @desc: appends a JSON string literal
+#   @param: trace - trace writer
+#   @param: text - string to quote and escape
+#   @return: void
+******************************************************/
+static void sh_trace_string(struct Trace *trace, const char *text)
+{
+    const char *run = text;
+
+    sh_trace_put(trace, "\"", 1);
+    for (; *text != '\0'; text++) {
+        unsigned char c = *text;
+        if (c != '"' && c != '\\' && c >= 0x20) {
+            continue;
+        }
+        sh_trace_put(trace, run, text - run);
+        if (c == '"' || c == '\\') {
+            char escaped[2] = { '\\', c };
+            sh_trace_put(trace, escaped, 2);
+        }
+        else {
+            sh_trace_printf(trace, "\\u%04x", c);
+        }
+        run = text + 1;
+    }
+    sh_trace_put(trace, run, text - run);
+    sh_trace_put(trace, "\"", 1);
+}
+
+/******************************************************
+#   sh_trace_usage
+#   @desc: appends the rusage fields of an event
+#   @param: trace - trace writer
+#   @param: ru - usage from wait4
+#   @return: void
+******************************************************/
+static void sh_trace_usage(struct Trace *trace, const struct rusage *ru)
+{
+    sh_trace_printf(trace, "\"utime_us\":%lld,\"stime_us\":%lld,\"maxrss_kb\":%ld,"
+            "\"minflt\":%ld,\"majflt\":%ld,\"nvcsw\":%ld,\"nivcsw\":%ld",
+            ru->ru_utime.tv_sec * 1000000LL + ru->ru_utime.tv_usec,
+            ru->ru_stime.tv_sec * 1000000LL + ru->ru_stime.tv_usec,
+            ru->ru_maxrss, ru->ru_minflt, ru->ru_majflt, ru->ru_nvcsw, ru->ru_nivcsw);
+}
+
+/******************************************************
+#   sh_trace_result
+#   @desc: appends how the command ended
+#   @param: trace - trace writer
+#   @param: status - status from wait4
+#   @return: void
+******************************************************/
+static void sh_trace_result(struct Trace *trace, int status)
+{
+    if (WIFSIGNALED(status)) {
+        sh_trace_printf(trace, "\"signal\":%d", WTERMSIG(status));
+    }
+    else {
+        sh_trace_printf(trace, "\"exit\":%d", WEXITSTATUS(status));
+    }
+}
+
+/******************************************************
+#   sh_trace_open
+#   @desc: starts writing a trace to path
+#   @param: trace - trace writer
+#   @param: path - output file
+#   @param: chrome - 1 for Chrome trace_event, 0 for JSONL
+#   @return: 0 on success, -1 on failure
+******************************************************/
+int sh_trace_open(struct Trace *trace, const char *path, int chrome)
+{
+    struct timespec ts;
+
+    trace->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0664);
+    if (trace->fd == -1) {
+        return -1;
+    }
+    trace->cap = TRACE_BUFFER;
+    trace->buf = malloc(trace->cap);
+    if (trace->buf == NULL) {
+        close(trace->fd);
+        trace->fd = -1;
+        return -1;
+    }
+    trace->len = 0;
+    trace->chrome = chrome;
+    trace->events = 0;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    trace->origin = ts.tv_sec * 1000000LL + ts.tv_nsec / 1000;
+
+    if (chrome) {
+        sh_trace_printf(trace, "{\"traceEvents\":[\n");
+    }
+    return 0;
+}
+
+/******************************************************
+#   sh_trace_close
+#   @desc: writes what is buffered and ends the file
+#   @param: trace - trace writer
+#   @return: void
+******************************************************/
+void sh_trace_close(struct Trace *trace)
+{
+    if (trace->fd == -1) {
+        return;
+    }
+    if (trace->chrome) {
+        sh_trace_printf(trace, "\n],\"displayTimeUnit\":\"ms\"}\n");
+    }
+    sh_trace_flush(trace);
+    close(trace->fd);
+    free(trace->buf);
+    free(trace->argv);
+    trace->fd = -1;
+    trace->buf = NULL;
+    trace->argv = NULL;
+}
+
+/******************************************************
+#   sh_trace_begin
+#   @desc: notes the start time, argv and redirections
+#       of the command about to run. They are copied
+#       because the argument list is rewritten by then.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_trace_begin(struct Shell *this_shell)
+{
+    struct Trace *trace = &this_shell->trace;
+    size_t need = 0;
+    size_t used = 0;
+    int i;
+
+    trace->start = sh_trace_now(trace);
+
+    for (i = 0; i < this_shell->args_count; i++) {
+        need += strlen(this_shell->arguments[i]) + 1;
+    }
+    for (i = 0; i < this_shell->redirect_count; i++) {
+        struct Redirect *redirect = &this_shell->redirects[i];
+        need += strlen(redirect->op) + (redirect->word ? strlen(redirect->word) : 0) + 1;
+    }
+    if (need > trace->argv_cap) {
+        char *grown = realloc(trace->argv, need);
+        if (grown == NULL) {
+            trace->argc = 0;
+            return;
+        }
+        trace->argv = grown;
+        trace->argv_cap = need;
+    }
+
+    /*Words then redirections, NUL separated*/
+    for (i = 0; i < this_shell->args_count; i++) {
+        size_t len = strlen(this_shell->arguments[i]) + 1;
+        memcpy(trace->argv + used, this_shell->arguments[i], len);
+        used += len;
+    }
+    for (i = 0; i < this_shell->redirect_count; i++) {
+        struct Redirect *redirect = &this_shell->redirects[i];
+        used += sprintf(trace->argv + used, "%s%s", redirect->op,
+                redirect->word ? redirect->word : "") + 1;
+    }
+    trace->argc = this_shell->args_count;
+    trace->redirect_count = this_shell->redirect_count;
+}
+
+/******************************************************
+#   sh_trace_head
+#   @desc: opens an event with the fields every event
+#       shares
+#   @param: trace - trace writer
+#   @param: phase - Chrome phase (X, b or e)
+#   @param: pid - process the event is about
+#   @param: ts - event timestamp
+#   @return: void
+******************************************************/
+static void sh_trace_head(struct Trace *trace, const char *phase, pid_t pid, long long ts)
+{
+    if (trace->chrome) {
+        sh_trace_printf(trace, "%s{\"ph\":\"%s\",\"cat\":\"command\",\"pid\":%d,\"tid\":%d,"
+                "\"ts\":%lld,", trace->events > 0 ? ",\n" : "", phase, (int)getpid(), (int)pid, ts);
+    }
+    else {
+        sh_trace_printf(trace, "{\"pid\":%d,", (int)pid);
+    }
+    trace->events++;
+}
+
+/******************************************************
+#   sh_trace_command
+#   @desc: appends the argv, redirection and ground of
+#       the command noted by sh_trace_begin
+#   @param: trace - trace writer
+#   @param: ground - 0 foreground, 1 background
+#   @return: void
+******************************************************/
+static void sh_trace_command(struct Trace *trace, int ground)
+{
+    const char *word = trace->argv;
+    int i;
+
+    sh_trace_put(trace, "\"argv\":[", 8);
+    for (i = 0; i < trace->argc; i++) {
+        if (i > 0) {
+            sh_trace_put(trace, ",", 1);
+        }
+        sh_trace_string(trace, word);
+        word += strlen(word) + 1;
+    }
+    sh_trace_put(trace, "],", 2);
+
+    if (trace->redirect_count > 0) {
+        sh_trace_put(trace, "\"redirects\":[", 13);
+        for (i = 0; i < trace->redirect_count; i++) {
+            if (i > 0) {
+                sh_trace_put(trace, ",", 1);
+            }
+            sh_trace_string(trace, word);
+            word += strlen(word) + 1;
+        }
+        sh_trace_put(trace, "],", 2);
+    }
+    sh_trace_printf(trace, "\"ground\":\"%s\"", ground ? "bg" : "fg");
+}
+
+/******************************************************
+#   sh_trace_end
+#   @desc: records the command noted by sh_trace_begin.
+#       Foreground commands are one complete event; a
+#       background command gets a start event here and an
+#       end event from sh_trace_reaped.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_trace_end(struct Shell *this_shell)
+{
+    struct Trace *trace = &this_shell->trace;
+    struct CommandUsage *usage = &this_shell->usage;
+    long long end = sh_trace_now(trace);
+
+    if (trace->argc == 0) {
+        return;
+    }
+
+    if (this_shell->ground == 1) {
+        /*Background: async begin, matched by pid*/
+        if (usage->pid <= 0) {
+            return;
+        }
+        sh_trace_head(trace, "b", usage->pid, trace->start);
+        if (trace->chrome) {
+            /*Perfetto pairs b/e events by category, id and name*/
+            sh_trace_printf(trace, "\"id\":%d,\"name\":\"background\",\"args\":{", (int)usage->pid);
+            sh_trace_command(trace, 1);
+            sh_trace_put(trace, "}}", 2);
+        }
+        else {
+            sh_trace_printf(trace, "\"event\":\"start\",\"start_us\":%lld,", trace->start);
+            sh_trace_command(trace, 1);
+            sh_trace_put(trace, "}\n", 2);
+        }
+        return;
+    }
+
+    sh_trace_head(trace, "X", usage->pid, trace->start);
+    if (trace->chrome) {
+        sh_trace_printf(trace, "\"dur\":%lld,\"name\":", end - trace->start);
+        sh_trace_string(trace, trace->argv);
+        sh_trace_put(trace, ",\"args\":{", 9);
+    }
+    else {
+        sh_trace_printf(trace, "\"event\":\"command\",\"start_us\":%lld,\"end_us\":%lld,",
+                trace->start, end);
+    }
+    sh_trace_command(trace, 0);
+    sh_trace_put(trace, ",", 1);
+    if (usage->pid > 0) {
+        sh_trace_result(trace, usage->wait_status);
+    }
+    else {
+        /*Never started, or a builtin*/
+        sh_trace_printf(trace, "\"exit\":%d", this_shell->status);
+    }
+    sh_trace_put(trace, ",", 1);
+    sh_trace_usage(trace, &usage->last);
+    sh_trace_put(trace, trace->chrome ? "}}" : "}\n", 2);
+}
+
+/******************************************************
+#   sh_trace_reaped
+#   @desc: records the end of a background job
+#   @param: trace - trace writer
+#   @param: pid - job that finished
+#   @param: status - status from wait4
+#   @param: ru - its usage from wait4
+#   @return: void
+******************************************************/
+void sh_trace_reaped(struct Trace *trace, pid_t pid, int status, const struct rusage *ru)
+{
+    long long end = sh_trace_now(trace);
+
+    sh_trace_head(trace, "e", pid, end);
+    if (trace->chrome) {
+        sh_trace_printf(trace, "\"id\":%d,\"name\":\"background\",\"args\":{", (int)pid);
+    }
+    else {
+        sh_trace_printf(trace, "\"event\":\"end\",\"end_us\":%lld,\"ground\":\"bg\",", end);
+    }
+    sh_trace_result(trace, status);
+    sh_trace_put(trace, ",", 1);
+    sh_trace_usage(trace, ru);
+    sh_trace_put(trace, trace->chrome ? "}}" : "}\n", 2);
+}
@@ -0,0 +1,182 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_usage.c
+#   Description: Per-command resource accounting. The
+#       foreground wait loops collect rusage with wait4
+#       and the wall time is taken from the monotonic
+#       clock, so status -v and the time prefix can
+#       report CPU, memory, faults and context switches.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_usage_now
+#   @desc: monotonic clock in seconds
+#   @param: n/a
+#   @return: seconds
+******************************************************/
+double sh_usage_now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/******************************************************
+#   sh_usage_seconds
+#   @desc: converts a timeval to seconds
+#   @param: tv - time value
+#   @return: seconds
+******************************************************/
+static double sh_usage_seconds(struct timeval tv)
+{
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/******************************************************
+#   sh_usage_sum
+#   @desc: adds one child's usage into a total. maxrss
+#       is the largest of the children, not a sum.
+#   @param: total - running total
+#   @param: part - usage of one child
+#   @return: void
+******************************************************/
+static void sh_usage_sum(struct rusage *total, const struct rusage *part)
+{
+    timeradd(&total->ru_utime, &part->ru_utime, &total->ru_utime);
+    timeradd(&total->ru_stime, &part->ru_stime, &total->ru_stime);
+    if (part->ru_maxrss > total->ru_maxrss) {
+        total->ru_maxrss = part->ru_maxrss;
+    }
+    total->ru_minflt += part->ru_minflt;
+    total->ru_majflt += part->ru_majflt;
+    total->ru_nvcsw += part->ru_nvcsw;
+    total->ru_nivcsw += part->ru_nivcsw;
+    total->ru_inblock += part->ru_inblock;
+    total->ru_oublock += part->ru_oublock;
+}
+
+/******************************************************
+#   sh_usage_begin
+#   @desc: starts accounting for a new command
+#   @param: usage - shell's usage tracker
+#   @return: void
+******************************************************/
+void sh_usage_begin(struct CommandUsage *usage)
+{
+    memset(&usage->pending, 0, sizeof(usage->pending));
+    usage->pid = -1;
+    usage->wait_status = 0;
+    usage->start = sh_usage_now();
+}
+
+/******************************************************
+#   sh_usage_add
+#   @desc: adds a reaped child's rusage to the command
+#       being accounted
+#   @param: usage - shell's usage tracker
+#   @param: child - rusage from wait4
+#   @return: void
+******************************************************/
+void sh_usage_add(struct CommandUsage *usage, const struct rusage *child)
+{
+    sh_usage_sum(&usage->pending, child);
+}
+
+/******************************************************
+#   sh_usage_end
+#   @desc: the foreground command is done: its usage
+#       becomes what status -v reports
+#   @param: usage - shell's usage tracker
+#   @return: void
+******************************************************/
+void sh_usage_end(struct CommandUsage *usage)
+{
+    usage->last = usage->pending;
+    usage->wall = sh_usage_now() - usage->start;
+    usage->valid = 1;
+    usage->builtin = NULL;
+}
+
+/******************************************************
+#   sh_usage_print
+#   @desc: prints the last foreground command's usage
+#       (status -v). A builtin run in the shell after it
+#       has none of its own to show.
+#   @param: usage - shell's usage tracker
+#   @return: void
+******************************************************/
+void sh_usage_print(struct CommandUsage *usage)
+{
+    const struct rusage *ru = &usage->last;
+
+    if (usage->builtin != NULL) {
+        fprintf(stdout, " %s ran in the shell: no usage recorded\n", usage->builtin);
+        fflush(stdout);
+        return;
+    }
+    if (!usage->valid) {
+        fprintf(stdout, " no command has run\n");
+        fflush(stdout);
+        return;
+    }
+
+    fprintf(stdout, " real %.3fs user %.3fs sys %.3fs\n", usage->wall,
+            sh_usage_seconds(ru->ru_utime), sh_usage_seconds(ru->ru_stime));
+    fprintf(stdout, " maxrss %ld KB minflt %ld majflt %ld\n",
+            ru->ru_maxrss, ru->ru_minflt, ru->ru_majflt);
+    fprintf(stdout, " nvcsw %ld nivcsw %ld inblock %ld oublock %ld\n",
+            ru->ru_nvcsw, ru->ru_nivcsw, ru->ru_inblock, ru->ru_oublock);
+    fflush(stdout);
+}
+
+/******************************************************
+#   sh_time_command
+#   @desc: time prefix keyword. Runs the rest of the line
+#       as a command and prints its wall, user and sys
+#       time to stderr. CPU time is the shell's own plus
+#       that of every child reaped meanwhile, so builtins
+#       and pipelines are covered as well.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_time_command(struct Shell *this_shell)
+{
+    struct rusage self_before;
+    struct rusage self_after;
+    struct rusage kids_before;
+    struct rusage kids_after;
+    double start;
+    double wall;
+    double user;
+    double sys;
+
+    /*Drop the keyword; & and redirections were already taken*/
+    this_shell->arguments++;
+    this_shell->args_count--;
+
+    getrusage(RUSAGE_SELF, &self_before);
+    getrusage(RUSAGE_CHILDREN, &kids_before);
+    start = sh_usage_now();
+
+    sh_identify_command(this_shell);
+
+    wall = sh_usage_now() - start;
+    getrusage(RUSAGE_SELF, &self_after);
+    getrusage(RUSAGE_CHILDREN, &kids_after);
+
+    user = sh_usage_seconds(self_after.ru_utime) - sh_usage_seconds(self_before.ru_utime)
+        + sh_usage_seconds(kids_after.ru_utime) - sh_usage_seconds(kids_before.ru_utime);
+    sys = sh_usage_seconds(self_after.ru_stime) - sh_usage_seconds(self_before.ru_stime)
+        + sh_usage_seconds(kids_after.ru_stime) - sh_usage_seconds(kids_before.ru_stime);
+
+    fprintf(stderr, "\nreal\t%dm%.3fs\nuser\t%dm%.3fs\nsys\t%dm%.3fs\n",
+            (int)(wall / 60), wall - 60 * (int)(wall / 60),
+            (int)(user / 60), user - 60 * (int)(user / 60),
+            (int)(sys / 60), sys - 60 * (int)(sys / 60));
+}
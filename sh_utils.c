@@ -0,0 +1,648 @@
+/******************************************************
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: sh_utils.c
+#   Description: Small utilities run as builtins: echo,
+#       printf, test/[, true, false, pwd and read. Scripts
+#       call these constantly, and running them inside the
+#       shell saves a spawn and an exec each time. Each one
+#       ends with the exit value the external program
+#       would have returned.
+#
+******************************************************/
+#include "simple_shell.h"
+
+
+/******************************************************
+#   sh_utils_done
+#   @desc: flushes output and records the exit value the
+#       same way a waited-for child's would be
+#   @param: pointer to shell object
+#   @param: code - exit value
+#   @return: void
+******************************************************/
+static void sh_utils_done(struct Shell *this_shell, int code)
+{
+    fflush(stdout);
+    sh_set_status(this_shell, W_EXITCODE(code, 0));
+}
+
+/******************************************************
+#   sh_utils_escape
+#   @desc: writes the backslash escape at text to stdout
+#   @param: text - points just after the backslash
+#   @param: stop - set to 1 on \c (stop all output)
+#   @return: number of characters consumed after '\'
+******************************************************/
+static int sh_utils_escape(const char *text, int *stop)
+{
+    int value = 0;
+    int used = 0;
+
+    switch (*text) {
+        case 'a': putchar('\a'); return 1;
+        case 'b': putchar('\b'); return 1;
+        case 'f': putchar('\f'); return 1;
+        case 'n': putchar('\n'); return 1;
+        case 'r': putchar('\r'); return 1;
+        case 't': putchar('\t'); return 1;
+        case 'v': putchar('\v'); return 1;
+        case '\\': putchar('\\'); return 1;
+        case 'c': *stop = 1; return 1;
+        case '0':
+            /*\0NNN octal*/
+            for (used = 1; used < 4 && text[used] >= '0' && text[used] <= '7'; used++) {
+                value = value * 8 + (text[used] - '0');
+            }
+            putchar(value);
+            return used;
+        default:
+            /*Not an escape: keep the backslash*/
+            putchar('\\');
+            return 0;
+    }
+}
+
+/******************************************************
+#   sh_echo_command
+#   @desc: echo [-neE] [arg ...]
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_echo_command(struct Shell *this_shell)
+{
+    char **args = this_shell->arguments;
+    int newline = 1;
+    int escapes = 0;
+    int stop = 0;
+    int i = 1;
+
+    /*Options, possibly combined as -ne*/
+    for (; i < this_shell->args_count && args[i][0] == '-' && args[i][1] != '\0'; i++) {
+        const char *opt = args[i] + 1;
+        if (strspn(opt, "neE") != strlen(opt)) {
+            break;
+        }
+        for (; *opt != '\0'; opt++) {
+            if (*opt == 'n') {
+                newline = 0;
+            }
+            else {
+                escapes = (*opt == 'e');
+            }
+        }
+    }
+
+    for (; i < this_shell->args_count && !stop; i++) {
+        const char *text = args[i];
+
+        if (!escapes) {
+            fputs(text, stdout);
+        }
+        else {
+            for (; *text != '\0' && !stop; text++) {
+                if (*text == '\\' && text[1] != '\0') {
+                    text += sh_utils_escape(text + 1, &stop);
+                }
+                else {
+                    putchar(*text);
+                }
+            }
+        }
+        if (i + 1 < this_shell->args_count && !stop) {
+            putchar(' ');
+        }
+    }
+
+    if (newline && !stop) {
+        putchar('\n');
+    }
+    sh_utils_done(this_shell, 0);
+}
+
+/******************************************************
+#   sh_printf_number
+#   @desc: converts a printf argument to a number, 'c
+#       giving the character code as the shell does
+#   @param: text - argument
+#   @param: bad - set to 1 if text is not a number
+#   @return: value
+******************************************************/
+static long long sh_printf_number(const char *text, int *bad)
+{
+    char *end;
+    long long value;
+
+    if (text[0] == '\'' || text[0] == '"') {
+        return (unsigned char)text[1];
+    }
+    errno = 0;
+    value = strtoll(text, &end, 0);
+    if (end == text || *end != '\0' || errno != 0) {
+        fprintf(stderr, "printf: %s: invalid number\n", text);
+        *bad = 1;
+    }
+    return value;
+}
+
+/******************************************************
+#   sh_printf_command
+#   @desc: printf format [arg ...]. The format is reused
+#       until every argument has been consumed.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_printf_command(struct Shell *this_shell)
+{
+    char **args = this_shell->arguments;
+    const char *format;
+    int next = 2;
+    int bad = 0;
+    int stop = 0;
+
+    if (this_shell->args_count < 2) {
+        fprintf(stderr, "printf: usage: printf format [arguments]\n");
+        sh_utils_done(this_shell, 2);
+        return;
+    }
+    format = args[1];
+
+    do {
+        const char *f;
+        int consumed = next;
+
+        for (f = format; *f != '\0' && !stop; f++) {
+            char spec[32];
+            size_t spec_len;
+            const char *arg;
+
+            if (*f == '\\' && f[1] != '\0') {
+                f += sh_utils_escape(f + 1, &stop);
+                continue;
+            }
+            if (*f != '%') {
+                putchar(*f);
+                continue;
+            }
+            if (f[1] == '%') {
+                putchar('%');
+                f++;
+                continue;
+            }
+
+            /*Copy flags, width and precision of the conversion*/
+            spec_len = 1 + strspn(f + 1, "-+ #0123456789.");
+            if (f[spec_len] == '\0' || spec_len + 3 >= sizeof(spec)) {
+                fputs(f, stdout);
+                break;
+            }
+            memcpy(spec, f, spec_len);
+            arg = next < this_shell->args_count ? args[next++] : NULL;
+
+            switch (f[spec_len]) {
+                case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+                    /*Print through the long long form of the conversion*/
+                    spec[spec_len] = 'l';
+                    spec[spec_len + 1] = 'l';
+                    spec[spec_len + 2] = f[spec_len];
+                    spec[spec_len + 3] = '\0';
+                    printf(spec, arg ? sh_printf_number(arg, &bad) : 0LL);
+                    break;
+                case 'e': case 'E': case 'f': case 'F': case 'g': case 'G':
+                    spec[spec_len] = f[spec_len];
+                    spec[spec_len + 1] = '\0';
+                    printf(spec, arg ? strtod(arg, NULL) : 0.0);
+                    break;
+                case 'c':
+                    spec[spec_len] = 'c';
+                    spec[spec_len + 1] = '\0';
+                    printf(spec, arg ? arg[0] : '\0');
+                    break;
+                case 's':
+                    spec[spec_len] = 's';
+                    spec[spec_len + 1] = '\0';
+                    printf(spec, arg ? arg : "");
+                    break;
+                default:
+                    fprintf(stderr, "printf: %%%c: invalid directive\n", f[spec_len]);
+                    bad = 1;
+                    stop = 1;
+                    break;
+            }
+            f += spec_len;
+        }
+
+        /*A format without conversions only runs once*/
+        if (next == consumed) {
+            break;
+        }
+    } while (next < this_shell->args_count && !stop);
+
+    sh_utils_done(this_shell, bad);
+}
+
+/******************************************************
+#   sh_test_unary
+#   @desc: evaluates a unary test operator
+#   @param: op - operator such as -f
+#   @param: arg - operand
+#   @return: 1 true, 0 false, -1 if op is unknown
+******************************************************/
+static int sh_test_unary(const char *op, const char *arg)
+{
+    struct stat info;
+
+    if (op[0] != '-' || op[1] == '\0' || op[2] != '\0') {
+        return -1;
+    }
+
+    switch (op[1]) {
+        case 'n': return arg[0] != '\0';
+        case 'z': return arg[0] == '\0';
+        case 'e': return stat(arg, &info) == 0;
+        case 'f': return stat(arg, &info) == 0 && S_ISREG(info.st_mode);
+        case 'd': return stat(arg, &info) == 0 && S_ISDIR(info.st_mode);
+        case 'p': return stat(arg, &info) == 0 && S_ISFIFO(info.st_mode);
+        case 'L': case 'h': return lstat(arg, &info) == 0 && S_ISLNK(info.st_mode);
+        case 's': return stat(arg, &info) == 0 && info.st_size > 0;
+        case 'r': return access(arg, R_OK) == 0;
+        case 'w': return access(arg, W_OK) == 0;
+        case 'x': return access(arg, X_OK) == 0;
+        case 't': return isatty(atoi(arg));
+        default: return -1;
+    }
+}
+
+/******************************************************
+#   sh_test_binary
+#   @desc: evaluates a binary test operator
+#   @param: left - left operand
+#   @param: op - operator such as = or -lt
+#   @param: right - right operand
+#   @param: bad - set to 1 on a non-integer operand
+#   @return: 1 true, 0 false, -1 if op is unknown
+******************************************************/
+static int sh_test_binary(const char *left, const char *op, const char *right, int *bad)
+{
+    long long a;
+    long long b;
+    char *end;
+
+    if (strcmp(op, "=") == 0 || strcmp(op, "==") == 0) {
+        return strcmp(left, right) == 0;
+    }
+    if (strcmp(op, "!=") == 0) {
+        return strcmp(left, right) != 0;
+    }
+    if (op[0] != '-' || strlen(op) != 3) {
+        return -1;
+    }
+
+    a = strtoll(left, &end, 10);
+    if (end == left || *end != '\0') {
+        fprintf(stderr, "test: %s: integer expression expected\n", left);
+        *bad = 1;
+        return 0;
+    }
+    b = strtoll(right, &end, 10);
+    if (end == right || *end != '\0') {
+        fprintf(stderr, "test: %s: integer expression expected\n", right);
+        *bad = 1;
+        return 0;
+    }
+
+    if (strcmp(op, "-eq") == 0) return a == b;
+    if (strcmp(op, "-ne") == 0) return a != b;
+    if (strcmp(op, "-lt") == 0) return a < b;
+    if (strcmp(op, "-le") == 0) return a <= b;
+    if (strcmp(op, "-gt") == 0) return a > b;
+    if (strcmp(op, "-ge") == 0) return a >= b;
+    return -1;
+}
+
+/*State of a test expression being evaluated*/
+struct TestExpr
+{
+    char **argv;
+    int argc;
+    int pos;
+    int bad; /*syntax or number error*/
+};
+
+static int sh_test_or(struct TestExpr *expr);
+
+/******************************************************
+#   sh_test_primary
+#   @desc: ! expr, ( expr ), unary, binary or a string
+#   @param: expr - expression state
+#   @return: 1 true, 0 false
+******************************************************/
+static int sh_test_primary(struct TestExpr *expr)
+{
+    char **argv = expr->argv;
+    int left = expr->argc - expr->pos;
+    int result;
+
+    if (left <= 0) {
+        expr->bad = 1;
+        return 0;
+    }
+
+    if (strcmp(argv[expr->pos], "!") == 0 && left > 1) {
+        expr->pos++;
+        return !sh_test_primary(expr);
+    }
+
+    /*Binary operator takes precedence, so = = = works*/
+    if (left >= 3) {
+        result = sh_test_binary(argv[expr->pos], argv[expr->pos + 1], argv[expr->pos + 2], &expr->bad);
+        if (result != -1) {
+            expr->pos += 3;
+            return result;
+        }
+    }
+
+    if (strcmp(argv[expr->pos], "(") == 0 && left > 2) {
+        expr->pos++;
+        result = sh_test_or(expr);
+        if (expr->pos >= expr->argc || strcmp(argv[expr->pos], ")") != 0) {
+            expr->bad = 1;
+            return 0;
+        }
+        expr->pos++;
+        return result;
+    }
+
+    if (left >= 2) {
+        result = sh_test_unary(argv[expr->pos], argv[expr->pos + 1]);
+        if (result != -1) {
+            expr->pos += 2;
+            return result;
+        }
+    }
+
+    /*A lone word is true when not empty*/
+    return argv[expr->pos++][0] != '\0';
+}
+
+/******************************************************
+#   sh_test_and
+#   @desc: primary [-a primary ...]
+#   @param: expr - expression state
+#   @return: 1 true, 0 false
+******************************************************/
+static int sh_test_and(struct TestExpr *expr)
+{
+    int result = sh_test_primary(expr);
+
+    while (expr->pos < expr->argc && strcmp(expr->argv[expr->pos], "-a") == 0) {
+        expr->pos++;
+        result = sh_test_primary(expr) && result;
+    }
+    return result;
+}
+
+/******************************************************
+#   sh_test_or
+#   @desc: and [-o and ...]
+#   @param: expr - expression state
+#   @return: 1 true, 0 false
+******************************************************/
+static int sh_test_or(struct TestExpr *expr)
+{
+    int result = sh_test_and(expr);
+
+    while (expr->pos < expr->argc && strcmp(expr->argv[expr->pos], "-o") == 0) {
+        expr->pos++;
+        result = sh_test_and(expr) || result;
+    }
+    return result;
+}
+
+/******************************************************
+#   sh_test_command
+#   @desc: test expr, or [ expr ]. Exit value 0 when the
+#       expression is true, 1 when false, 2 on error.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_test_command(struct Shell *this_shell)
+{
+    struct TestExpr expr;
+    int result;
+
+    expr.argv = this_shell->arguments + 1;
+    expr.argc = this_shell->args_count - 1;
+    expr.pos = 0;
+    expr.bad = 0;
+
+    /*[ needs its closing ]*/
+    if (strcmp(this_shell->arguments[0], "[") == 0) {
+        if (expr.argc == 0 || strcmp(expr.argv[expr.argc - 1], "]") != 0) {
+            fprintf(stderr, "[: missing ]\n");
+            sh_utils_done(this_shell, 2);
+            return;
+        }
+        expr.argc--;
+    }
+
+    /*No expression is false*/
+    if (expr.argc == 0) {
+        sh_utils_done(this_shell, 1);
+        return;
+    }
+
+    result = sh_test_or(&expr);
+    if (expr.pos != expr.argc) {
+        fprintf(stderr, "%s: too many arguments\n", this_shell->arguments[0]);
+        expr.bad = 1;
+    }
+
+    sh_utils_done(this_shell, expr.bad ? 2 : !result);
+}
+
+/******************************************************
+#   sh_true_command
+#   @desc: true: exit value 0
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_true_command(struct Shell *this_shell)
+{
+    sh_utils_done(this_shell, 0);
+}
+
+/******************************************************
+#   sh_false_command
+#   @desc: false: exit value 1
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_false_command(struct Shell *this_shell)
+{
+    sh_utils_done(this_shell, 1);
+}
+
+/******************************************************
+#   sh_pwd_command
+#   @desc: prints the working directory
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_pwd_command(struct Shell *this_shell)
+{
+    char cwd[PATH_MAX];
+
+    if (getcwd(cwd, sizeof(cwd)) == NULL) {
+        fprintf(stderr, "pwd: %s\n", strerror(errno));
+        sh_utils_done(this_shell, 1);
+        return;
+    }
+    fprintf(stdout, "%s\n", cwd);
+    sh_utils_done(this_shell, 0);
+}
+
+/******************************************************
+#   sh_read_byte
+#   @desc: next byte of read's stdin. When stdin is where
+#       the shell reads its commands, the lines it has
+#       read ahead come first, so read gets the line after
+#       its own, not whatever follows the buffer.
+#   @param: pointer to shell object
+#   @param: shared - 1 if stdin is the command input
+#   @param: c - receives the byte
+#   @return: as read(2)
+******************************************************/
+static ssize_t sh_read_byte(struct Shell *this_shell, int shared, char *c)
+{
+    struct InputReader *input = &this_shell->input;
+
+    if (shared && input->start < input->end) {
+        *c = input->buf[input->start++];
+        if (input->scanned < input->start) {
+            input->scanned = input->start;
+        }
+        return 1;
+    }
+    return read(0, c, 1);
+}
+
+/******************************************************
+#   sh_read_command
+#   @desc: read [-r] [name ...]. Reads one line from
+#       stdin a byte at a time, so nothing past the line
+#       is taken from a shared descriptor, and splits it
+#       into the named variables (REPLY by default); the
+#       last name gets the rest of the line.
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_read_command(struct Shell *this_shell)
+{
+    char **names = this_shell->arguments + 1;
+    int name_count = this_shell->args_count - 1;
+    char *reply = "REPLY";
+    char *line = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+    int raw = 0;
+    int ended = 0;
+    /*stdin is the script, unless this command redirected it*/
+    int shared = this_shell->input.fd == 0;
+    char *cursor;
+    int i;
+
+    for (i = 0; i < this_shell->redirect_count; i++) {
+        if (this_shell->redirects[i].fd == 0) {
+            shared = 0;
+        }
+    }
+
+    if (name_count > 0 && strcmp(names[0], "-r") == 0) {
+        raw = 1;
+        names++;
+        name_count--;
+    }
+    if (name_count == 0) {
+        names = &reply;
+        name_count = 1;
+    }
+    for (i = 0; i < name_count; i++) {
+        if (!sh_env_valid_name(names[i], strlen(names[i]))) {
+            fprintf(stderr, "read: %s: not a valid name\n", names[i]);
+            sh_utils_done(this_shell, 2);
+            return;
+        }
+    }
+
+    /*Collect the line*/
+    while (1) {
+        char c;
+        ssize_t got = sh_read_byte(this_shell, shared, &c);
+
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            break;
+        }
+        if (c == '\n') {
+            ended = 1;
+            break;
+        }
+        if (c == '\\' && !raw) {
+            /*Backslash keeps the next char, newline continues the line*/
+            got = sh_read_byte(this_shell, shared, &c);
+            if (got <= 0 || c == '\n') {
+                continue;
+            }
+        }
+        if (len + 2 > cap) {
+            char *grown;
+            cap = cap ? cap * 2 : 128;
+            grown = realloc(line, cap);
+            if (grown == NULL) {
+                break;
+            }
+            line = grown;
+        }
+        line[len++] = c;
+    }
+
+    if (line == NULL) {
+        line = strdup("");
+        if (line == NULL) {
+            sh_utils_done(this_shell, 1);
+            return;
+        }
+    }
+    line[len] = '\0';
+
+    /*Split on blanks, the last name keeps the remainder*/
+    cursor = line + strspn(line, " \t");
+    for (i = 0; i < name_count; i++) {
+        char *word = cursor;
+
+        if (i < name_count - 1) {
+            size_t word_len = strcspn(cursor, " \t");
+            cursor += word_len;
+            if (*cursor != '\0') {
+                *cursor++ = '\0';
+                cursor += strspn(cursor, " \t");
+            }
+        }
+        else {
+            /*Trim trailing blanks*/
+            char *end = word + strlen(word);
+            while (end > word && (end[-1] == ' ' || end[-1] == '\t')) {
+                *--end = '\0';
+            }
+        }
+        sh_env_set(&this_shell->env, names[i], word, ENV_KEEP);
+    }
+
+    free(line);
+    /*End of input before a newline fails, as in other shells*/
+    sh_utils_done(this_shell, ended ? 0 : 1);
+}
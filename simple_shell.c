@@ -8,6 +8,7 @@
 ******************************************************/
 #include "simple_shell.h"
 
+extern char **environ;
 
 /******************************************************
 #   Shell Structure Functions
@@ -22,18 +23,63 @@
 Shell* sh_init()
 {
 
-    /*Allocate memory for shell and args*/
+    /*Allocate memory for shell and input*/
     Shell *the_shell = malloc(sizeof(Shell));
-    the_shell->user_input = malloc(MAX_LEN* sizeof(char*));
-    the_shell->arguments = (char**)malloc(MAX_ARGS*sizeof(char*));
-    the_shell->bg_count=0;
-
-    int i = 0;
-
-    /*Allocate memory for array of strings*/
-    for (i = 0; i < MAX_ARGS; i++) 
-    {
-        the_shell->arguments[i] = (char*)malloc(20 * sizeof(char));
+    the_shell->input.buf = NULL;
+    the_shell->user_input = NULL;
+    the_shell->input_len = 0;
+    the_shell->arguments = NULL;
+    the_shell->args_count = 0;
+    sh_jobs_init(&the_shell->jobs);
+    the_shell->loop.epoll_fd = -1;
+    the_shell->loop.signal_fd = -1;
+    the_shell->loop.input_watch = NULL;
+    the_shell->loop.child_pending = 0;
+    the_shell->loop.interrupted = 0;
+    the_shell->usage.valid = 0;
+    the_shell->usage.builtin = NULL;
+    the_shell->trace.fd = -1;
+    the_shell->trace.argv = NULL;
+    the_shell->trace.argv_cap = 0;
+    the_shell->trace.argc = 0;
+    the_shell->trace.redirect_count = 0;
+    the_shell->redirects = NULL;
+    the_shell->redirect_count = 0;
+    the_shell->history.fd = -1;
+    the_shell->history.index_fd = -1;
+    the_shell->history.data = NULL;
+    the_shell->history.index = NULL;
+    the_shell->status = 0;
+    the_shell->signaled = 0;
+    the_shell->shell_pid = getpid();
+    the_shell->last_bg = 0;
+    sh_env_init(&the_shell->env, environ);
+    sh_arena_init(&the_shell->arena, ARENA_BLOCK_SIZE);
+    sh_hash_init(&the_shell->path_cache);
+    the_shell->path_cache.env = &the_shell->env;
+    sh_edit_init(&the_shell->editor);
+    sh_complete_init(&the_shell->completer);
+    the_shell->completer.env = &the_shell->env;
+    sh_dircache_init(&the_shell->dircache);
+    the_shell->completer.listings = &the_shell->dircache;
+    the_shell->glob.words = NULL;
+    the_shell->glob.paths = NULL;
+    the_shell->glob.count = 0;
+    the_shell->glob.cap = 0;
+    the_shell->line.root = -1;
+    the_shell->ground = 0;
+    the_shell->control.enabled = 0;
+    the_shell->control.tty_fd = -1;
+    the_shell->control.shell_pgid = getpgrp();
+    the_shell->job_ast = NULL;
+    the_shell->job_node = -1;
+    sh_scripts_init(&the_shell->scripts);
+    sh_limits_init(&the_shell->limits);
+    sh_captures_init(&the_shell->captures);
+    sh_timers_init(&the_shell->timers);
+    the_shell->timed_out = 0;
+    if (sh_builtin_init() == -1) {
+        fprintf(stderr, "simple_shell: builtin table has colliding names\n");
     }
 
     return the_shell;
@@ -47,6 +93,23 @@ Shell* sh_init()
 ******************************************************/
 void sh_free(struct Shell *this_shell)
 {
+    sh_edit_free(&this_shell->editor);
+    sh_complete_free(&this_shell->completer);
+    sh_dircache_free(&this_shell->dircache);
+    sh_glob_free(&this_shell->glob);
+    sh_scripts_free(&this_shell->scripts);
+    sh_limits_free(&this_shell->limits);
+    sh_captures_free(this_shell);
+    sh_timers_free(this_shell);
+    sh_hash_free(&this_shell->path_cache);
+    sh_env_free(&this_shell->env);
+    sh_trace_close(&this_shell->trace);
+    sh_history_close(&this_shell->history);
+    sh_arena_free(&this_shell->arena);
+    sh_jobs_free(&this_shell->jobs);
+    sh_loop_unwatch(this_shell, this_shell->loop.input_watch);
+    sh_loop_free(&this_shell->loop);
+    sh_input_close(&this_shell->input);
     free(this_shell);
 }
 
@@ -55,109 +118,211 @@ void sh_free(struct Shell *this_shell)
 ******************************************************/
 /******************************************************
 #   sh_get_commands
-#   @desc: prompts cml and reads commands
+#   @desc: prompts cml (terminal only) and reads the next
+#       line of commands
 #   @param: pointer to shell object
-#   @return:
+#   @return: 1 if a line was read, 0 at end of input
 ******************************************************/
-void sh_get_commands(struct Shell *this_shell)
+int sh_get_commands(struct Shell *this_shell)
 {
-    /*Prompt user for commands*/
-    fprintf(stdout, ": ");
-    fflush(stdout);
-    fgets(this_shell->user_input, 2048, stdin);
+
+    return sh_get_line(this_shell, ": ");
+
+}
+
+/******************************************************
+#   sh_get_line
+#   @desc: prompts (terminal only) and runs the event
+#       loop until a full line is buffered, typed through
+#       the line editor on a terminal. Background
+#       jobs that finish meanwhile are reported right away
+#       and CTRL-C abandons the line being typed. Also
+#       used for here-document lines.
+#   @param: pointer to shell object
+#   @param: prompt - shown when input is a terminal
+#   @return: 1 if a line was read, 0 at end of input
+******************************************************/
+int sh_get_line(struct Shell *this_shell, const char *prompt)
+{
+    struct InputReader *input = &this_shell->input;
+    struct EventLoop *loop = &this_shell->loop;
+    int prompted = 0;
+    int waited = 0;
+
+    while (1) {
+        this_shell->user_input = sh_input_next(input, &this_shell->input_len);
+        if (this_shell->user_input != NULL) {
+            break;
+        }
+        if (input->eof) {
+            return 0;
+        }
+
+        /*Prompt user for commands, through the editor on a terminal*/
+        if (input->interactive && !prompted) {
+            fflush(stdout);
+            if (sh_edit_begin(this_shell, prompt) == -1) {
+                fprintf(stdout, "%s", prompt);
+                fflush(stdout);
+            }
+            prompted = 1;
+        }
+
+        /*Files and strings never block: read straight away*/
+        if (loop->input_watch == NULL) {
+            sh_input_fill(input);
+            continue;
+        }
+
+        /*CTRL-C that reached the shell during a command is not for this line*/
+        if (!waited) {
+            sh_loop_signals(loop);
+            loop->interrupted = 0;
+            waited = 1;
+        }
+        sh_loop_wait(this_shell, -1);
+
+        /*A child finished while we waited: notice goes above the line*/
+        if (loop->child_pending) {
+            sh_edit_hide(&this_shell->editor);
+            if (sh_catch_bg(this_shell) > 0 && !this_shell->editor.active) {
+                prompted = 0;
+            }
+            sh_edit_redraw(&this_shell->editor);
+        }
+        /*CTRL-C drops the line being typed*/
+        if (loop->interrupted) {
+            loop->interrupted = 0;
+            sh_edit_cancel(&this_shell->editor);
+            fprintf(stdout, "\n");
+            prompted = 0;
+        }
+    }
+
+    return 1;
 
 }
 
 /******************************************************
 #   sh_parse_args
-#   @desc: parses the command stored in  user's user_input into
-#       individual arguments stored in user's arguments
+#   @desc: compiles the command line stored in user's
+#       user_input into this_shell->line, after history
+#       expansion. The line is added to the history. The
+#       compiled line lives in the shell's arena until
+#       the next call.
 #   @param: pointer to shell object
 #   @return: void
 ******************************************************/
 void sh_parse_args(struct Shell *this_shell)
 {
 
-    /*point to the user input*/
     char *buf = this_shell->user_input;
-    char **args = this_shell->arguments;
-    int num = 0;
-
+    size_t len = this_shell->input_len;
+    char *expanded;
+    int result;
+
+    /*Release the previous command's arguments*/
+    sh_arena_reset(&this_shell->arena);
+
+    if (this_shell->history.fd != -1) {
+        /*Replace !n, !! and !prefix, showing the result*/
+        result = sh_history_expand(&this_shell->history, &this_shell->arena, buf, len, &expanded, &len);
+        if (result == -1) {
+            this_shell->line.root = -1;
+            return;
+        }
+        if (result == 1) {
+            buf = expanded;
+            fprintf(stdout, "%.*s", (int)len, buf);
+            if (len == 0 || buf[len - 1] != '\n') {
+                fprintf(stdout, "\n");
+            }
+            fflush(stdout);
+        }
 
-    while ((*buf != '\0')) {
+        /*Record the line without its newline*/
+        while (len > 0 && (buf[len - 1] == '\n' || buf[len - 1] == ' ' || buf[len - 1] == '\t')) {
+            len--;
+        }
+        if (len > 0) {
+            sh_history_add(&this_shell->history, buf, len);
+        }
+    }
 
+    this_shell->args_count = 0;
+    result = sh_ast_compile(this_shell, &this_shell->arena, buf, len, &this_shell->line);
 
-         /*Strip whitespace*/
-        while ((*buf == ' ') || (*buf == '\n')) {
-            *buf++ = '\0';
-        }
+    if (result != PARSE_OK) {
+        sh_ast_error(&this_shell->line);
+        /*Treat the line as blank*/
+        this_shell->line.root = -1;
+        this_shell->status = 1;
+        this_shell->signaled = 0;
+    }
+}
 
-        /*Save the argument.*/
-        *args++ = buf;
+/******************************************************
+#   sh_assignments
+#   @desc: runs a command made only of NAME=value words
+#       by setting each variable (exported ones stay
+#       exported)
+#   @param: pointer to shell object
+#   @return: 1 if the command was assignments, 0 if not
+******************************************************/
+static int sh_assignments(struct Shell *this_shell)
+{
+    int i;
 
-       /*Skip ober valid arguments*/
-        while ((*buf != '\0') && (*buf != ' ') && (*buf != '\n')) {
-            buf++;
+    for (i = 0; i < this_shell->args_count; i++) {
+        const char *word = this_shell->arguments[i];
+        const char *equals = strchr(word, '=');
+        if (sh_is_operator(word) || equals == NULL || !sh_env_valid_name(word, equals - word)) {
+            return 0;
         }
-
-        num++;
     }
 
-    num--;
-    this_shell->args_count = num;
-    *args--;
-    *args = NULL;
+    for (i = 0; i < this_shell->args_count; i++) {
+        sh_env_assign(&this_shell->env, this_shell->arguments[i], ENV_KEEP);
+    }
+    this_shell->status = 0;
+    this_shell->signaled = 0;
+    return 1;
 }
 
 /******************************************************
 #   sh_identify_command
 #   @desc: identifies whether built in command, blank line
-#       comment, or unix command
+#       comment, or unix command, and runs it. Executes
+#       the pipeline and simple command nodes of a
+#       compiled line, whose words are in arguments.
 #   @param: pointer to shell object
 #   @return: void
 ******************************************************/
 void sh_identify_command(struct Shell *this_shell)
 {
 
-    char *cd_str = "cd";
-    int cd_str_len = (unsigned)strlen(cd_str);
-    char *exit_str = "exit";
-    int exit_str_len = (unsigned)strlen(exit_str);
-    char *status_str = "status";
-    int status_str_len = (unsigned)strlen(status_str);
-
-    int command_len = (unsigned)strlen(this_shell->user_input);
-    /*Make copy of user input w/out \n */
-    char args[command_len - 1];
-    strcpy(args, this_shell->user_input);
-
-    /*Command was blank line*/
-    if (args[0] == '\0') {
-        //printf("User typed a blank line\n");
-        /*Return to command line*/
-        return;
-    }
-    else if (args[0] == '#') { /*Command was a comment*/
-        //printf("User typed a comment\n");
+    const struct Builtin *builtin;
+
+    /*Command was blank line or a comment*/
+    if (this_shell->args_count == 0) {
         /*Return to command line*/
         return;
     }
-    /*Command is CD*/
-    else if (strncmp(args, cd_str, cd_str_len) == 0) {
 
-        /*Send command to function*/
-        sh_change_directory(this_shell);
+    /*NAME=value words on their own set shell variables*/
+    if (sh_assignments(this_shell)) {
+        return;
     }
-    /*Command is to exit*/
-    else if (strncmp(args, exit_str, exit_str_len) == 0) {
-        //printf("User wants to exit\n");
-        exitShell(this_shell);
 
+    /*Command is a builtin: exact name only. Pipeline
+      stages always run as programs, but a prefix like
+      time or limit takes the whole pipeline.*/
+    builtin = sh_builtin_find(this_shell->arguments[0]);
+    if (builtin != NULL && (builtin->flags & BUILTIN_PREFIX) == 0 && sh_has_pipeline(this_shell)) {
+        builtin = NULL;
     }
-    /*Command is status*/
-    else if (strncmp(args, status_str, status_str_len) == 0) {
-
-        sh_command_status(this_shell);
+    if (builtin != NULL) {
+        sh_builtin_run(this_shell, builtin);
     }
     /*Command was unix command*/
     else {
@@ -170,58 +335,35 @@ void sh_identify_command(struct Shell *this_shell)
 
 /******************************************************
 #   sh_command_ground
-#   @desc: identifies whether unix command should be a
-#       background command or foreground, and if foreground
-#       whether there should be redirection
+#   @desc: prepares a command whose ground (a trailing &)
+#       was set by the compiled line: moves its
+#       redirections out of the argument list. Pipelines
+#       collect redirections per stage instead.
 #   @param: pointer to shell object
 #   @return: void
 ******************************************************/
 void sh_command_ground(struct Shell *this_shell)
 {
 
-    char *amp_str = "&";
-    int amLen = (unsigned)strlen(amp_str);
-
-    char *rdStr = "<";
-    char *wrStr = ">";
+    char **args = this_shell->arguments;
 
-    if (this_shell->args_count == 3) {
-
-        /*Background command*/
-        if (strncmp(this_shell->arguments[2], amp_str, amLen) == 0) {
-            /*Set ground to true*/
-            this_shell->ground = 1;
-        }
-        else {
-            /*Set ground to false*/
-            this_shell->ground = 0;
-        }
-        /*Read command*/
-        if (strncmp(this_shell->arguments[1], rdStr, amLen) == 0) {
-            /*Set read to true*/
-            this_shell->read = 1;
-        }
-        else {
-            /*Set read to false*/
-            this_shell->read = 0;
-        }
-        /*Write command*/
-        if (strncmp(this_shell->arguments[1], wrStr, amLen) == 0) {
-            /*Set write to true*/
-            this_shell->write = 1;
-        }
-        else {
-            /*Set write to false*/
-            this_shell->write = 0;
-        }
+    this_shell->redirects = NULL;
+    this_shell->redirect_count = 0;
 
+    if (this_shell->args_count == 0 || sh_has_pipeline(this_shell)) {
+        return;
     }
-    else {
 
-        /*Command is foreground w no redirection*/
-        this_shell->ground = 0;
-        this_shell->read = 0;
-        this_shell->write = 0;
+    if (sh_redirect_extract(this_shell, args, &this_shell->args_count,
+                &this_shell->redirects, &this_shell->redirect_count) == -1
+            || (this_shell->args_count == 0 && this_shell->redirect_count > 0)) {
+        fprintf(stdout, "simple_shell: syntax error in redirection\n");
+        fflush(stdout);
+        /*Treat the line as blank*/
+        this_shell->args_count = 0;
+        this_shell->redirect_count = 0;
+        this_shell->status = 1;
+        this_shell->signaled = 0;
     }
 
 }
@@ -242,7 +384,8 @@ void sh_change_directory(struct Shell *this_shell)
     if (this_shell->args_count == 1) {
 
         /*Check to ensure it worked*/
-        if (chdir(getenv("HOME")) == -1) {
+        const char *home = sh_env_get(&this_shell->env, "HOME");
+        if (home == NULL || chdir(home) == -1) {
             fprintf(stdout, "cd unable to go home\n");
             fflush(stdout);
         }
@@ -264,7 +407,8 @@ void sh_change_directory(struct Shell *this_shell)
 
 /******************************************************
 #   sh_command_status
-#   @desc: print the status of last command to console
+#   @desc: print the status of last command to console,
+#       with its resource usage for status -v
 #   @param: pointer to shell object
 #   @return: void
 ******************************************************/
@@ -272,23 +416,126 @@ void sh_command_status(struct Shell *this_shell)
 {
 
     /*Print the cstatus*/
-    fprintf(stdout, " %s \n", g_last_status);
+    if (this_shell->signaled) {
+        fprintf(stdout, " terminated by signal %d \n", this_shell->status);
+    }
+    else if (this_shell->status == TIMEOUT_STATUS && this_shell->timed_out > 0) {
+        fprintf(stdout, " timed out after %gs \n", this_shell->timed_out);
+    }
+    else {
+        fprintf(stdout, " exit value %d \n", this_shell->status);
+    }
+    fflush(stdout);
+
+    if (this_shell->args_count > 1 && strcmp(this_shell->arguments[1], "-v") == 0) {
+        sh_usage_print(&this_shell->usage);
+    }
+
+}
+/******************************************************
+#   sh_hash_command
+#   @desc: manages the command path cache
+#       hash        list cached commands with hit counts
+#       hash -l     list in reusable form
+#       hash -r     forget all cached commands
+#       hash -p path name   cache path as name
+#       hash name   resolve and cache name
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_hash_command(struct Shell *this_shell)
+{
+
+    char **args = this_shell->arguments;
+    struct PathCache *cache = &this_shell->path_cache;
+    int i;
+
+    this_shell->status = 0;
+
+    /*No args: list the table*/
+    if (this_shell->args_count == 1) {
+        sh_hash_list(cache, 0);
+    }
+    else if (strcmp(args[1], "-r") == 0) {
+        sh_hash_clear(cache);
+    }
+    else if (strcmp(args[1], "-l") == 0) {
+        sh_hash_list(cache, 1);
+    }
+    else if (strcmp(args[1], "-p") == 0) {
+        if (this_shell->args_count != 4) {
+            fprintf(stdout, "hash: usage: hash -p path name\n");
+            this_shell->status = 1;
+        }
+        else {
+            sh_hash_add(cache, args[3], args[2]);
+        }
+    }
+    else {
+        /*Resolve each name now*/
+        for (i = 1; i < this_shell->args_count; i++) {
+            if (sh_hash_lookup(cache, args[i]) == NULL) {
+                fprintf(stdout, "hash: %s: not found\n", args[i]);
+                this_shell->status = 1;
+            }
+        }
+    }
     fflush(stdout);
 
+    this_shell->signaled = 0;
+
 }
+
 /******************************************************
 #   exitShell
-#   @desc: terminates bg processes and exits shell
+#   @desc: exit [N]. Terminates bg processes, closes
+#       the trace, history and the rest as the end of
+#       input does, and exits shell with N, or with the
+#       last command's status without one
 #   @param: pointer to shell object
 #   @return:
 ******************************************************/
 void exitShell(struct Shell *this_shell) {
 
+    int code = sh_exit_status(this_shell);
+
+    if (this_shell->args_count > 1) {
+        char *end;
+        long value = strtol(this_shell->arguments[1], &end, 10);
+        if (this_shell->args_count > 2 || *end != '\0' || end == this_shell->arguments[1]) {
+            fprintf(stdout, "exit: usage: exit [N]\n");
+            fflush(stdout);
+            this_shell->status = 1;
+            this_shell->signaled = 0;
+            return;
+        }
+        code = (int)(value & 255);
+    }
+
     /*Send kill signals to all child processes*/
     sh_kill_zombies(this_shell);
 
-    /*Exit with 0 to stop loop*/
-    exit(0);
+    /*Finish the trace file and restore the terminal*/
+    sh_free(this_shell);
+
+    /*Exit to stop loop*/
+    exit(code);
+}
+
+/******************************************************
+#   sh_exit_status
+#   @desc: status the shell exits with after the last
+#       command: its exit value, or 128 plus the signal
+#       that killed it
+#   @param: pointer to shell object
+#   @return: exit status
+******************************************************/
+int sh_exit_status(struct Shell *this_shell)
+{
+    if (this_shell->signaled) {
+        return 128 + this_shell->status;
+    }
+    return this_shell->status & 255;
 }
 
 
@@ -297,18 +544,34 @@ void exitShell(struct Shell *this_shell) {
 ******************************************************/
 /******************************************************
 #   sh_other_command
-#   @desc: determines whether command is foreground,
-#       foreground with redirection, or background and
+#   @desc: determines whether command is a pipeline,
+#       foreground, foreground with redirection, or
+#       background and
 #       call appropriate function to execute command
 #   @param: pointer to shell object
 #   @return: void
 ******************************************************/
 void sh_other_command(struct Shell *this_shell) {
 
+    /*Job gets a cgroup of its own if the session has a root for them*/
+    int own_group = sh_limit_begin(this_shell);
+    /*And a deadline if one is in effect*/
+    int own_deadline = sh_deadline_begin(this_shell);
+
+    this_shell->timed_out = 0;
+
+    /*Account resources of foreground commands*/
+    sh_usage_begin(&this_shell->usage);
+    if (this_shell->trace.fd != -1) {
+        sh_trace_begin(this_shell);
+    }
 
     /*Determine type of command*/
-    if (this_shell->ground == 0) {
-        if (this_shell->read == 0 && this_shell->write == 0) {
+    if (sh_has_pipeline(this_shell)) {
+        sh_pipeline_process(this_shell);
+    }
+    else if (this_shell->ground == 0) {
+        if (this_shell->redirect_count == 0) {
             sh_reg_fg_process(this_shell);
         }
         else {
@@ -321,166 +584,156 @@ void sh_other_command(struct Shell *this_shell) {
         sh_bg_process(this_shell);
     }
 
+    if (this_shell->ground == 0) {
+        sh_usage_end(&this_shell->usage);
+    }
+    if (this_shell->trace.fd != -1) {
+        sh_trace_end(this_shell);
+    }
+    /*Still here unless the job went into the job table*/
+    if (own_group) {
+        sh_limit_end(this_shell);
+    }
+    if (own_deadline) {
+        sh_deadline_end(this_shell);
+    }
+
 }
 
 /******************************************************
 #   sh_execute_command
-#   @desc: executes command stored in user's first argument
-#       and prints to console if it fails
+#   @desc: launches the command in argv through the launch
+#       layer and prints to console if it fails
 #   @param: pointer to shell object
-#   @return: void
+#   @param: argv - command and its arguments
+#   @param: in_fd - descriptor for stdin, -1 to inherit
+#   @param: out_fd - descriptor for stdout, -1 to inherit
+#   @param: redirects - opened redirections for the child
+#   @param: redirect_count - number of redirections
+#   @param: pgid - process group for sh_launch; a new
+#       foreground group is given the terminal
+#   @return: pid of the child, -1 if launch failed
 ******************************************************/
-void sh_execute_command(struct Shell *this_shell)
+pid_t sh_execute_command(struct Shell *this_shell, char **argv, int in_fd, int out_fd,
+        struct Redirect *redirects, int redirect_count, pid_t pgid)
 {
 
-        /*execute command stored in first argument*/
-    if (execvp(this_shell->arguments[0], this_shell->arguments)) {
+    pid_t child_PID = -1;
+    char *name = argv[0];
+    const char *path = sh_hash_lookup(&this_shell->path_cache, name);
+    int result = ENOENT;
+    int tries;
+    /*Background jobs keep SIGINT ignored unless they can be brought to the fore*/
+    int background = this_shell->ground && !this_shell->control.enabled;
+    /*A new foreground group takes the terminal*/
+    int tty_fd = (this_shell->ground == 0 && pgid == 0 && this_shell->control.enabled)
+        ? this_shell->control.tty_fd : -1;
+
+    /*Output written so far must come before the child's*/
+    fflush(stdout);
+
+    /*execute command stored in first argument*/
+    for (tries = 0; path != NULL && tries < 2; tries++) {
+        char **helper = sh_limit_exec_argv(this_shell, path, argv);
+
+        if (helper == NULL) {
+            result = sh_launch(path, argv, sh_env_envp(&this_shell->env), in_fd, out_fd, redirects, redirect_count,
+                    background, pgid, tty_fd, &child_PID);
+        }
+        else {
+            /*Limits go on before the program runs: start it through the exec helper*/
+            result = access(path, X_OK) == 0
+                ? sh_launch(LIMIT_EXEC_PATH, helper, sh_env_envp(&this_shell->env), in_fd, out_fd, redirects,
+                        redirect_count, background, pgid, tty_fd, &child_PID)
+                : errno;
+            free(helper);
+        }
+
+        /*Cached path went away: resolve again once*/
+        if (result != ENOENT || path == name) {
+            break;
+        }
+        sh_hash_forget(&this_shell->path_cache, name);
+        path = sh_hash_lookup(&this_shell->path_cache, name);
+    }
+
+    if (result != 0) {
         /*Command was not successful*/
-        fflush(stdout);
-        fprintf(stdout, "%s: no such file or directory\n", this_shell->arguments[0]);
+        fprintf(stdout, "%s: no such file or directory\n", name);
         fflush(stdout);
         this_shell->status=1;
-        /*Print to the formatted string*/
-        sprintf(g_last_status, "exit value %d", this_shell->status);
+        this_shell->signaled = 0;
+        return -1;
     }
 
+    if (tty_fd != -1) {
+        sh_job_foreground(this_shell, child_PID);
+    }
+    /*The deadline signals the job's whole group*/
+    sh_deadline_arm(this_shell, pgid == 0 ? -child_PID : (pgid > 0 ? -pgid : child_PID));
+    this_shell->usage.pid = child_PID;
+    return child_PID;
+
 }
 
 /******************************************************
-#   sh_fg_process
-#   @desc: starts foreground process with redirection and
-#       waits for completion
+#   sh_set_status
+#   @desc: records how a waited-for child ended
 #   @param: pointer to shell object
+#   @param: status - status from waitpid
 #   @return: void
 ******************************************************/
-void sh_fg_process(struct Shell *this_shell)
+void sh_set_status(struct Shell *this_shell, int status)
 {
 
-    /*Child PID*/
-    pid_t child_PID = -5;
-    int wait;
-    int status;
-    /*File descriptors*/
-    int file_desc_one;
-    int file_desc_two;
-
-    char **args = this_shell->arguments;
-
-    /*Setup file descriptor for writing*/
-    if (this_shell->write == 1) {
-
-        /*Open */
-        file_desc_one = open(this_shell->arguments[2], O_WRONLY | O_CREAT | O_TRUNC, 0664);
-
-        /*File Open failed*/
-        if (file_desc_one == -1) {
-
-
-            fprintf(stdout, "simple_shell: cannot open %s for input\n", args[2]);
-            fflush(stdout);
-            this_shell->status=1;
-            /*Print to the formatted string the failed exit value*/
-            sprintf(g_last_status, "exit value %d", this_shell->status);
-
-            /*Return to the command line*/
-            return;
-        }
+    this_shell->usage.wait_status = status;
+    this_shell->timed_out = 0;
 
+    /*Child was terminated by a signal*/
+    if (WIFSIGNALED(status)) {
+        this_shell->status = WTERMSIG(status);
+        this_shell->signaled = 1;
     }
-
-    /*Set up file descriptor for reading*/
-    if (this_shell->read == 1) {
-
-        if (args[2] == NULL) {
-
-            file_desc_one = open("/dev/null", O_RDONLY);
-
-        }
-        else {
-
-            file_desc_one = open(this_shell->arguments[2], O_RDONLY);
-
-            /*File Open failed*/
-            if (file_desc_one == -1) {
-                fprintf(stdout, "simple_shell: cannot open %s for input\n", args[2]);
-                fflush(stdout);
-
-                this_shell->status = 1;
-                /*Print to the formatted string the failed exit value*/
-                sprintf(g_last_status, "exit value %d", this_shell->status);
-
-                /*Return to the command line*/
-                return;
-            }
-        }
-
+    else {
+        this_shell->status = WEXITSTATUS(status);
+        this_shell->signaled = 0;
     }
 
+}
 
+/******************************************************
+#   sh_fg_process
+#   @desc: starts foreground process with redirection and
+#       waits for completion
+#   @param: pointer to shell object
+#   @return: void
+******************************************************/
+void sh_fg_process(struct Shell *this_shell)
+{
 
-    /*Parent fork off child*/
-    child_PID = fork();
-
-    /*Regular command*/
-    if (child_PID == 0) {
-
-        /*In child process*/
-        /*Set up redirection for write*/
-        if (this_shell->write == 1) {
-            /*Redirect stdout to file*/
-            file_desc_two = dup2(file_desc_one, 1);
-            this_shell->arguments[1] = '\0';
-            this_shell->arguments[2] = '\0';
-        }
-        /*Set up redirection for read*/
-        if (this_shell->read == 1) {
-            /*Redirect stdin to file*/
-            file_desc_two = dup2(file_desc_one, 0);
-            this_shell->arguments[1] = '\0';
-            this_shell->arguments[2] = '\0';
-
-            /*redirection failed*/
-            if(file_desc_one==-1){
-                /*end child process*/
-                _exit(1);
-            }
-        }
-        /*Execute the user's command*/
-        sh_execute_command(this_shell);
+    /*Child PID*/
+    pid_t child_PID = -5;
+    pid_t pgid = sh_job_pgid(this_shell);
 
-        /*Close 2nd file descriptor*/
-        close(file_desc_two);
-    }
-    else if (child_PID == -1) {
-        /*Fork failed*/
-        fprintf(stdout, "Fork error \n");
-        fflush(stdout);
+    /*Open the files; the child applies the list*/
+    if (sh_redirect_open(this_shell->redirects, this_shell->redirect_count) == -1) {
         this_shell->status = 1;
-        /*end process*/
-        return;
+        /*Record the failed exit value*/
+        this_shell->signaled = 0;
 
+        /*Return to the command line*/
+        return;
     }
-    else {
-        /*Parent*/
-
-        /*Close 1st file descriptor*/
-        close(file_desc_one);
-
-        if (child_PID > 0) {
-            /*Wait for the child to complete*/
-            do {
-                wait = waitpid(child_PID, &status, 0);
-
-            } while (!WIFEXITED(status) && !WIFSIGNALED(status));
 
-        }
+    /*Spawn the child with its redirection*/
+    child_PID = sh_execute_command(this_shell, this_shell->arguments, -1, -1,
+            this_shell->redirects, this_shell->redirect_count, pgid);
 
-        /*Print formatted string*/
-        sprintf(g_last_status, "exit value %d", status);
-        //fprintf(stdout,"parent: waiting\n");
-        //fprintf(stdout,"parent: child exited %d\n", status);
+    /*Parent no longer needs the files*/
+    sh_redirect_close(this_shell->redirects, this_shell->redirect_count);
 
-        fflush(stdout);
+    if (child_PID > 0) {
+        sh_wait_fg(this_shell, pgid == 0 ? child_PID : -1, &child_PID, 1);
     }
 
 }
@@ -497,49 +750,34 @@ void sh_bg_process(struct Shell *this_shell)
 
     /*Child PID*/
     pid_t bg_child_PID=-10;
+    /*1 = its output goes to a ring buffer*/
+    int capturing;
 
-    /*Add signal handling to ignore*/
-    struct sigaction action;
-    action.sa_handler=SIG_IGN;
-    action.sa_flags=0;
-    sigfillset(&(action.sa_mask));
-    sigaction(SIGINT, &action, NULL);
-
-    /*Parent fork off child*/
-    bg_child_PID=fork();
-
-    //get rid of 3rd argument
-    this_shell->arguments[2]=NULL;
-
-    /*Regular command*/
-    if (bg_child_PID == 0) {
-        /*In child process*/
-
-        /*execute command stored in first argument*/
-        sh_execute_command(this_shell);
-    }
-    else if (bg_child_PID == -1) {
-        printf("Fork failed!\n");
-        fprintf(stdout, "Fork error \n");
-        fflush(stdout);
+    /*Open the files; the child applies the list*/
+    if (sh_redirect_open(this_shell->redirects, this_shell->redirect_count) == -1) {
         this_shell->status = 1;
+        this_shell->signaled = 0;
+        return;
+    }
 
+    /*Spawn the child in a group of its own, out of reach of CTRL-C*/
+    capturing = sh_capture_begin(this_shell);
+    bg_child_PID = sh_execute_command(this_shell, this_shell->arguments, -1, -1,
+            this_shell->redirects, this_shell->redirect_count, 0);
+    if (capturing) {
+        sh_capture_end(this_shell, bg_child_PID > 0);
     }
-    else {
-        /*Parent*/
-        if (bg_child_PID > 0) {
-            /*Print formatted string*/
-            printf("background pid is %d\n", bg_child_PID);
-            fflush(stdout);
+    sh_redirect_close(this_shell->redirects, this_shell->redirect_count);
 
-            sh_catch_bg(this_shell);
-            /*Keep track of PIDs in user*/
-            int curNum=this_shell->bg_count;
-            this_shell->bg_PIDs[curNum]=(int)bg_child_PID;
-            /*increment Pid count*/
-            this_shell->bg_count++;
-            return;
-        }
+    if (bg_child_PID > 0) {
+        /*Print formatted string*/
+        printf("background pid is %d\n", bg_child_PID);
+        this_shell->last_bg = bg_child_PID;
+        fflush(stdout);
+
+        /*Keep track of the job before anything can reap it*/
+        sh_job_started(this_shell, bg_child_PID, bg_child_PID);
+        sh_catch_bg(this_shell);
     }
 
 }
@@ -553,167 +791,127 @@ void sh_bg_process(struct Shell *this_shell)
 void sh_reg_fg_process(struct Shell *this_shell)
 {
 
-    /*Set flag to 0*/
-    flag = 0;
-    /*Set signal # to 0*/
-    sig_num=0;
     /*Child PID*/
     pid_t fg_child_PID = -10;
-    int wait;
-    int status;
-    int sign=0;
-
-    char **args = this_shell->arguments;
-
-    /*Catch the interrupt signal*/
-    struct sigaction action;
-    action.sa_handler = sh_catch_interr;
-    action.sa_flags = 0;
-    sigfillset(&(action.sa_mask));
-    sigaction(SIGINT, &action, NULL);
+    pid_t pgid = sh_job_pgid(this_shell);
 
+    /*Spawn the program*/
+    fg_child_PID = sh_execute_command(this_shell, this_shell->arguments, -1, -1, NULL, 0, pgid);
 
-     /*Fork the program*/
-    fg_child_PID = fork();
+    if (fg_child_PID > 0) {
+        sh_wait_fg(this_shell, pgid == 0 ? fg_child_PID : -1, &fg_child_PID, 1);
+    }
 
-    /*Regular command*/
-    if (fg_child_PID == 0) {
-        /*In child process*/
+}
 
-        /*execute command stored in first argument*/
-        sh_execute_command(this_shell);
+/******************************************************
+#   sh_bg_done
+#   @desc: prints how a background job ended
+#   @param: pid - the job's process
+#   @param: status - status from waitpid
+#   @param: timer - the job's deadline, may be NULL
+#   @return: void
+******************************************************/
+void sh_bg_done(pid_t pid, int status, const struct Timer *timer)
+{
+    /*Ran out of time*/
+    if (timer != NULL && timer->fired) {
+        fprintf(stdout, "background pid %d is done: timed out after %gs\n", pid, timer->seconds);
     }
-    else if (fg_child_PID == -1) {
-        printf("Fork failed!\n");
-        fprintf(stdout, "Fork error \n");
-        fflush(stdout);
-        this_shell->status = 1;
-
+    /*Exit Status*/
+    else if (WIFEXITED(status)) {
+        fprintf(stdout, "background pid %d is done: exit value %d\n", pid, WEXITSTATUS(status));
     }
-    else {
-        /*Parent*/
-        if (fg_child_PID > 0) {
-
-            do {
-                wait = waitpid(fg_child_PID, &status, 0);
-
-            } while (!WIFEXITED(status) && !WIFSIGNALED(status));
-
-            /*Child was terminated by a signal*/
-            if(flag==1){
-                sprintf(g_last_status, "terminated by signal %d", sig_num);
-            }else{
-                sprintf(g_last_status, "exit value %d", WEXITSTATUS(status));
-            }
-
-            /*Print statements used for debugging*/
-            //printf("parent: waiting\n");
-            //fflush(stdout);
-            //printf("parent: child exited [%d]\n", status);
-            //fflush(stdout);
-        }
+    /*Exit Signal*/
+    else if (WIFSIGNALED(status)) {
+        fprintf(stdout, "background pid %d is done: terminated by signal %d\n", pid, WTERMSIG(status));
     }
-
-
+    fflush(stdout);
 }
 
 /******************************************************
 #   sh_catch_bg
-#   @desc: catches BG processes that are done and prints
-#       their status to the console
+#   @desc: reaps every child that finished since the last
+#       SIGCHLD and prints the status of those that were
+#       background jobs. Jobs that stop or continue are
+#       noted too.
 #   @param: pointer to shell object
-#   @return: void
+#   @return: number of background jobs reported
 ******************************************************/
-void sh_catch_bg(struct Shell *this_shell)
+int sh_catch_bg(struct Shell *this_shell)
 {
     pid_t cur_PID;
     int status;
-    cur_PID=waitpid(-1, &status, WNOHANG);
-
-    int i;
-    int bg_count=this_shell->bg_count;
-
-    if(cur_PID>0){
-
-            for(i=0; i < bg_count; i++){
-
-                pid_t userPID=this_shell->bg_PIDs[i];
+    struct rusage usage;
+    int slot;
+    int reported = 0;
+
+    /*Nothing has exited since the last check*/
+    sh_loop_signals(&this_shell->loop);
+    if (this_shell->loop.child_pending == 0) {
+        return 0;
+    }
+    this_shell->loop.child_pending = 0;
 
-                if(cur_PID ==userPID){
+    while ((cur_PID = wait4(-1, &status, WNOHANG | WUNTRACED | WCONTINUED, &usage)) > 0) {
 
-                    /*Exit Status*/
-                    if(WIFEXITED(status)){
+        /*Stages of bg pipelines other than the last aren't jobs*/
+        slot = sh_job_find(&this_shell->jobs, cur_PID);
+        if (slot == -1 && (WIFSTOPPED(status) || WIFCONTINUED(status))) {
+            /*...but they stop with it*/
+            slot = sh_job_find_group(&this_shell->jobs, getpgid(cur_PID));
+        }
+        if (slot == -1) {
+            continue;
+        }
+        if (WIFSTOPPED(status) || WIFCONTINUED(status)) {
+            reported += sh_job_changed(this_shell, slot, status);
+            continue;
+        }
 
-                        fprintf(stdout,"background pid %d is done: exit value %d\n", cur_PID, WEXITSTATUS(status));
-                        fflush(stdout);
+        /*Job belongs to a builtin such as parallel*/
+        if (this_shell->jobs.jobs[slot].on_done != NULL) {
+            struct Job *job = &this_shell->jobs.jobs[slot];
+            job->on_done(this_shell, cur_PID, status, job->data);
+            sh_job_remove(&this_shell->jobs, slot);
+            continue;
+        }
 
-                    }
-                    /*Exit Signal*/
-                    if(WIFSIGNALED(status)){
-                        fprintf(stdout,"background pid %d is done: terminated by signal %d\n", cur_PID, WTERMSIG(status));
-                        fflush(stdout);
-                    }
-                    /*Set item at that variable to 0*/
-                    this_shell->bg_PIDs[i]=0;
+        if (this_shell->trace.fd != -1) {
+            sh_trace_reaped(&this_shell->trace, cur_PID, status, &usage);
+        }
 
-            }
+        sh_bg_done(cur_PID, status, this_shell->jobs.jobs[slot].timer);
 
-        }
+        /*Free the slot for reuse*/
+        sh_job_remove(&this_shell->jobs, slot);
+        reported++;
     }
 
+    return reported;
+
 }
 
 /******************************************************
 #   sh_kill_zombies
-#   @desc: loops thru array of BG PIDs and kills them
+#   @desc: walks the live jobs and kills them, waking
+#       stopped ones so they see it
 #   @param: pointer to shell object
 #   @return: void
 ******************************************************/
 void sh_kill_zombies(struct Shell *this_shell)
 {
-    int i=0;
+    struct JobTable *table = &this_shell->jobs;
+    int slot;
+
     /*Kill all remaining processes*/
-    for (i=0; i < this_shell->bg_count; i++)
-    {
-        /*skip PIDs set to 0*/
-        if (this_shell->bg_PIDs[i]!=0){
-            int zombie = this_shell->bg_PIDs[i];
-            kill(zombie, 15);
+    for (slot = table->live_head; slot != -1; slot = table->jobs[slot].next) {
+        struct Job *job = &table->jobs[slot];
+        pid_t target = job->pgid > 0 ? -job->pgid : job->pid;
+        kill(target, SIGTERM);
+        if (job->state == JOB_STOPPED) {
+            kill(target, SIGCONT);
         }
-
-
     }
 
 }
-
-/******************************************************
-#   sh_catch_interr
-#   @desc: catches interruption signal of child process,
-#       updates signal flag and signal # global variable
-#   @param: int signo
-#   @return: void
-******************************************************/
-void sh_catch_interr(int signo)
-{
-
-    switch(signo){
-        case SIGHUP:
-            puts("terminated by signal 1");
-            fflush(stdout);
-            /*Set signal #*/
-            sig_num=1;
-            break;
-        case SIGINT:
-            puts("terminated by signal 2");
-            fflush(stdout);
-            sig_num=2;
-            break;
-        default:
-            puts("terminated by other signal");
-            return;
-    }
-
-    /*Set the flag to 1 to indicate child was terminated*/
-    flag=1;
-
-}
@@ -11,47 +11,616 @@
 #include <errno.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <signal.h>
+#include <spawn.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <sys/resource.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <termios.h>
 #include <unistd.h>
 
 
-#define MAX_ARGS 512
 #define MAX_LEN 2048
 
-/*Global Variables*/
-char g_last_status[MAX_LEN];
-volatile sig_atomic_t flag; /*0=not terminated 1=terminated*/
-volatile sig_atomic_t sig_num; /*store signal term #*/
+/*Control operators (sh_parse.c)*/
+extern const char sh_op_pipe[];
+extern const char sh_op_relay[];
+extern const char sh_op_in[];
+extern const char sh_op_out[];
+extern const char sh_op_append[];
+extern const char sh_op_err[];
+extern const char sh_op_err_append[];
+extern const char sh_op_err_to_out[];
+extern const char sh_op_out_to_err[];
+extern const char sh_op_herestring[];
+extern const char sh_op_heredoc[];
+extern const char sh_op_heredoc_tab[];
+extern const char sh_op_and[];
+extern const char sh_op_or[];
+extern const char sh_op_background[];
+extern const char sh_op_semicolon[];
+extern const char sh_op_open[];
+extern const char sh_op_close[];
+
+#define ARENA_BLOCK_SIZE 4096 /*first block of the command arena*/
+#define ARENA_ALIGN sizeof(void*)
+
+/*Tokenizer results*/
+#define PARSE_OK 0
+#define PARSE_UNTERMINATED 1 /*missing closing quote*/
+#define PARSE_NOMEM 2
+#define PARSE_SYNTAX 3 /*misplaced operator*/
+
+/*What a compiled word needs when it runs*/
+#define WORD_GLOB 1 /*unquoted * ? [; literal pattern chars escaped*/
+#define WORD_PARAM 2 /*holds $parameter markers*/
+#define WORD_QUOTED 4 /*quoted, kept even if it expands to nothing*/
+
+/*Markers of a $parameter in a compiled word: mark, name, end*/
+#define PARAM_UNQUOTED '\001'
+#define PARAM_QUOTED '\002'
+#define PARAM_END '\003'
+
+/*Chunk of memory handed out by the arena*/
+struct ArenaBlock
+{
+    struct ArenaBlock *next; /*next block in the chain*/
+    size_t size; /*usable bytes in data*/
+    size_t used; /*bytes handed out so far*/
+    char data[]; /*storage*/
+};
+
+/*Per-command bump allocator, reset between prompts*/
+struct Arena
+{
+    struct ArenaBlock *first; /*first block, reused after reset*/
+    struct ArenaBlock *current; /*block being allocated from*/
+};
+
+/*Position in an arena to release back to*/
+struct ArenaMark
+{
+    struct ArenaBlock *block; /*block in use at the mark*/
+    size_t used; /*its bytes in use*/
+};
+
+#define INPUT_CHUNK 65536 /*bytes requested per read of input*/
+
+/*Buffered reader for terminal, script or -c input*/
+struct InputReader
+{
+    int fd; /*descriptor read from, -1 for a string*/
+    char *buf; /*buffered input*/
+    size_t cap; /*size of buf*/
+    size_t start; /*first unread byte*/
+    size_t end; /*one past the last buffered byte*/
+    size_t scanned; /*buf is searched for '\n' up to here*/
+    int eof; /*0=more input, 1=no more reads*/
+    int interactive; /*1 = terminal, show prompt*/
+};
+
+/*Kinds of redirection*/
+#define REDIR_READ 0 /*< file*/
+#define REDIR_WRITE 1 /*> file, 2> file*/
+#define REDIR_APPEND 2 /*>> file, 2>> file*/
+#define REDIR_DUP 3 /*2>&1, >&2*/
+#define REDIR_STRING 4 /*<<< word*/
+#define REDIR_HEREDOC 5 /*<< delimiter, <<- delimiter*/
+
+#define REDIRECT_FDS 3 /*descriptors that can be redirected: 0-2*/
+
+/*One redirection of a command*/
+struct Redirect
+{
+    const char *op; /*operator word (sh_op_*)*/
+    int fd; /*descriptor redirected*/
+    int kind; /*REDIR_* above*/
+    char *word; /*file, here-string or here-doc body*/
+    char *body; /*here-doc text*/
+    size_t body_len;
+    int source; /*descriptor dup'ed onto fd, -1 until opened*/
+};
+
+#define RELAY_CHUNK 65536 /*bytes moved per splice in a relay*/
+
+/*One stage of a pipeline*/
+struct PipeStage
+{
+    char **argv; /*command, NULL for a relay stage*/
+    char *relay_file; /*file a |> relay tees into*/
+    struct Redirect *redirects; /*redirections of this stage*/
+    int redirect_count;
+};
+
+#define LOOP_MAX_EVENTS 32 /*events taken per epoll_wait*/
+
+struct Shell;
+typedef void (*EventHandler)(struct Shell *this_shell, int fd, void *data);
+
+/*Descriptor watched by the event loop*/
+struct EventWatch
+{
+    int fd; /*descriptor being watched*/
+    EventHandler handler; /*called when fd is readable*/
+    void *data; /*passed to handler*/
+};
+
+/*epoll based event loop driving the REPL*/
+struct EventLoop
+{
+    int epoll_fd; /*epoll set of all watches*/
+    int signal_fd; /*SIGCHLD and SIGINT, -1 if unavailable*/
+    sigset_t signals; /*signals read from signal_fd*/
+    struct EventWatch *input_watch; /*NULL if input is always ready*/
+    int child_pending; /*1 = SIGCHLD since last reap*/
+    int interrupted; /*1 = SIGINT reached the shell*/
+};
+
+#define JOB_TABLE_SIZE 16 /*initial job slots, power of two*/
+
+typedef void (*JobDoneHandler)(struct Shell *this_shell, pid_t pid, int status, void *data);
+
+#define JOB_RUNNING 0
+#define JOB_STOPPED 1
+
+/*Background job, one slot of the job table*/
+struct Job
+{
+    pid_t pid; /*pid reported when done, 0 = free slot*/
+    pid_t pgid; /*process group of the job, 0 if none of its own*/
+    int id; /*job number, %id*/
+    int state; /*JOB_RUNNING or JOB_STOPPED*/
+    char *command; /*text shown by jobs, NULL if none*/
+    char *cgroup; /*cgroup directory of the job, NULL if none*/
+    struct Capture *capture; /*its captured output, NULL if none*/
+    struct Timer *timer; /*its deadline, NULL if none*/
+    struct termios modes; /*terminal modes when it stopped*/
+    int has_modes; /*1 = modes were saved*/
+    JobDoneHandler on_done; /*called instead of printing a notice*/
+    void *data; /*passed to on_done*/
+    int prev; /*previous live slot, -1 if first*/
+    int next; /*next live slot, or next free slot*/
+    int hash_next; /*next slot in the same pid bucket*/
+};
+
+/*Background jobs with slot reuse and pid lookup*/
+struct JobTable
+{
+    struct Job *jobs; /*slot array*/
+    int *buckets; /*pid hash, heads of slot chains*/
+    int capacity; /*slots (and buckets), power of two*/
+    int count; /*live jobs*/
+    int live_head; /*first live slot, -1 if none*/
+    int free_head; /*first free slot, -1 if full*/
+    int current; /*slot of %+, -1 if none*/
+    int next_id; /*last job number given out*/
+};
+
+/*Terminal and process groups of an interactive shell*/
+struct JobControl
+{
+    int enabled; /*1 = jobs get their own group and the terminal*/
+    int tty_fd; /*controlling terminal, -1 if none*/
+    pid_t shell_pgid; /*group the terminal returns to*/
+    struct termios modes; /*shell's terminal modes*/
+};
+
+#define TIMER_BITS 6
+#define TIMER_SLOTS (1 << TIMER_BITS) /*slots per wheel level*/
+#define TIMER_LEVELS 4 /*levels; the last spans TIMER_SLOTS^4 ticks*/
+#define TIMER_TICK_MS 100 /*resolution of deadlines*/
+#define TIMEOUT_GRACE 5.0 /*default seconds from SIGTERM to SIGKILL*/
+#define TIMEOUT_STATUS 124 /*$? of a command that ran out of time*/
+
+/*Deadline of a job, in a slot of the timer wheel while pending*/
+struct Timer
+{
+    unsigned long expires; /*tick it fires at*/
+    pid_t target; /*pid, or -pgid for the job's group*/
+    int fired; /*0, 1 after SIGTERM, 2 after SIGKILL*/
+    double seconds; /*the deadline, for messages*/
+    double grace; /*seconds from SIGTERM to SIGKILL*/
+    struct Timer *next; /*next in the same slot*/
+    struct Timer **link; /*what points at it, NULL if not in the wheel*/
+    struct TimerWheel *wheel; /*wheel it belongs to*/
+};
+
+/*Hierarchical timer wheel of job deadlines, ticked by a timerfd*/
+struct TimerWheel
+{
+    struct Timer *slots[TIMER_LEVELS][TIMER_SLOTS];
+    unsigned long now; /*ticks so far*/
+    int count; /*timers in the wheel*/
+    int fd; /*timerfd, ticking while count > 0; -1 until used*/
+    struct EventWatch *watch; /*fd in the shell's loop, NULL if none*/
+    int nested; /*1 = in a subshell, fd is not in the loop*/
+    double deadline; /*for commands started now, 0 for none*/
+    double grace; /*SIGTERM to SIGKILL for them*/
+    int arming; /*1 = the command being started gets a deadline*/
+    struct Timer *current; /*deadline armed for it*/
+};
+
+#define RETRY_TRIES 3 /*attempts retry makes by default*/
+#define RETRY_DELAY 1.0 /*seconds before the second attempt*/
+#define RETRY_MAX_DELAY 60.0 /*longest pause exp backoff grows to*/
+
+#define MEMO_HEX 33 /*hex digits of a memo hash and terminator*/
+#define MEMO_LIST 16 /*-e variables and -f files memo takes*/
+
+#define CAPTURE_BUDGET (4 * 1024 * 1024) /*bytes all capture rings may take*/
+#define CAPTURE_MIN 4096 /*smallest ring*/
+
+/*Output of a background job, the last size bytes of it*/
+struct Capture
+{
+    int id; /*job number it ran as*/
+    pid_t pid; /*pid of the job, 0 until it started*/
+    char *command; /*text of the job, NULL if none*/
+    char *ring; /*output, wrapping at size*/
+    size_t size; /*capacity of ring*/
+    unsigned long long total; /*bytes written, ring holds the last of them*/
+    int fd; /*read end of the job's pipe, -1 at end of output*/
+    int done; /*1 = job finished*/
+    int echo; /*1 = in the foreground, output also goes to stdout*/
+    struct Capture *next; /*next newer capture*/
+};
+
+/*Captured output of background jobs, oldest first*/
+struct CaptureList
+{
+    struct Capture *oldest;
+    struct Capture *newest;
+    struct Capture *pending; /*made for a job being started*/
+    size_t used; /*bytes taken by rings*/
+    int open; /*captures whose output is still open*/
+    int epoll_fd; /*their pipes, -1 until capture is used*/
+    struct EventWatch *watch; /*epoll_fd in the shell's loop*/
+    int saved[2]; /*shell's stdout and stderr while a job starts*/
+    int disabled; /*1 = in a subshell, never capture*/
+};
+
+#define PARALLEL_READ 4096 /*bytes read per output event in parallel*/
+
+/*Resources used by the last foreground command*/
+struct CommandUsage
+{
+    double start; /*monotonic start of the running command*/
+    struct rusage pending; /*children reaped so far for it*/
+    struct rusage last; /*usage of last finished command*/
+    double wall; /*wall seconds of last finished command*/
+    int valid; /*0 until a command has finished*/
+    pid_t pid; /*last child started, -1 if none*/
+    int wait_status; /*how the last waited child ended*/
+    const char *builtin; /*builtin run since, NULL if none*/
+};
+
+/*Execution trace writer (--trace)*/
+struct Trace
+{
+    int fd; /*trace file, -1 when not tracing*/
+    int chrome; /*1 = Chrome trace_event, 0 = JSON lines*/
+    char *buf; /*events not yet written*/
+    size_t len;
+    size_t cap;
+    int events; /*events written so far*/
+    long long origin; /*monotonic us when trace opened*/
+    long long start; /*start of the running command*/
+    char *argv; /*its words, NUL separated*/
+    size_t argv_cap;
+    int argc;
+    int redirect_count; /*redirections packed after the words*/
+};
+
+#define TRACE_BUFFER (256 * 1024) /*bytes buffered between writes*/
+
+/*Persistent history: text file plus offset index, both mmap'd*/
+struct History
+{
+    int fd; /*history text, one command per line; -1 if off*/
+    int index_fd; /*64-bit offset of each entry*/
+    char *data; /*mapped text*/
+    size_t data_len; /*bytes mapped*/
+    uint64_t *index; /*mapped offsets*/
+    size_t count; /*entries mapped*/
+};
+
+#define HISTORY_FILE ".simple_shell_history" /*in $HOME unless $HISTFILE*/
+
+#define DIR_CACHE_SIZE 8 /*directory listings kept*/
+#define DIR_READ_BUFFER (256 * 1024) /*bytes of entries per getdents64*/
+
+/*Sorted names of one directory*/
+struct DirListing
+{
+    dev_t dev; /*device and inode of the directory, so a*/
+    ino_t ino; /*relative path like "." can't match stale*/
+    struct timespec mtime; /*mtime the names were read at*/
+    struct timespec ctime; /*and ctime, which also moves on rename*/
+    char **names; /*sorted, each preceded by its d_type byte; NULL for an empty slot*/
+    size_t count;
+    char *pool; /*storage of the names*/
+    unsigned long used; /*tick of last use, for eviction*/
+};
+
+/*Recently listed directories*/
+struct DirCache
+{
+    struct DirListing listings[DIR_CACHE_SIZE];
+    unsigned long tick; /*bumped on every lookup*/
+    char *read_buf; /*getdents64 buffer, allocated on first read*/
+};
+
+/*Filename expansion of the current command*/
+struct Glob
+{
+    unsigned char *words; /*1 per word that is a pattern, in arena; NULL if none*/
+    char **paths; /*matches of the word being expanded*/
+    size_t count;
+    size_t cap; /*kept between commands*/
+};
+
+/*Node of the command name trie*/
+struct TrieNode
+{
+    int child; /*first child, -1 if none*/
+    int next; /*next sibling, in character order*/
+    int below; /*names ending at or below this node*/
+    int refs; /*PATH dirs (or builtins) providing this name*/
+    char c; /*character leading here*/
+};
+
+/*One PATH directory indexed in the trie*/
+struct PathDir
+{
+    char *path;
+    struct timespec mtime; /*mtime when names were read*/
+    char *names; /*executables found, NUL separated*/
+    size_t names_len;
+};
+
+#define COMPLETE_SHOW 256 /*candidates listed at most*/
+
+/*Command and file name completion*/
+struct Completer
+{
+    struct TrieNode *nodes; /*trie of executables, node 0 is root*/
+    int node_count;
+    int node_cap;
+    struct PathDir *dirs; /*PATH entries the trie was built from*/
+    int dir_count;
+    char *path_env; /*PATH the dirs were split from*/
+    char *matches; /*candidates of the last completion, NUL separated*/
+    size_t matches_len;
+    size_t matches_cap;
+    size_t match_count; /*candidates in matches*/
+    struct DirCache *listings; /*directory listings (the shell's)*/
+    struct Env *env; /*where PATH and HOME are read from*/
+};
+
+#define EDIT_LINE 256 /*initial line buffer size*/
+
+/*Raw mode line editor for terminal input*/
+struct LineEditor
+{
+    int active; /*1 while a line is being typed*/
+    int raw; /*1 while the terminal is in raw mode*/
+    int disabled; /*1 if the terminal can't be edited on*/
+    struct termios saved; /*settings restored after each line*/
+    const char *prompt;
+    char *buf; /*line being typed*/
+    size_t len;
+    size_t cap;
+    size_t pos; /*cursor offset in buf*/
+    size_t scroll; /*first byte of buf on screen*/
+    size_t history_at; /*entry shown, 0 = the new line*/
+    char *draft; /*new line kept while browsing history*/
+    size_t draft_len;
+    int tabs; /*Tab presses in a row*/
+    char esc[8]; /*escape sequence being read*/
+    int esc_len;
+};
+
+#define ENV_BUCKETS 64 /*initial variable buckets, power of two*/
+#define ENV_KEEP 0 /*leave a variable's export flag alone*/
+#define ENV_EXPORT 1 /*pass the variable to commands*/
+
+/*Shell variable*/
+struct EnvVar
+{
+    char *pair; /*"NAME=value", handed to exec as is*/
+    size_t name_len;
+    unsigned int hash; /*hash of the name*/
+    int exported; /*1 = in the environment of commands*/
+    struct EnvVar *next; /*next variable in bucket*/
+};
+
+/*Variables, with the envp for exec built on demand*/
+struct Env
+{
+    struct EnvVar **buckets; /*array of bucket chains*/
+    int bucket_count; /*always a power of two*/
+    int count; /*number of variables*/
+    char **envp; /*exported pairs, NULL until next launch*/
+};
+
+/*Kinds of compiled nodes*/
+#define AST_COMMAND 0 /*simple command or pipeline: count words from first*/
+#define AST_SEQUENCE 1 /*run left, then the list at right (-1 = end)*/
+#define AST_AND 2 /*left && right*/
+#define AST_OR 3 /*left || right*/
+#define AST_BACKGROUND 4 /*left &*/
+#define AST_GROUP 5 /*{ left; } with count redirection words from first*/
+#define AST_SUBSHELL 6 /*( left ) with count redirection words from first*/
+
+/*Node of a compiled line*/
+struct AstNode
+{
+    int kind; /*AST_* above*/
+    int left; /*operand or body, -1 if none*/
+    int right; /*second operand or next in list, -1 if none*/
+    int first; /*first word of the command or redirections*/
+    int count; /*number of those words*/
+};
+
+/*Line compiled once into a flat node array; nodes refer to words by index*/
+struct Ast
+{
+    struct AstNode *nodes; /*children come before their parents*/
+    int node_count;
+    char **words; /*words from sh_tokenize, here-doc bodies in place of delimiters*/
+    unsigned char *flags; /*WORD_* of each word*/
+    int word_count;
+    int root; /*first node run, -1 for nothing to run*/
+    int error; /*PARSE_OK, or why the line didn't compile*/
+    int near; /*word a syntax error was found at, -1 for the end*/
+};
+
+#define SCRIPT_CACHE_SIZE 8 /*compiled scripts kept by source*/
+#define SOURCE_MAX_DEPTH 64 /*scripts sourcing scripts*/
+
+/*A script compiled by source, one Ast per line*/
+struct Script
+{
+    char *path; /*full path if cached on disk, else "", NULL if slot empty*/
+    dev_t dev; /*file compiled, with the mtime and size it had*/
+    ino_t ino;
+    struct timespec mtime;
+    off_t size;
+    struct Ast *lines; /*compiled lines, in order*/
+    int line_count;
+    struct Arena arena; /*nodes and words of compiled lines*/
+    void *map; /*cache file the lines point into, NULL if compiled*/
+    size_t map_len;
+    int running; /*sources of it in progress*/
+    unsigned long used; /*tick of last use, for eviction*/
+};
+
+/*Compiled scripts for the session*/
+struct ScriptCache
+{
+    struct Script scripts[SCRIPT_CACHE_SIZE];
+    unsigned long tick; /*counts sources*/
+    int depth; /*sources in progress*/
+};
+
+#define LIMIT_CPU 0 /*-t, RLIMIT_CPU seconds*/
+#define LIMIT_AS 1 /*-v, RLIMIT_AS bytes*/
+#define LIMIT_NOFILE 2 /*-n, RLIMIT_NOFILE*/
+#define LIMIT_NPROC 3 /*-u, RLIMIT_NPROC*/
+#define LIMIT_MEMORY 4 /*-m, cgroup memory.max bytes*/
+#define LIMIT_CPU_MAX 5 /*-c, cgroup cpu.max percent of a CPU*/
+#define LIMIT_COUNT 6
+#define LIMIT_UNSET -1 /*inherited from the shell*/
+#define LIMIT_CPU_PERIOD 100000 /*cpu.max period, microseconds*/
+#define LIMIT_EXEC_ARG "--limit-exec" /*starts the shell as the exec helper*/
+#define LIMIT_EXEC_PATH "/proc/self/exe" /*the shell, to start as the helper*/
+#define LIMIT_SPEC 128 /*room for the rlimits handed to the helper*/
+
+/*Limits for launched commands and the cgroup of the job being started*/
+struct Limits
+{
+    long long value[LIMIT_COUNT]; /*LIMIT_* above, LIMIT_UNSET if none*/
+    char *group; /*cgroup made for the job being started, NULL if none*/
+    int procs_fd; /*its cgroup.procs, -1 if none*/
+    unsigned int made; /*cgroups made, names them*/
+    int nested; /*1 = in a subshell already inside a job's cgroup*/
+    int warned; /*1 << LIMIT_* of cgroup limits reported as unsettable*/
+};
+
+#define PATH_CACHE_BUCKETS 64 /*initial bucket count, power of two*/
+#define DEFAULT_PATH "/bin:/usr/bin"
+
+/*Resolved command name -> absolute path*/
+struct PathEntry
+{
+    char *name; /*command as typed*/
+    char *path; /*absolute path found in PATH*/
+    unsigned int hash; /*cached hash of name*/
+    int hits; /*number of launches served*/
+    struct PathEntry *next; /*next entry in bucket*/
+};
+
+/*Hash table used to skip the PATH walk on every launch*/
+struct PathCache
+{
+    struct PathEntry **buckets; /*array of bucket chains*/
+    int bucket_count; /*always a power of two*/
+    int count; /*number of cached entries*/
+    char *path_env; /*copy of PATH the entries were resolved from*/
+    struct Env *env; /*where PATH is read from*/
+};
 
 /*Data structure to house user's commands*/
 struct Shell 
 {
-    char *user_input; /*string to capture input*/
+    struct InputReader input; /*where commands are read from*/
+    char *user_input; /*current line, points into input buffer*/
+    size_t input_len; /*length of current line*/
     int args_count; /*number of arguments in command*/
     char **arguments; /*array of strings to contain each arg*/
+    struct Arena arena; /*holds arguments until the next prompt*/
     int ground; /*0 = fore, 1=back*/
-    int status; 
-    int read; /*0=false, 1=true*/
-    int write; /*0=false, 1=true*/
-    int bg_PIDs[MAX_ARGS]; /*Array containing bg PIDs*/
-    int bg_count; /*Count of bg PIDs*/
+    int status; /*exit value, or signal number if signaled*/
+    int signaled; /*1 = last command was killed by a signal*/
+    pid_t shell_pid; /*$$*/
+    pid_t last_bg; /*$!, 0 until a job is started*/
+    struct Env env; /*variables and exported environment*/
+    struct Redirect *redirects; /*redirections, in arena*/
+    int redirect_count;
+    struct JobTable jobs; /*background and stopped jobs*/
+    struct JobControl control; /*terminal handoff*/
+    const struct Ast *job_ast; /*line of the command being run, for jobs*/
+    int job_node; /*its node in job_ast*/
+    struct EventLoop loop; /*REPL event loop*/
+    struct CommandUsage usage; /*rusage and wall time of commands*/
+    struct Trace trace; /*--trace output*/
+    struct History history; /*command history*/
+    struct PathCache path_cache; /*command resolution cache*/
+    struct LineEditor editor; /*terminal line editing*/
+    struct Completer completer; /*Tab completion*/
+    struct DirCache dircache; /*directory listings for globs and completion*/
+    struct Glob glob; /*filename expansion*/
+    struct Ast line; /*compiled current line, in arena*/
+    struct ScriptCache scripts; /*compiled scripts for source*/
+    struct Limits limits; /*limit defaults, cgroup of the job being started*/
+    struct CaptureList captures; /*output of background jobs*/
+    struct TimerWheel timers; /*deadlines of jobs*/
+    double timed_out; /*deadline the last command ran out of, 0 if none*/
 };
 
 
 typedef struct Shell Shell;
 
+/*Builtin command table entry*/
+typedef void (*BuiltinHandler)(struct Shell *this_shell);
+struct Builtin
+{
+    const char *name; /*exact command name*/
+    BuiltinHandler handler; /*runs the builtin*/
+    int flags; /*BUILTIN_* below*/
+};
+
+#define BUILTIN_IN_PROCESS 1 /*runs inside the shell, no fork*/
+#define BUILTIN_REDIRECT 2 /*honors < and > itself*/
+#define BUILTIN_PREFIX 4 /*runs the rest of the line (time)*/
+#define BUILTIN_PROGRAM 8 /*a program of that name does the same*/
+#define BUILTIN_SLOTS 64 /*perfect hash slots, power of two*/
+
 /*User object prototypes*/
 Shell* sh_init();
 void sh_free(struct Shell *this_shell);
 
 /*Command line helper functions*/
-void sh_get_commands(struct Shell *this_shell);
+int sh_get_commands(struct Shell *this_shell);
+int sh_get_line(struct Shell *this_shell, const char *prompt);
 void sh_parse_args(struct Shell *this_shell);
 void sh_identify_command(struct Shell *this_shell);
 void sh_command_ground(struct Shell *this_shell);
@@ -60,18 +629,244 @@ void sh_command_ground(struct Shell *this_shell);
 void sh_change_directory(struct Shell *this_shell);
 void sh_command_status(struct Shell *this_shell);
 void exitShell(struct Shell *this_shell);
+int sh_exit_status(struct Shell *this_shell);
+void sh_hash_command(struct Shell *this_shell);
+void sh_parallel_command(struct Shell *this_shell);
+void sh_time_command(struct Shell *this_shell);
+
+/*In-process utilities (sh_utils.c)*/
+void sh_echo_command(struct Shell *this_shell);
+void sh_printf_command(struct Shell *this_shell);
+void sh_test_command(struct Shell *this_shell);
+void sh_true_command(struct Shell *this_shell);
+void sh_false_command(struct Shell *this_shell);
+void sh_pwd_command(struct Shell *this_shell);
+void sh_read_command(struct Shell *this_shell);
 
 /*Command execution via processes*/
 void sh_other_command(struct Shell *this_shell);
-void sh_execute_command(struct Shell *this_shell);
+pid_t sh_execute_command(struct Shell *this_shell, char **argv, int in_fd, int out_fd,
+        struct Redirect *redirects, int redirect_count, pid_t pgid);
 void sh_fg_process(struct Shell *this_shell);
 void sh_reg_fg_process(struct Shell *this_shell);
 void sh_bg_process(struct Shell *this_shell);
+void sh_set_status(struct Shell *this_shell, int status);
+
+/*Pipelines (sh_pipeline.c)*/
+int sh_has_pipeline(struct Shell *this_shell);
+void sh_pipeline_process(struct Shell *this_shell);
+
+/*Process launch layer (sh_launch.c)*/
+int sh_launch(const char *path, char **argv, char **envp, int in_fd, int out_fd,
+        const struct Redirect *redirects, int redirect_count, int background, pid_t pgid, int tty_fd,
+        pid_t *child_PID);
+
+/*Redirection lists (sh_redirect.c)*/
+int sh_redirect_words(const char *word);
+int sh_redirect_heredoc(struct Shell *this_shell, struct Arena *arena, const char *delim, int strip_tabs,
+        char **body);
+int sh_redirect_extract(struct Shell *this_shell, char **argv, int *argc, struct Redirect **list, int *count);
+int sh_redirect_open(struct Redirect *list, int count);
+void sh_redirect_close(struct Redirect *list, int count);
+void sh_redirect_actions(posix_spawn_file_actions_t *actions, const struct Redirect *list, int count);
+void sh_redirect_push(const struct Redirect *list, int count, int *saved);
+void sh_redirect_pop(int *saved);
+
+/*Background job table (sh_jobs.c)*/
+void sh_jobs_init(struct JobTable *table);
+void sh_jobs_free(struct JobTable *table);
+int sh_job_add(struct JobTable *table, pid_t pid, pid_t pgid);
+int sh_job_find(struct JobTable *table, pid_t pid);
+void sh_job_remove(struct JobTable *table, int slot);
+int sh_job_find_group(struct JobTable *table, pid_t pgid);
+
+/*Job control and its builtins (sh_jobctl.c)*/
+void sh_jobctl_init(struct Shell *this_shell);
+pid_t sh_job_pgid(struct Shell *this_shell);
+void sh_job_foreground(struct Shell *this_shell, pid_t pgid);
+void sh_wait_fg(struct Shell *this_shell, pid_t pgid, const pid_t *pids, int count);
+int sh_job_started(struct Shell *this_shell, pid_t pid, pid_t pgid);
+int sh_job_changed(struct Shell *this_shell, int slot, int status);
+void sh_jobs_command(struct Shell *this_shell);
+void sh_fg_command(struct Shell *this_shell);
+void sh_bg_command(struct Shell *this_shell);
+void sh_wait_command(struct Shell *this_shell);
+void sh_kill_command(struct Shell *this_shell);
+
+/*Resource accounting (sh_usage.c)*/
+double sh_usage_now();
+void sh_usage_begin(struct CommandUsage *usage);
+void sh_usage_add(struct CommandUsage *usage, const struct rusage *child);
+void sh_usage_end(struct CommandUsage *usage);
+void sh_usage_print(struct CommandUsage *usage);
+
+/*Builtin command table (sh_builtin.c)*/
+int sh_builtin_init();
+const struct Builtin* sh_builtin_find(const char *name);
+const char* sh_builtin_name(int i);
+void sh_builtin_run(struct Shell *this_shell, const struct Builtin *builtin);
+
+/*Command history (sh_history.c)*/
+int sh_history_open(struct History *history, const char *path);
+void sh_history_close(struct History *history);
+size_t sh_history_count(struct History *history);
+void sh_history_add(struct History *history, const char *line, size_t len);
+const char* sh_history_entry(struct History *history, size_t n, size_t *len);
+size_t sh_history_find_prefix(struct History *history, const char *prefix, size_t prefix_len);
+int sh_history_expand(struct History *history, struct Arena *arena, const char *line, size_t len,
+        char **out, size_t *out_len);
+void sh_history_command(struct Shell *this_shell);
+
+/*Execution trace (sh_trace.c)*/
+int sh_trace_open(struct Trace *trace, const char *path, int chrome);
+void sh_trace_close(struct Trace *trace);
+void sh_trace_begin(struct Shell *this_shell);
+void sh_trace_end(struct Shell *this_shell);
+void sh_trace_reaped(struct Trace *trace, pid_t pid, int status, const struct rusage *ru);
+
+/*Event loop (sh_loop.c)*/
+int sh_loop_init(struct Shell *this_shell);
+void sh_loop_free(struct EventLoop *loop);
+struct EventWatch* sh_loop_watch(struct Shell *this_shell, int fd, EventHandler handler, void *data);
+void sh_loop_unwatch(struct Shell *this_shell, struct EventWatch *watch);
+void sh_loop_signals(struct EventLoop *loop);
+int sh_loop_wait(struct Shell *this_shell, int timeout_ms);
+void sh_loop_block(struct Shell *this_shell, int timeout_ms);
+
+/*Buffered input (sh_input.c)*/
+int sh_input_open(struct InputReader *reader, int fd);
+int sh_input_string(struct InputReader *reader, const char *text);
+char* sh_input_next(struct InputReader *reader, size_t *len);
+ssize_t sh_input_fill(struct InputReader *reader);
+int sh_input_push(struct InputReader *reader, const char *text, size_t len);
+void sh_input_close(struct InputReader *reader);
+
+/*Per-command arena (sh_arena.c)*/
+void sh_arena_init(struct Arena *arena, size_t size);
+void* sh_arena_alloc(struct Arena *arena, size_t size);
+void sh_arena_reset(struct Arena *arena);
+void sh_arena_mark(struct Arena *arena, struct ArenaMark *mark);
+void sh_arena_release(struct Arena *arena, const struct ArenaMark *mark);
+void sh_arena_free(struct Arena *arena);
+
+/*Tokenizer (sh_parse.c)*/
+int sh_is_operator(const char *word);
+int sh_operator_index(const char *word);
+const char* sh_operator_word(int index);
+void sh_unescape(char *word);
+char* sh_expand_word(struct Shell *this_shell, const char *word, int *glob);
+int sh_tokenize(struct Arena *arena, const char *line, size_t len, char ***argv_out, int *argc_out,
+        unsigned char **flags_out);
+
+/*Compiled command lines (sh_ast.c)*/
+int sh_ast_compile(struct Shell *this_shell, struct Arena *arena, const char *line, size_t len, struct Ast *ast);
+int sh_ast_expand(struct Shell *this_shell, const struct Ast *ast, int first, int count);
+void sh_ast_error(const struct Ast *ast);
+char* sh_ast_text(const struct Ast *ast, int index);
+void sh_ast_run(struct Shell *this_shell, const struct Ast *ast, int node);
+
+/*source and its compiled script cache (sh_source.c)*/
+void sh_scripts_init(struct ScriptCache *cache);
+void sh_scripts_free(struct ScriptCache *cache);
+void sh_source_command(struct Shell *this_shell);
+
+/*Resource limits and cgroups of jobs (sh_limit.c)*/
+void sh_limits_init(struct Limits *limits);
+void sh_limits_free(struct Limits *limits);
+int sh_limit_begin(struct Shell *this_shell);
+void sh_limit_attach(struct Shell *this_shell);
+char** sh_limit_exec_argv(struct Shell *this_shell, const char *path, char **argv);
+void sh_limit_exec(int argc, char **argv);
+char* sh_limit_take(struct Shell *this_shell);
+void sh_limit_child(struct Shell *this_shell);
+void sh_limit_end(struct Shell *this_shell);
+void sh_limit_remove(char *group);
+int sh_limit_usage(const char *group, long long *memory, double *cpu);
+void sh_limit_size(long long bytes, char *buf, size_t len);
+void sh_limit_command(struct Shell *this_shell);
+
+/*Background job output capture (sh_capture.c)*/
+void sh_captures_init(struct CaptureList *list);
+void sh_captures_free(struct Shell *this_shell);
+void sh_captures_child(struct CaptureList *list);
+int sh_capture_begin(struct Shell *this_shell);
+void sh_capture_end(struct Shell *this_shell, int started);
+void sh_capture_take(struct Shell *this_shell, struct Job *job);
+void sh_capture_ready(struct Shell *this_shell);
+int sh_capture_show(struct Shell *this_shell, const char *spec, long lines);
+
+/*Deadlines and the timer wheel (sh_timer.c)*/
+void sh_timers_init(struct TimerWheel *wheel);
+void sh_timers_free(struct Shell *this_shell);
+void sh_timers_child(struct TimerWheel *wheel);
+void sh_timers_ready(struct Shell *this_shell);
+void sh_timer_cancel(struct Timer *timer);
+int sh_deadline_begin(struct Shell *this_shell);
+void sh_deadline_arm(struct Shell *this_shell, pid_t target);
+struct Timer* sh_deadline_take(struct Shell *this_shell);
+int sh_deadline_status(struct Shell *this_shell, const struct Timer *timer);
+int sh_deadline_end(struct Shell *this_shell);
+int sh_duration_parse(const char *text, double *seconds);
+void sh_timeout_command(struct Shell *this_shell);
+
+/*Retrying and memoizing commands (sh_retry.c, sh_memo.c)*/
+void sh_retry_command(struct Shell *this_shell);
+void sh_memo_command(struct Shell *this_shell);
+
+/*Command path resolution cache (sh_hash.c)*/
+void sh_hash_init(struct PathCache *cache);
+void sh_hash_clear(struct PathCache *cache);
+void sh_hash_free(struct PathCache *cache);
+struct PathEntry* sh_hash_add(struct PathCache *cache, const char *name, const char *path);
+const char* sh_hash_lookup(struct PathCache *cache, const char *name);
+void sh_hash_forget(struct PathCache *cache, const char *name);
+void sh_hash_list(struct PathCache *cache, int reusable);
+
+/*Variables and environment (sh_env.c)*/
+void sh_env_init(struct Env *env, char **envp);
+void sh_env_free(struct Env *env);
+int sh_env_valid_name(const char *name, size_t len);
+const char* sh_env_get(struct Env *env, const char *name);
+const char* sh_env_getn(struct Env *env, const char *name, size_t len);
+int sh_env_set(struct Env *env, const char *name, const char *value, int mode);
+int sh_env_setn(struct Env *env, const char *name, size_t len, const char *value, int mode);
+int sh_env_assign(struct Env *env, const char *word, int mode);
+void sh_env_unset(struct Env *env, const char *name);
+char** sh_env_envp(struct Env *env);
+const char* sh_env_param(struct Shell *this_shell, const char *name, size_t len, char *buf);
+void sh_export_command(struct Shell *this_shell);
+void sh_unset_command(struct Shell *this_shell);
+
+/*Directory listing cache (sh_dircache.c)*/
+void sh_dircache_init(struct DirCache *cache);
+void sh_dircache_free(struct DirCache *cache);
+const struct DirListing* sh_dircache_get(struct DirCache *cache, const char *path);
+size_t sh_dircache_prefix(const struct DirListing *listing, const char *prefix, size_t *first);
+unsigned char sh_dircache_type(const char *name);
+
+/*Filename expansion (sh_glob.c)*/
+int sh_glob_expand(struct Shell *this_shell);
+void sh_glob_free(struct Glob *glob);
+
+/*Tab completion (sh_complete.c)*/
+void sh_complete_init(struct Completer *completer);
+void sh_complete_free(struct Completer *completer);
+size_t sh_complete(struct Completer *completer, const char *line, size_t cursor,
+        char *insert, size_t insert_cap);
+
+/*Line editor (sh_edit.c)*/
+void sh_edit_init(struct LineEditor *editor);
+void sh_edit_free(struct LineEditor *editor);
+int sh_edit_begin(struct Shell *this_shell, const char *prompt);
+void sh_edit_read(struct Shell *this_shell);
+void sh_edit_cancel(struct LineEditor *editor);
+void sh_edit_hide(struct LineEditor *editor);
+void sh_edit_redraw(struct LineEditor *editor);
 
 /*Program helper functions*/
-void sh_catch_interr(int signo);
 void sh_kill_zombies(struct Shell *this_shell);
-void sh_catch_bg(struct Shell *this_shell);
+int sh_catch_bg(struct Shell *this_shell);
+void sh_bg_done(pid_t pid, int status, const struct Timer *timer);
 
 
 
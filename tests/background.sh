@@ -0,0 +1,15 @@
+# Background jobs: launch notice and the done notices,
+# which wait prints for the jobs it reaps
+sh -c 'exit 4' &
+wait
+echo "first"
+sh -c 'kill -TERM $$' &
+wait
+echo "second"
+timeout 0.1 sleep 5 &
+wait
+echo "third"
+sh -c "sleep 0.1; echo spawned" &
+wait
+cd / &
+status
@@ -0,0 +1,20 @@
+# Foreground exit values, as status and $? report them
+true
+status
+false
+status
+sh -c 'exit 3'
+status
+echo "last=$?"
+nosuchcmd
+status
+/bin/echo spawned
+status
+true | false
+status
+false | true
+status
+sh -c 'exit 5' | sh -c 'sleep 0.2; exit 0'
+status
+true | sh -c 'sleep 0.2; exit 6'
+status
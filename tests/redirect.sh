@@ -0,0 +1,10 @@
+# Redirections of programs and of the builtins run in the shell
+echo one > out.txt
+echo two >> out.txt
+cat < out.txt
+status > status.txt
+cat status.txt
+printf '%s\n' b a c | sort
+parallel echo < out.txt
+parallel sh -c 'echo $0 >&2' ::: x 2> err.txt
+cat err.txt
@@ -0,0 +1,46 @@
+#!/bin/sh
+######################################################
+#   By: Carol Toro
+#   File Created: 10/18/2026
+#   Last Modified: 10/18/2026
+#   Filename: run_tests.sh
+#   Description: Runs each tests/NAME.sh through the
+#       shell as a script, in an empty directory, and
+#       compares what it prints (stdout and stderr) with
+#       tests/NAME.expected. Process ids differ from run
+#       to run, so "pid 1234" and "pid is 1234" are
+#       compared as "pid N" and "pid is N".
+#       Prints a diff for each script that differs.
+#
+#       usage: run_tests.sh [shell]
+#
+######################################################
+SHELL_BIN=$(cd "$(dirname "${1:-./main}")" && pwd)/$(basename "${1:-./main}")
+TESTS=$(cd "$(dirname "$0")" && pwd)
+TMP=${TMPDIR:-/tmp}/simple_shell_tests.$$
+failed=0
+count=0
+
+mkdir -p "$TMP" || exit 1
+trap 'rm -rf "$TMP"' EXIT
+
+for script in "$TESTS"/*.sh; do
+    name=$(basename "$script" .sh)
+    [ "$name" = run_tests ] && continue
+    count=$((count + 1))
+
+    rm -rf "$TMP/work"
+    mkdir "$TMP/work"
+    (cd "$TMP/work" && "$SHELL_BIN" "$script" 2>&1) \
+        | sed -e 's/pid \(is \)\{0,1\}[0-9][0-9]*/pid \1N/g' > "$TMP/$name.out"
+
+    if diff -u "$TESTS/$name.expected" "$TMP/$name.out"; then
+        echo "ok   $name"
+    else
+        echo "FAIL $name"
+        failed=$((failed + 1))
+    fi
+done
+
+echo "$((count - failed)) of $count passed"
+[ "$failed" -eq 0 ]
@@ -0,0 +1,10 @@
+# Foreground jobs ended by a signal, and by a deadline
+sh -c 'kill -TERM $$'
+status
+sh -c 'kill -KILL $$'
+echo "last=$?"
+sleep 0.1 | sh -c 'kill -INT $$'
+status
+timeout 0.2 sleep 5
+status
+echo after